@@ -0,0 +1,101 @@
+#ifndef ARM_MOTION_H
+#define ARM_MOTION_H
+
+//Motion of the arm servo, in degrees. Targets closer than the deadband to the last
+//one are noise and dropped, the rest are reached with a trapezoidal velocity profile
+//and written at most once per servo frame, only when the rounded angle changes.
+//Time comes in as ms, so it runs on the PC too: tools/servo_sim.cpp counts writes.
+#include <math.h>
+#include <stdlib.h>
+
+#define RELAXED 103
+#define POINTING 6
+#define ARM_DEADBAND 2 //Degrees, smaller target changes are noise
+#define ARM_ACCEL 1500.0 //Degrees/s^2 for the trapezoidal profile
+#define ARM_MIN_WRITE_MS 20 //One servo frame
+#define ARM_STALE_MS 100 //Nobody is calling update(), move straight away
+#define ARM_SETTLE_MS 300 //The servo is still travelling after the last write
+
+struct ArmMotion{
+    //Profile state
+    float pos = RELAXED;
+    float vel = 0;
+    float max_vel = 500;
+    int target = RELAXED;
+    int commanded = -1; //Last value actually written
+
+    unsigned long last_update = 0;
+    unsigned long last_write = 0;
+    unsigned long writes = 0;
+
+    ArmMotion(){}
+
+    //New target, false if it is inside the deadband of the current one
+    bool aim(int deg, float speed){
+        max_vel = speed;
+        if(abs(deg - target) < ARM_DEADBAND && commanded != -1)
+            return false;
+        target = deg;
+        return true;
+    }
+
+    //Blocking sequences don't pump update()
+    bool stale(unsigned long now){
+        return now - last_update > ARM_STALE_MS;
+    }
+
+    //Straight to the target, the caller writes it
+    void jump(){
+        pos = target;
+        vel = 0;
+    }
+
+    void wrote(int deg, unsigned long now){
+        commanded = deg;
+        last_write = now;
+        writes++;
+    }
+
+    //Drawing motor current (battery load estimate)
+    bool moving(unsigned long now, bool active){
+        return active && (pos != target || vel != 0 || now - last_write < ARM_SETTLE_MS);
+    }
+
+    //Advance the profile, returns the angle to write now (-1 = nothing)
+    int update(unsigned long now, bool active){
+        float dt = (now - last_update)/1000.0;
+        last_update = now;
+
+        if(!active || (pos == target && vel == 0 && commanded == target))
+            return -1;
+        if(dt > ARM_STALE_MS/1000.0)
+            dt = ARM_STALE_MS/1000.0;
+
+        float dist = target - pos;
+        float dir = dist > 0 ? 1 : -1;
+        float stopping = vel*vel/(2*ARM_ACCEL) + fabs(vel)*dt; //One step of look ahead
+
+        if(vel*dir < 0)
+            vel += dir*ARM_ACCEL*dt; //Going the wrong way, turn around
+        else if(fabs(dist) <= stopping)
+            vel -= dir*ARM_ACCEL*dt; //Brake
+        else{
+            vel += dir*ARM_ACCEL*dt;
+            vel = vel > max_vel ? max_vel : (vel < -max_vel ? -max_vel : vel);
+        }
+
+        float next = pos + vel*dt;
+        if((dist > 0 && next >= target) || (dist < 0 && next <= target) || fabs(dist) < 0.5){
+            next = target;
+            vel = 0;
+        }
+        pos = next;
+
+        if(now - last_write < ARM_MIN_WRITE_MS)
+            return -1;
+        int deg = int(pos + 0.5);
+        return deg == commanded ? -1 : deg;
+    }
+};
+
+#endif
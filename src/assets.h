@@ -0,0 +1,211 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+//Asset bundle (faces, messages, melodies) packed by tools/pack_assets.py and flashed
+//to the "assets" partition. It is memory mapped and read in place, nothing is copied
+//to RAM except a face being decoded straight into the page buffer.
+//
+//Layout (little endian): AssetHeader, AssetEntry[count], payloads on 4 byte boundaries.
+//The CRC covers everything after the header.
+#include <stdint.h>
+#include <string.h>
+#ifdef ARDUINO
+#include <esp_partition.h>
+#endif
+
+#define ASSET_MAGIC 0x41454D41 //"AMEA"
+#define ASSET_FORMAT 1
+#define ASSET_PARTITION "assets"
+#define ASSET_PARTITION_SUBTYPE 0x40
+
+//Types
+#define ASSET_FACE 1   //128x64 in page format
+#define ASSET_TEXT 2   //u16 count, u16 offsets[count], NUL terminated UTF-8 strings
+#define ASSET_MELODY 3 //u16 tempo, u16 notes, int16 (frequency, divider) pairs
+
+//Codecs
+#define ASSET_RAW 0
+#define ASSET_RLE 1 //0x00-0x7F: n+1 literals, 0x80-0xFF: next byte (n & 0x7F)+3 times
+
+//Ids
+#define ASSET_TEXT_MESSAGES 0
+#define ASSET_MELODY_BIRTHDAY 0
+
+struct AssetHeader{
+    uint32_t magic;
+    uint16_t format;
+    uint16_t count;
+    uint32_t revision;
+    uint32_t size; //Whole bundle
+    uint32_t crc;
+};
+
+struct AssetEntry{
+    uint8_t type;
+    uint8_t id;
+    uint8_t codec;
+    uint8_t flags;
+    uint32_t offset; //From the start of the bundle
+    uint32_t packed;
+    uint32_t raw;
+};
+
+inline uint32_t asset_crc32(const uint8_t* p, uint32_t n){
+    uint32_t crc = 0xFFFFFFFF;
+    while(n--){
+        crc ^= *p++;
+        for(int k=0; k<8; k++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+struct AssetBundle{
+    const uint8_t* base = NULL;
+    const AssetHeader* header = NULL;
+    const AssetEntry* index = NULL;
+
+    AssetBundle(){}
+
+    //Checks everything once so the getters can trust the data
+    bool open(const uint8_t* data, uint32_t len){
+        base = NULL;
+        const AssetHeader* h = (const AssetHeader*)data;
+        if(len < sizeof(AssetHeader) || h->magic != ASSET_MAGIC || h->format != ASSET_FORMAT)
+            return false;
+        if(h->size > len || sizeof(AssetHeader) + h->count*sizeof(AssetEntry) > h->size)
+            return false;
+        if(asset_crc32(data + sizeof(AssetHeader), h->size - sizeof(AssetHeader)) != h->crc)
+            return false;
+
+        const AssetEntry* e = (const AssetEntry*)(data + sizeof(AssetHeader));
+        for(int i=0; i<h->count; i++)
+            if(e[i].offset > h->size || e[i].packed > h->size - e[i].offset || (e[i].offset & 3))
+                return false;
+
+        base = data;
+        header = h;
+        index = e;
+        return true;
+    }
+
+    bool ok(){
+        return base != NULL;
+    }
+
+    uint32_t revision(){
+        return ok() ? header->revision : 0;
+    }
+
+    const AssetEntry* find(uint8_t type, uint8_t id){
+        if(!ok())
+            return NULL;
+        for(int i=0; i<header->count; i++)
+            if(index[i].type == type && index[i].id == id)
+                return &index[i];
+        return NULL;
+    }
+
+    //Ids are 0..count-1
+    int count(uint8_t type){
+        int n = 0;
+        while(find(type, n) != NULL)
+            n++;
+        return n;
+    }
+
+    const uint8_t* payload(const AssetEntry* e){
+        return base + e->offset;
+    }
+
+    static bool unrle(const uint8_t* src, uint32_t n, uint8_t* dst, uint32_t out){
+        uint32_t i = 0, o = 0;
+        while(i < n){
+            uint8_t c = src[i++];
+            if(c < 0x80){
+                uint32_t len = c + 1;
+                if(i + len > n || o + len > out)
+                    return false;
+                memcpy(dst + o, src + i, len);
+                i += len;
+                o += len;
+            }
+            else{
+                uint32_t len = (c & 0x7F) + 3;
+                if(i >= n || o + len > out)
+                    return false;
+                memset(dst + o, src[i++], len);
+                o += len;
+            }
+        }
+        return o == out;
+    }
+
+    //Decodes a face into a page buffer of `size` bytes
+    bool face(int id, uint8_t* dst, uint32_t size){
+        const AssetEntry* e = find(ASSET_FACE, id);
+        if(e == NULL || e->raw != size)
+            return false;
+        if(e->codec == ASSET_RAW){
+            memcpy(dst, payload(e), size);
+            return true;
+        }
+        return e->codec == ASSET_RLE && unrle(payload(e), e->packed, dst, size);
+    }
+
+    int textCount(int id){
+        const AssetEntry* e = find(ASSET_TEXT, id);
+        if(e == NULL || e->packed < 2)
+            return 0;
+        const uint8_t* p = payload(e);
+        return p[0] | (p[1] << 8);
+    }
+
+    //Points into flash, NULL if missing
+    const char* text(int id, int i){
+        const AssetEntry* e = find(ASSET_TEXT, id);
+        if(e == NULL || i < 0 || i >= textCount(id) || uint32_t(2 + 2*i + 2) > e->packed)
+            return NULL;
+        const uint8_t* p = payload(e);
+        uint16_t off = p[2 + 2*i] | (p[3 + 2*i] << 8);
+        if(off >= e->packed || memchr(p + off, 0, e->packed - off) == NULL)
+            return NULL;
+        return (const char*)(p + off);
+    }
+
+    //Notes as (frequency, divider) pairs, NULL if missing
+    const int16_t* melody(int id, int &notes, int &tempo){
+        const AssetEntry* e = find(ASSET_MELODY, id);
+        if(e == NULL || e->packed < 4)
+            return NULL;
+        const uint8_t* p = payload(e);
+        tempo = p[0] | (p[1] << 8);
+        notes = p[2] | (p[3] << 8);
+        if(tempo == 0 || 4 + 4*uint32_t(notes) > e->packed)
+            return NULL;
+        return (const int16_t*)(p + 4);
+    }
+
+#ifdef ARDUINO
+    spi_flash_mmap_handle_t handle;
+
+    //Maps the partition into the data address space, false = use the built-in assets
+    bool map(){
+        const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+            (esp_partition_subtype_t)ASSET_PARTITION_SUBTYPE, ASSET_PARTITION);
+        if(part == NULL)
+            return false;
+
+        const void* ptr = NULL;
+        if(esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &handle) != ESP_OK)
+            return false;
+        if(open((const uint8_t*)ptr, part->size))
+            return true;
+
+        spi_flash_munmap(handle);
+        return false;
+    }
+#endif
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef BATTERY_H
+#define BATTERY_H
+
+//Battery state from the ADC: one sample per second, corrected for the voltage the
+//known load drops on the cell's internal resistance, filtered, then mapped to charge
+//with the open circuit discharge curve of a 1S Li-ion cell. Low battery and "on USB"
+//have hysteresis so they don't flap around the threshold.
+//
+//Plain C++, tools/battery_replay.cpp runs it over recorded traces on the PC.
+#include <stdint.h>
+
+#define BAT_SAMPLE_MS 1000
+#define BAT_R_MOHM 250        //Cell + protection + wiring, sag = load * R
+#define BAT_FILTER_SHIFT 3    //EMA weight 1/8 per sample
+#define BAT_SPIKE_MV 300      //Farther than this from the estimate = glitch...
+#define BAT_SPIKE_SAMPLES 3   //...unless it stays there (charger plugged/unplugged)
+#define BAT_WARMUP_SAMPLES 5  //No low battery decision before this
+
+#define BAT_LOW_ENTER 5       //% (with the load compensated)
+#define BAT_LOW_LEAVE 12
+#define BAT_USB_ENTER_MV 4150 //Charger holds the cell above this
+#define BAT_USB_LEAVE_MV 4080
+
+//Open circuit voltage -> charge, typical 1S Li-ion at room temperature
+struct BatPoint{
+    uint16_t mv;
+    uint8_t pct;
+};
+
+const BatPoint BAT_CURVE[] = {
+    {3300, 0}, {3500, 3}, {3600, 8}, {3680, 15}, {3730, 25}, {3770, 35}, {3800, 45},
+    {3840, 55}, {3880, 65}, {3940, 75}, {4000, 82}, {4080, 90}, {4150, 96}, {4200, 100}
+};
+#define BAT_CURVE_N (sizeof(BAT_CURVE)/sizeof(BAT_CURVE[0]))
+
+inline int bat_percent(int mv){
+    if(mv <= BAT_CURVE[0].mv)
+        return 0;
+    for(unsigned i=1; i<BAT_CURVE_N; i++)
+        if(mv < BAT_CURVE[i].mv){
+            const BatPoint &a = BAT_CURVE[i-1], &b = BAT_CURVE[i];
+            return a.pct + (mv - a.mv)*(b.pct - a.pct)/(b.mv - a.mv);
+        }
+    return 100;
+}
+
+struct BatteryEstimator{
+    int32_t est_mv = 0;    //Filtered, load compensated (open circuit)
+    int32_t raw_mv = 0;    //Last sample as read
+    int load_ma = 0;       //Load of the last sample
+    uint32_t last_sample = 0;
+    uint32_t samples = 0;
+    int outliers = 0;      //Consecutive samples far from the estimate
+    bool low = false;
+    bool usb = false;
+
+    BatteryEstimator(){}
+
+    bool due(uint32_t now_ms){
+        return samples == 0 || now_ms - last_sample >= BAT_SAMPLE_MS;
+    }
+
+    //mv at the ADC (already x2 for the divider), load_ma = current drawn while reading
+    void sample(uint32_t now_ms, int mv, int load){
+        last_sample = now_ms;
+        raw_mv = mv;
+        load_ma = load;
+        int32_t ocv = mv + int32_t(load)*BAT_R_MOHM/1000;
+
+        if(samples == 0)
+            est_mv = ocv;
+        else if(ocv - est_mv > BAT_SPIKE_MV || est_mv - ocv > BAT_SPIKE_MV){
+            //A real jump repeats, a glitch doesn't
+            if(++outliers < BAT_SPIKE_SAMPLES)
+                return;
+            est_mv = ocv;
+        }
+        else
+            est_mv += (ocv - est_mv) >> BAT_FILTER_SHIFT;
+        outliers = 0;
+        samples++;
+
+        if(!usb && est_mv >= BAT_USB_ENTER_MV)
+            usb = true;
+        else if(usb && est_mv < BAT_USB_LEAVE_MV)
+            usb = false;
+
+        int pct = percent();
+        if(samples < BAT_WARMUP_SAMPLES || usb)
+            low = false;
+        else if(!low && pct <= BAT_LOW_ENTER)
+            low = true;
+        else if(low && pct >= BAT_LOW_LEAVE)
+            low = false;
+    }
+
+    int percent(){
+        return bat_percent(est_mv);
+    }
+
+    float volts(){
+        return est_mv/1000.0;
+    }
+};
+
+#endif
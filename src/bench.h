@@ -0,0 +1,47 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+//Results of the built-in benchmarks ("bench" on the console, src/main.cpp), in cycles
+//on the bot and ns in tools/mirror_sim.cpp. Plain C++.
+#include <stdint.h>
+#include <stdio.h>
+
+//min / max / average of one measurement
+struct BenchStat{
+    uint32_t n = 0;
+    uint32_t min = 0;
+    uint32_t max = 0;
+    uint64_t sum = 0;
+
+    BenchStat(){}
+
+    void reset(){
+        n = min = max = 0;
+        sum = 0;
+    }
+
+    void add(uint32_t v){
+        if(n == 0 || v < min)
+            min = v;
+        if(v > max)
+            max = v;
+        sum += v;
+        n++;
+    }
+
+    //"name n avg min max unit", plus the average in us for cycles at mhz (0 = not cycles).
+    //Any output with print(const char*)
+    template<class P>
+    void print(P &p, const char* name, const char* unit, int mhz){
+        char out[112];
+        uint32_t avg = n ? uint32_t(sum/n) : 0;
+        int k = snprintf(out, sizeof(out), "%s n %lu avg %lu min %lu max %lu %s", name, (unsigned long)n,
+            (unsigned long)avg, (unsigned long)min, (unsigned long)max, unit);
+        if(mhz > 0 && k > 0 && k < int(sizeof(out)))
+            snprintf(out + k, sizeof(out) - k, " (%.1f us)", double(avg)/mhz);
+        p.print(out);
+        p.print("\n");
+    }
+};
+
+#endif
@@ -1,8 +1,9 @@
-#ifndef BIRTDHAY_H
+#ifndef BIRTHDAY_H
 #define BIRTHDAY_H
 
 #include <Arduino.h>
 #include <objects.h>
+#include <bench.h>
 
 #define NOTE_B0  31
 #define NOTE_C1  33
@@ -103,7 +104,7 @@ int tempo = 140;
 // a 4 means a quarter note, 8 an eighteenth , 16 sixteenth, so on
 // !!negative numbers are used to represent dotted notes,
 // so -4 means a dotted quarter note, that is, a quarter plus an eighteenth!!
-int melody[] = {
+const int16_t melody[] = {
   NOTE_C4,4, NOTE_C4,8, 
   NOTE_D4,-4, NOTE_C4,-4, NOTE_F4,-4,
   NOTE_E4,-2, NOTE_C4,4, NOTE_C4,8, 
@@ -129,28 +130,77 @@ int divider = 0, noteDuration = 0;
 struct HappyBday{
     Speaker* spk;
 
+    //Built-in song unless load() gets one from the assets
+    const int16_t* tune = melody;
+    int tune_notes = notes;
+    int tune_wholenote = wholenote;
+
+    //Non blocking player, -1 = not playing
+    int thisNote = -1;
+    unsigned long next_note = 0;
+
+#if PERF_MODE
+    //Per note of the last start(): cycles to start it, ms late against the beat ("bench melody")
+    BenchStat note_cycles, note_late;
+#endif
+
     HappyBday(){}
 
     void init(Speaker &spk){
         this->spk = &spk;
     }
 
-    void run(){
-        for (int thisNote = 0; thisNote < notes * 2; thisNote = thisNote + 2) {
-            // calculates the duration of each note
-            divider = melody[thisNote + 1];
-            if (divider > 0) {
-              // regular note, just proceed
-              noteDuration = (wholenote) / divider;
-            } else if (divider < 0) {
-              // dotted notes are represented with negative durations!!
-              noteDuration = (wholenote) / abs(divider);
-              noteDuration *= 1.5; // increases the duration in half for dotted notes
-            }
-        
-            // we only play the note for 90% of the duration, leaving 10% as a pause
-            spk->beep(melody[thisNote], noteDuration*0.9);
-          }
+    void load(const int16_t* tune, int notes, int tempo){
+        this->tune = tune;
+        tune_notes = notes;
+        tune_wholenote = (60000 * 4) / tempo;
+    }
+
+    void start(){
+        thisNote = 0;
+        next_note = get_time();
+#if PERF_MODE
+        note_cycles.reset();
+        note_late.reset();
+#endif
+    }
+
+    bool playing(){
+        return thisNote >= 0;
+    }
+
+    //Call every loop, starts the next note when it is due
+    void update(){
+        if(thisNote < 0 || long(get_time() - next_note) < 0)
+            return;
+
+        if(thisNote >= tune_notes * 2){
+            thisNote = -1;
+            return;
+        }
+#if PERF_MODE
+        uint32_t start = ESP.getCycleCount();
+        note_late.add(get_time() - next_note);
+#endif
+
+        // calculates the duration of each note
+        divider = tune[thisNote + 1];
+        if (divider > 0) {
+          // regular note, just proceed
+          noteDuration = (tune_wholenote) / divider;
+        } else if (divider < 0) {
+          // dotted notes are represented with negative durations!!
+          noteDuration = (tune_wholenote) / abs(divider);
+          noteDuration *= 1.5; // increases the duration in half for dotted notes
+        }
+
+        // we only play the note for 90% of the duration, leaving 10% as a pause
+        spk->play(tune[thisNote], noteDuration*0.9);
+        next_note += noteDuration;
+        thisNote += 2;
+#if PERF_MODE
+        note_cycles.add(ESP.getCycleCount() - start);
+#endif
     }
 
 };
@@ -0,0 +1,233 @@
+#ifndef BLIT_H
+#define BLIT_H
+
+//Word-wise 1bpp blitter for the SH1106 page buffer.
+//The buffer is N pages of `width` bytes, bit 0 of a byte is the top row of its page,
+//so 4 neighbour columns of one page are one 32-bit word.
+#include <stdint.h>
+#include <string.h>
+
+//Raster ops
+#define ROP_SET 0   //dst |= src
+#define ROP_CLEAR 1 //dst &= ~src
+#define ROP_XOR 2   //dst ^= src
+#define ROP_MASK 3  //dst = (dst & ~mask) | (src & mask)
+
+#define BYTES4(b) ((uint32_t)(b) * 0x01010101u)
+
+//Sprite stored like the screen: ceil(h/8) pages of w bytes
+struct Sprite{
+    uint8_t w, h;
+    const uint8_t* data;
+    const uint8_t* mask; //Only for ROP_MASK (NULL = data is its own mask)
+};
+
+//Pong ball (fillCircle r=3)
+const uint8_t BALL_BITS[] = {0x1C, 0x3E, 0x7F, 0x7F, 0x7F, 0x3E, 0x1C};
+const Sprite BALL_SPRITE = {7, 7, BALL_BITS, NULL};
+
+inline int blit_floor8(int v){
+    return v >= 0 ? v >> 3 : -((-v + 7) >> 3);
+}
+
+struct Blitter{
+    uint8_t* buf = NULL;
+    int width = 0;
+    int pages = 0;
+
+    Blitter(){}
+
+    void init(uint8_t* buf, int width, int height){
+        this->buf = buf;
+        this->width = width;
+        pages = height/8;
+    }
+
+    static inline uint32_t rop(uint32_t dst, uint32_t src, uint32_t mask, int op){
+        if(op == ROP_SET) return dst | src;
+        if(op == ROP_CLEAR) return dst & ~src;
+        if(op == ROP_XOR) return dst ^ src;
+        return (dst & ~mask) | (src & mask);
+    }
+
+    //Applies src/mask over n bytes of one page row, 4 columns per step once aligned
+    void row(int page, int x, int n, const uint8_t* src, const uint8_t* mask, uint8_t fill_src, uint8_t fill_mask, int op){
+        uint8_t* d = buf + page*width + x;
+        int i = 0;
+
+        //Head bytes until the destination is word aligned
+        while(i < n && ((uintptr_t)(d + i) & 3)){
+            uint8_t s = src ? src[i] : fill_src;
+            uint8_t m = mask ? mask[i] : fill_mask;
+            d[i] = rop(d[i], s, m, op);
+            i++;
+        }
+
+        //Whole words
+        for(; i + 4 <= n; i += 4){
+            uint32_t s, m;
+            if(src)
+                s = src[i] | (src[i+1] << 8) | (src[i+2] << 16) | ((uint32_t)src[i+3] << 24);
+            else
+                s = BYTES4(fill_src);
+            if(mask)
+                m = mask[i] | (mask[i+1] << 8) | (mask[i+2] << 16) | ((uint32_t)mask[i+3] << 24);
+            else
+                m = BYTES4(fill_mask);
+
+            uint32_t* w = (uint32_t*)(d + i);
+            *w = rop(*w, s, m, op);
+        }
+
+        //Tail
+        for(; i < n; i++){
+            uint8_t s = src ? src[i] : fill_src;
+            uint8_t m = mask ? mask[i] : fill_mask;
+            d[i] = rop(d[i], s, m, op);
+        }
+    }
+
+    //Rectangle fill with any op (ROP_MASK = set)
+    void fill(int x, int y, int w, int h, int op){
+        if(op == ROP_MASK)
+            op = ROP_SET;
+        int x1 = x < 0 ? 0 : x;
+        int x2 = x + w > width ? width : x + w;
+        int y1 = y < 0 ? 0 : y;
+        int y2 = y + h > pages*8 ? pages*8 : y + h;
+        if(x1 >= x2 || y1 >= y2)
+            return;
+
+        for(int p=y1 >> 3; p<=(y2-1) >> 3; p++){
+            int top = p*8 > y1 ? 0 : y1 - p*8;
+            int bottom = (p+1)*8 < y2 ? 8 : y2 - p*8;
+            uint8_t bits = (uint8_t)((0xFF << top) & (0xFF >> (8 - bottom)));
+            row(p, x1, x2 - x1, NULL, NULL, bits, bits, op);
+        }
+    }
+
+    //Sprite at any position, clipped, shifted to the page grid 4 columns at a time
+    void sprite(const Sprite &s, int x, int y, int op){
+        int x1 = x < 0 ? -x : 0;
+        int x2 = x + s.w > width ? width - x : s.w;
+        if(x1 >= x2)
+            return;
+        int n = x2 - x1;
+
+        int shift = y & 7;
+        int dst_page = blit_floor8(y);
+        int src_pages = (s.h + 7)/8;
+        uint8_t last_bits = (uint8_t)(0xFF >> ((8 - s.h % 8) % 8)); //Valid rows of the last page
+
+        //Shifted rows for one destination page
+        uint8_t lo[132], hi[132], mlo[132], mhi[132]; //Up to a full row plus one word
+        uint32_t keep_lo = BYTES4((uint8_t)(0xFF << shift));
+        uint32_t keep_hi = BYTES4((uint8_t)(0xFF >> (8 - shift)));
+
+        for(int sp=0; sp<src_pages; sp++){
+            const uint8_t* src = s.data + sp*s.w + x1;
+            const uint8_t* msk = s.mask ? s.mask + sp*s.w + x1 : src;
+            uint8_t valid = sp == src_pages-1 ? last_bits : 0xFF;
+
+            //SWAR: shift 4 bytes at once, then drop what crossed into the neighbour byte
+            for(int i=0; i<n; i+=4){
+                uint32_t w = 0, m = 0;
+                for(int k=0; k<4 && i+k<n; k++){
+                    w |= (uint32_t)(src[i+k] & valid) << (8*k);
+                    m |= (uint32_t)(msk[i+k] & valid) << (8*k);
+                }
+                uint32_t wl = (w << shift) & keep_lo;
+                uint32_t ml = (m << shift) & keep_lo;
+                uint32_t wh = shift ? (w >> (8 - shift)) & keep_hi : 0;
+                uint32_t mh = shift ? (m >> (8 - shift)) & keep_hi : 0;
+                memcpy(lo + i, &wl, 4);
+                memcpy(mlo + i, &ml, 4);
+                memcpy(hi + i, &wh, 4);
+                memcpy(mhi + i, &mh, 4);
+            }
+
+            int p = dst_page + sp;
+            if(p >= 0 && p < pages)
+                row(p, x + x1, n, lo, mlo, 0, 0, op);
+            if(shift && p+1 >= 0 && p+1 < pages)
+                row(p+1, x + x1, n, hi, mhi, 0, 0, op);
+        }
+    }
+
+    //Moves the whole frame d rows up (d < 0 = down), rows that come in are blank
+    void shiftRows(int d){
+        int h = pages*8;
+        if(d >= h || -d >= h){
+            memset(buf, 0, pages*width);
+            return;
+        }
+        int e = d > 0 ? d : -d;
+        int q = e >> 3, t = e & 7;
+        uint32_t keep_lo = BYTES4((uint8_t)(0xFF >> t)); //Bits that stay in their byte
+        uint32_t keep_hi = BYTES4((uint8_t)(0xFF << t));
+
+        for(int i=0; i<pages; i++){
+            //Up: page p takes p+q and p+q+1. Down: p takes p-q and p-q-1, last page first
+            int p = d > 0 ? i : pages-1 - i;
+            int a = d > 0 ? p + q : p - q;
+            int b = d > 0 ? a + 1 : a - 1;
+            bool has_a = a >= 0 && a < pages;
+            bool has_b = t && b >= 0 && b < pages;
+
+            for(int x=0; x<width; x+=4){
+                uint32_t wa = 0, wb = 0, w;
+                if(has_a) memcpy(&wa, buf + a*width + x, 4);
+                if(has_b) memcpy(&wb, buf + b*width + x, 4);
+                if(d > 0)
+                    w = ((wa >> t) & keep_lo) | (t ? (wb << (8 - t)) & ~keep_lo : 0);
+                else
+                    w = ((wa << t) & keep_hi) | (t ? (wb >> (8 - t)) & ~keep_hi : 0);
+                memcpy(buf + p*width + x, &w, 4);
+            }
+        }
+    }
+
+    //8x8 bit transpose (Hacker's Delight): 8 row bytes (MSB = left) -> 8 column bytes (LSB = top)
+    static void transpose8(const uint8_t* rows, int stride, uint8_t* cols){
+        //uint8_t promotes to int, shift as uint32_t so a set top bit is not a signed overflow
+        uint32_t a = (uint32_t(rows[0]) << 24) | (uint32_t(rows[stride]) << 16) | (uint32_t(rows[2*stride]) << 8) | rows[3*stride];
+        uint32_t b = (uint32_t(rows[4*stride]) << 24) | (uint32_t(rows[5*stride]) << 16) | (uint32_t(rows[6*stride]) << 8) | rows[7*stride];
+        uint32_t t;
+
+        t = (a ^ (a >> 7)) & 0x00AA00AA; a = a ^ t ^ (t << 7);
+        t = (b ^ (b >> 7)) & 0x00AA00AA; b = b ^ t ^ (t << 7);
+        t = (a ^ (a >> 14)) & 0x0000CCCC; a = a ^ t ^ (t << 14);
+        t = (b ^ (b >> 14)) & 0x0000CCCC; b = b ^ t ^ (t << 14);
+        t = (a & 0xF0F0F0F0) | ((b >> 4) & 0x0F0F0F0F);
+        b = ((a << 4) & 0xF0F0F0F0) | (b & 0x0F0F0F0F);
+        a = t;
+
+        //a/b now hold the columns with row 0 in the MSB, flip them into page order
+        uint8_t c[8] = {uint8_t(a >> 24), uint8_t(a >> 16), uint8_t(a >> 8), uint8_t(a),
+                        uint8_t(b >> 24), uint8_t(b >> 16), uint8_t(b >> 8), uint8_t(b)};
+        for(int i=0; i<8; i++){
+            uint8_t v = c[i];
+            v = (v >> 4) | (v << 4);
+            v = ((v & 0xCC) >> 2) | ((v & 0x33) << 2);
+            v = ((v & 0xAA) >> 1) | ((v & 0x55) << 1);
+            cols[i] = v;
+        }
+    }
+
+    //GFX style bitmap (rows, MSB first) on the 8x8 grid, e.g. the faces
+    bool rowBitmap(int x, int y, const uint8_t* bitmap, int w, int h, int op){
+        if((x & 7) || (y & 7) || (w & 7) || (h & 7) || x < 0 || y < 0 || x + w > width || y + h > pages*8)
+            return false; //Caller falls back to GFX
+
+        int stride = w/8;
+        uint8_t cols[8];
+        for(int by=0; by<h/8; by++)
+            for(int bx=0; bx<stride; bx++){
+                transpose8(bitmap + by*8*stride + bx, stride, cols);
+                row(y/8 + by, x + bx*8, 8, cols, cols, 0, 0, op);
+            }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <Arduino.h>
+#include <script.h>
+
+//Serial commands ("help", "perf", ...), the language is in src/script.h. Only takes
+//what already arrived and runs at most one command per loop
+typedef ScriptFn ConsoleFn;
+
+struct Console{
+    ScriptReader reader;
+
+    Console(){}
+
+    bool add(const char* name, const char* help, ConsoleFn fn){
+        return reader.add(name, help, fn);
+    }
+
+    void help(){
+        for(int i=0; i<reader.n_commands; i++){
+            Serial.print(reader.commands[i].name);
+            Serial.print(" - ");
+            Serial.println(reader.commands[i].help);
+        }
+        Serial.println("wait - pause the script <ms> ('cmd; wait 500; cmd')");
+    }
+
+    //Call every loop
+    void update(){
+        int n = Serial.available();
+        if(n > reader.room())
+            n = reader.room();
+        while(n-- > 0)
+            reader.push(Serial.read());
+
+        int status = reader.poll(millis());
+        if(status == SCRIPT_HELP)
+            help();
+        else if(status == SCRIPT_UNKNOWN){
+            Serial.print("? ");
+            Serial.println(reader.line);
+        }
+        else if(status == SCRIPT_TOO_LONG)
+            Serial.println("? line too long");
+    }
+};
+
+#endif
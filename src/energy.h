@@ -0,0 +1,179 @@
+#ifndef ENERGY_H
+#define ENERGY_H
+
+//Energy accounting: estimated charge per subsystem and per mode, from what the firmware
+//did (loop work and sleep, I2C bytes, panel time and lit pixels, servo travel and hold,
+//buzzer time) times a per-unit cost. "energy" on the serial console prints it.
+//
+//Plain C++, tools/energy_replay.cpp builds the same report from a TRACE_MODE capture.
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+//Subsystems
+#define EN_CPU 0    //Loop work
+#define EN_SLEEP 1  //Frame pacing, delay() with the clocks on
+#define EN_I2C 2
+#define EN_PANEL 3  //Base + lit pixels * contrast
+#define EN_SERVO 4  //Travelling or holding
+#define EN_BUZZER 5
+#define EN_N 6
+
+const char* const EN_NAMES[EN_N] = {"cpu", "sleep", "i2c", "panel", "servo", "buzzer"};
+
+//PERF_MODE_* numbering
+#define EN_N_MODES 7
+const char* const EN_MODE_NAMES[EN_N_MODES] = {"?", "idle", "timer", "pong", "gambling", "bday", "other"};
+
+#define EN_PANEL_PIXELS 8192 //128x64
+
+//Per unit costs, "energy cost <name> <value>" changes them
+struct EnergyCosts{
+    float cpu_160_ma = 27;
+    float cpu_80_ma = 19;
+    float sleep_ma = 12;
+    float i2c_uas_byte = 0.05; //uA*s per byte on the wire (pull-ups, driver)
+    float panel_ma = 2;        //On, nothing lit
+    float panel_full_ma = 28;  //Every pixel lit at contrast 255
+    float servo_move_ma = 250;
+    float servo_hold_ma = 6;
+    float buzzer_ma = 25;
+    float battery_mah = 500;   //For the runtime estimate
+
+    float* find(const char* name){
+        struct Entry{ const char* name; float* v; };
+        Entry e[] = {
+            {"cpu_160", &cpu_160_ma}, {"cpu_80", &cpu_80_ma}, {"sleep", &sleep_ma},
+            {"i2c_byte", &i2c_uas_byte}, {"panel", &panel_ma}, {"panel_full", &panel_full_ma},
+            {"servo_move", &servo_move_ma}, {"servo_hold", &servo_hold_ma}, {"buzzer", &buzzer_ma},
+            {"battery", &battery_mah}
+        };
+        for(unsigned i=0; i<sizeof(e)/sizeof(e[0]); i++)
+            if(strcmp(e[i].name, name) == 0)
+                return e[i].v;
+        return NULL;
+    }
+};
+
+struct EnergyMeter{
+    EnergyCosts cost;
+    double charge[EN_N_MODES][EN_N]; //mA*ms
+    uint32_t time_ms[EN_N_MODES];
+    uint32_t servo_moves[EN_N_MODES];
+    uint32_t servo_ms[EN_N_MODES];
+    uint32_t buzzer_ms[EN_N_MODES];
+    uint32_t i2c_bytes[EN_N_MODES];
+    uint8_t mode = 0;
+    uint16_t lit = EN_PANEL_PIXELS/4; //Pixels on in the last frame sent
+    char out[128];
+
+    EnergyMeter(){
+        reset();
+    }
+
+    void reset(){
+        memset(charge, 0, sizeof(charge));
+        memset(time_ms, 0, sizeof(time_ms));
+        memset(servo_moves, 0, sizeof(servo_moves));
+        memset(servo_ms, 0, sizeof(servo_ms));
+        memset(buzzer_ms, 0, sizeof(buzzer_ms));
+        memset(i2c_bytes, 0, sizeof(i2c_bytes));
+    }
+
+    void setMode(int m){
+        mode = m >= 0 && m < EN_N_MODES ? m : 0;
+    }
+
+    void flush(uint32_t bytes, uint16_t lit_pixels){
+        i2c_bytes[mode] += bytes;
+        charge[mode][EN_I2C] += bytes*cost.i2c_uas_byte; //uA*s = mA*ms
+        lit = lit_pixels;
+    }
+
+    void buzzer(uint32_t ms){
+        buzzer_ms[mode] += ms;
+        charge[mode][EN_BUZZER] += ms*cost.buzzer_ma;
+    }
+
+    void servoMove(){
+        servo_moves[mode]++;
+    }
+
+    //Once per loop: how long it worked and slept, and what was on meanwhile
+    void frame(uint32_t work_ms, uint32_t sleep_ms, int mhz, int contrast, bool servo_on, bool servo_moving){
+        uint32_t ms = work_ms + sleep_ms;
+        double *c = charge[mode];
+        time_ms[mode] += ms;
+        c[EN_CPU] += work_ms*(mhz > 80 ? cost.cpu_160_ma : cost.cpu_80_ma);
+        c[EN_SLEEP] += sleep_ms*cost.sleep_ma;
+        if(contrast > 0)
+            c[EN_PANEL] += ms*(cost.panel_ma + cost.panel_full_ma*lit/EN_PANEL_PIXELS*contrast/255);
+        if(servo_moving){
+            servo_ms[mode] += ms;
+            c[EN_SERVO] += ms*cost.servo_move_ma;
+        }
+        else if(servo_on)
+            c[EN_SERVO] += ms*cost.servo_hold_ma;
+    }
+
+    static double mah(double mams){
+        return mams/3600000.0;
+    }
+
+    //Any Print-like output with print(const char*)
+    template<class P>
+    void report(P &p){
+        double total = 0;
+        uint32_t ms = 0;
+        for(int m=0; m<EN_N_MODES; m++){
+            ms += time_ms[m];
+            for(int s=0; s<EN_N; s++)
+                total += charge[m][s];
+        }
+        double hours = ms/3600000.0;
+        double avg = hours > 0 ? mah(total)/hours : 0;
+        snprintf(out, sizeof(out), "energy %lus %.3fmAh avg %.1fmA, %.1fh on %.0fmAh\n", (unsigned long)(ms/1000),
+            mah(total), avg, avg > 0 ? cost.battery_mah/avg : 0, cost.battery_mah);
+        p.print(out);
+        p.print("mode s mAh mA | cpu sleep i2c panel servo buzzer (mAh) | i2c_kB moves servo_s buzzer_s\n");
+
+        for(int m=0; m<EN_N_MODES; m++){
+            if(time_ms[m] == 0)
+                continue;
+            double sum = 0;
+            for(int s=0; s<EN_N; s++)
+                sum += charge[m][s];
+            int n = snprintf(out, sizeof(out), "%s %lu %.3f %.1f |", EN_MODE_NAMES[m], (unsigned long)(time_ms[m]/1000),
+                mah(sum), mah(sum)/(time_ms[m]/3600000.0));
+            for(int s=0; s<EN_N; s++)
+                n += snprintf(out + n, sizeof(out) - n, " %.3f", mah(charge[m][s]));
+            snprintf(out + n, sizeof(out) - n, " | %lu %lu %lu %lu\n", (unsigned long)(i2c_bytes[m]/1024),
+                (unsigned long)servo_moves[m], (unsigned long)(servo_ms[m]/1000), (unsigned long)(buzzer_ms[m]/1000));
+            p.print(out);
+        }
+    }
+};
+
+#ifdef ARDUINO
+//On by default in the perf build, otherwise every ENERGY_ macro is empty
+#ifndef ENERGY_MODE
+#define ENERGY_MODE PERF_MODE
+#endif
+
+#if ENERGY_MODE
+EnergyMeter energy;
+#define ENERGY_SET_MODE(m) energy.setMode(m)
+#define ENERGY_FLUSH(bytes, lit) energy.flush(bytes, lit)
+#define ENERGY_BUZZER(ms) energy.buzzer(ms)
+#define ENERGY_SERVO_MOVE() energy.servoMove()
+#define ENERGY_FRAME(work, sleep, mhz, contrast, on, moving) energy.frame(work, sleep, mhz, contrast, on, moving)
+#else
+#define ENERGY_SET_MODE(m)
+#define ENERGY_FLUSH(bytes, lit)
+#define ENERGY_BUZZER(ms)
+#define ENERGY_SERVO_MOVE()
+#define ENERGY_FRAME(work, sleep, mhz, contrast, on, moving)
+#endif
+#endif
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef FACE_DRAW_H
+#define FACE_DRAW_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <panel.h>
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+//Procedural eyes: two ellipses with lids, a smile cut and optional pupils.
+//Geometry is in half pixels so odd sized eyes are exact, on the 128x64 face art
+//(Layout::FACE_Y moves it onto a shorter panel).
+//Plain C++, tools/face_check.cpp compares the presets with the bitmaps on the PC.
+struct FaceParams{
+    int16_t left_x, right_x, y; //Eye centers
+    int16_t w, h;               //Eye radii
+    int16_t lid_outer, lid_inner; //Top lid (brow) cut at the outer / inner side, px from the top
+    int16_t bottom_lid;         //Px cut from the bottom
+    int16_t smile;              //Happy crescent: the eye minus itself moved down this many px
+    int16_t pupil, pupil_x, pupil_y; //Pupil radius and offset in px (0 = no pupils)
+};
+
+#define N_FACE_PARAMS (sizeof(FaceParams)/sizeof(int16_t))
+
+//Same order as Faces[] (src/face_ids.h)
+const FaceParams FACE_PRESETS[] PROGMEM = {
+    {63, 193, 64, 29, 50, 0, 0, 0, 0, 0, 0, 0},
+    {127, 219, 65, 28, 51, 0, 0, 0, 0, 0, 0, 0},
+    {37, 129, 63, 28, 51, 0, 0, 0, 0, 0, 0, 0},
+    {63, 193, 64, 29, 50, 0, 0, 0, 12, 0, 0, 0},
+    {63, 193, 64, 29, 50, 2, 28, 0, 0, 0, 0, 0},
+    {63, 193, 64, 29, 50, 29, 5, 0, 0, 0, 0, 0}
+};
+
+inline int floor_div(int a, int b){
+    return a >= 0 ? a/b : -((-a + b - 1)/b);
+}
+
+inline int isqrt(int v){
+    if(v <= 0)
+        return 0;
+    int r = sqrt(v);
+    while(r*r > v) r--;
+    while((r+1)*(r+1) <= v) r++;
+    return r;
+}
+
+//==========================================================
+
+struct FaceRenderer{
+    uint8_t* buf;
+
+    FaceRenderer(){}
+
+    //Horizontal run on one row of the art, straight into the page buffer
+    void span(int y, int x1, int x2, bool white){
+        y += Layout::FACE_Y;
+        if(y < 0 || y >= Layout::H)
+            return;
+        x1 = x1 < 0 ? 0 : x1;
+        x2 = x2 > Layout::W-1 ? Layout::W-1 : x2;
+        if(x1 > x2)
+            return;
+
+        uint8_t* p = buf + (y/8)*Layout::W + x1;
+        uint8_t mask = 1 << (y & 7);
+        int n = x2 - x1 + 1;
+        if(white)
+            while(n--) *p++ |= mask;
+        else{
+            mask = ~mask;
+            while(n--) *p++ &= mask;
+        }
+    }
+
+    //Span in eye coordinates (u grows towards the nose) to pixels
+    void eyeSpan(int y, int cx, int dir, int ulo, int uhi, bool white){
+        if(ulo > uhi)
+            return;
+        int lo = dir > 0 ? cx + ulo : cx - uhi;
+        int hi = dir > 0 ? cx + uhi : cx - ulo;
+        span(y, floor_div(lo, 2), floor_div(hi - 1, 2), white); //Pixels with lo <= 2x+1 <= hi
+    }
+
+    void eye(const FaceParams &f, int cx, int dir){
+        int top = f.y - f.h;
+        int lo_o = 2*f.lid_outer, lo_i = 2*f.lid_inner;
+
+        int y_end = (f.y + f.h)/2 < Layout::FACE_H-1 ? (f.y + f.h)/2 : Layout::FACE_H-1;
+        for(int y=top > 0 ? top/2 : 0; y<=y_end; y++){
+            int Y = 2*y + 1;
+            int dy = Y - f.y;
+            if(abs(dy) >= f.h)
+                continue;
+
+            //Bottom lid
+            if((f.y + f.h) - Y < 2*f.bottom_lid)
+                continue;
+
+            int half = f.w*isqrt(f.h*f.h - dy*dy)/f.h;
+            int ulo = -half, uhi = half;
+
+            //Top lid, a line from the outer to the inner corner
+            int from_top = Y - top;
+            if(lo_o == lo_i){
+                if(from_top < lo_o)
+                    continue;
+            }
+            else{
+                int ub = (from_top - lo_o)*2*f.w/(lo_i - lo_o) - f.w;
+                if(lo_i > lo_o)
+                    uhi = ub < uhi ? ub : uhi;
+                else
+                    ulo = ub > ulo ? ub : ulo;
+            }
+
+            //Smile cut
+            if(f.smile != 0){
+                int dy_in = Y - (f.y + 2*f.smile);
+                if(abs(dy_in) < f.h){
+                    int hole = f.w*isqrt(f.h*f.h - dy_in*dy_in)/f.h;
+                    eyeSpan(y, cx, dir, ulo, uhi < -hole-1 ? uhi : -hole-1, true);
+                    eyeSpan(y, cx, dir, ulo > hole+1 ? ulo : hole+1, uhi, true);
+                    continue;
+                }
+            }
+
+            eyeSpan(y, cx, dir, ulo, uhi, true);
+        }
+
+        //Pupil
+        if(f.pupil > 0){
+            int px = cx + dir*2*f.pupil_x;
+            int py = f.y + 2*f.pupil_y;
+            int r = 2*f.pupil;
+            for(int y=(py - r)/2; y<=(py + r)/2; y++){
+                int dy = 2*y + 1 - py;
+                if(abs(dy) >= r)
+                    continue;
+                int half = isqrt(r*r - dy*dy);
+                span(y, floor_div(px - half, 2), floor_div(px + half - 1, 2), false);
+            }
+        }
+    }
+
+    //Into a page buffer of the panel (Adafruit layout: bit y&7 of byte x + (y/8)*W)
+    void draw(const FaceParams &f, uint8_t* buf){
+        this->buf = buf;
+        eye(f, f.left_x, 1);
+        eye(f, f.right_x, -1);
+    }
+
+    //Pixel box covered by a face on the panel (x, y, w, h)
+    void box(const FaceParams &f, int out[4]){
+        out[0] = (f.left_x - f.w)/2;
+        out[1] = (f.y - f.h)/2 + Layout::FACE_Y;
+        out[2] = (f.right_x + f.w)/2 - out[0] + 1;
+        out[3] = f.h + 1;
+    }
+};
+
+#endif
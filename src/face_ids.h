@@ -0,0 +1,14 @@
+#ifndef FACE_IDS_H
+#define FACE_IDS_H
+
+//Face idx (order of Faces[] in src/faces.h), shared by the bitmaps, the keyframe
+//scripts of src/shows.h and the presets of src/face_draw.h
+#define FACE_IDLE 0
+#define FACE_LOOK_LEFT 1
+#define FACE_LOOK_RIGHT 2
+#define FACE_HAPPY 3
+#define FACE_ANGRY 4
+#define FACE_SAD 5
+#define BUILTIN_FACES 6
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef FACE_MODEL_H
+#define FACE_MODEL_H
+
+#include <Arduino.h>
+#include <objects.h>
+#include <face_draw.h> //Presets and the span renderer
+
+#define FACE_MORPH_MS 250
+#define BLINK_MS 160
+#define MIN_BLINK_DELAY 2500
+#define MAX_BLINK_DELAY 6000
+
+//Smooth morphs between presets, plus blinks
+struct FaceAnimator{
+    FaceRenderer renderer;
+    Screen* screen;
+
+    FaceParams from, to, last;
+    unsigned long morph_start = 0;
+    unsigned long blink_start = 0;
+    unsigned long next_blink = 0;
+    bool drawn = false;
+
+    FaceAnimator(){}
+
+    void init(Screen &screen){
+        this->screen = &screen;
+        memcpy_P(&to, &FACE_PRESETS[0], sizeof(FaceParams));
+        from = to;
+        last = to;
+    }
+
+    void morphTo(int idx){
+        idx = constrain(idx, 0, N_FACES-1);
+        from = current(get_time());
+        memcpy_P(&to, &FACE_PRESETS[idx], sizeof(FaceParams));
+        morph_start = get_time();
+    }
+
+    //A morph or a blink is running (the loop keeps PWR_ANIM_FRAME_MS meanwhile)
+    bool animating(unsigned long now){
+        return now - morph_start < FACE_MORPH_MS || (blink_start != 0 && now - blink_start < BLINK_MS);
+    }
+
+    //Next update() draws everything again
+    void reset(){
+        drawn = false;
+    }
+
+    FaceParams current(unsigned long now){
+        long t = min(long(now - morph_start)*256/FACE_MORPH_MS, 256L);
+
+        //Smoothstep easing
+        t = t*t*(768 - 2*t)/65536;
+
+        FaceParams f;
+        int16_t* a = (int16_t*)&from;
+        int16_t* b = (int16_t*)&to;
+        int16_t* out = (int16_t*)&f;
+        rep(i, int(N_FACE_PARAMS))
+            out[i] = a[i] + (b[i] - a[i])*t/256;
+        return f;
+    }
+
+    void blink(FaceParams &f, unsigned long now){
+        if(next_blink == 0)
+            next_blink = now + random(MIN_BLINK_DELAY, MAX_BLINK_DELAY);
+
+        if(long(now - next_blink) >= 0){
+            blink_start = now;
+            next_blink = now + random(MIN_BLINK_DELAY, MAX_BLINK_DELAY);
+        }
+
+        long t = now - blink_start;
+        if(t >= BLINK_MS)
+            return;
+
+        //0 -> closed -> 0
+        long c = t < BLINK_MS/2 ? t*512/BLINK_MS : (BLINK_MS - t)*512/BLINK_MS;
+        int closed = f.h/2 - 1;
+        f.lid_outer += (closed - f.lid_outer)*c/256;
+        f.lid_inner += (closed - f.lid_inner)*c/256;
+        f.bottom_lid += (closed - f.bottom_lid)*c/256;
+    }
+
+    //Draws only when the face changed
+    void update(){
+        unsigned long now = get_time();
+        FaceParams f = current(now);
+        blink(f, now);
+
+        if(drawn && memcmp(&f, &last, sizeof(f)) == 0)
+            return;
+
+        display.clearDisplay();
+        renderer.draw(f, display.getBuffer());
+
+        if(drawn){
+            //last is only valid once something was drawn
+            int a[4], b[4];
+            renderer.box(f, a);
+            renderer.box(last, b);
+            screen->markDirty(a[0], a[1], a[2], a[3]);
+            screen->markDirty(b[0], b[1], b[2], b[3]);
+        }
+        else
+            screen->markDirty(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+        screen->flushDirty();
+
+        last = f;
+        drawn = true;
+    }
+};
+
+#endif
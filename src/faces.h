@@ -1,7 +1,12 @@
 #ifndef FACES_H
 #define FACES_H
 
-#include <Arduino.h>
+//Face bitmaps, 128x64 rows of 16 bytes (plain C++, tools/face_check.cpp reads them too)
+#include <face_ids.h>
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
 
 const unsigned char IDLE_FACE [] PROGMEM = {
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
@@ -412,12 +417,4 @@ const unsigned char* Faces[] = {
 
 const int N_FACES = sizeof(Faces)/sizeof(Faces[0]);
 
-//Faces idx
-#define IDLE 0
-#define LOOK_LEFT 1
-#define LOOK_RIGHT 2
-#define HAPPY 3
-#define ANGRY 4
-#define SAD 5
-
 #endif
\ No newline at end of file
@@ -0,0 +1,249 @@
+//Generated by tools/gen_font.py, do not edit
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdint.h>
+
+#define FONT_W 5       //Glyph columns at size 1
+#define FONT_ADVANCE 6 //Glyph + one blank column
+#define FONT_FIRST 0x20
+#define FONT_LAST 0x7E
+#define FONT_N_GLYPHS 111
+#define FONT_N_LATIN1 16
+
+//Size 1: 5 columns, one page each
+const uint8_t FONT_SMALL[FONT_N_GLYPHS*FONT_W] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, // 
+    0x00, 0x00, 0x5F, 0x00, 0x00, //!
+    0x00, 0x07, 0x00, 0x07, 0x00, //"
+    0x14, 0x7F, 0x14, 0x7F, 0x14, //#
+    0x24, 0x2A, 0x7F, 0x2A, 0x12, //$
+    0x23, 0x13, 0x08, 0x64, 0x62, //%
+    0x36, 0x49, 0x56, 0x20, 0x50, //&
+    0x00, 0x08, 0x07, 0x03, 0x00, //'
+    0x00, 0x1C, 0x22, 0x41, 0x00, //(
+    0x00, 0x41, 0x22, 0x1C, 0x00, //)
+    0x2A, 0x1C, 0x7F, 0x1C, 0x2A, //*
+    0x08, 0x08, 0x3E, 0x08, 0x08, //+
+    0x00, 0x80, 0x70, 0x30, 0x00, //,
+    0x08, 0x08, 0x08, 0x08, 0x08, //-
+    0x00, 0x00, 0x60, 0x60, 0x00, //.
+    0x20, 0x10, 0x08, 0x04, 0x02, ///
+    0x3E, 0x51, 0x49, 0x45, 0x3E, //0
+    0x00, 0x42, 0x7F, 0x40, 0x00, //1
+    0x72, 0x49, 0x49, 0x49, 0x46, //2
+    0x21, 0x41, 0x49, 0x4D, 0x33, //3
+    0x18, 0x14, 0x12, 0x7F, 0x10, //4
+    0x27, 0x45, 0x45, 0x45, 0x39, //5
+    0x3C, 0x4A, 0x49, 0x49, 0x31, //6
+    0x41, 0x21, 0x11, 0x09, 0x07, //7
+    0x36, 0x49, 0x49, 0x49, 0x36, //8
+    0x46, 0x49, 0x49, 0x29, 0x1E, //9
+    0x00, 0x00, 0x14, 0x00, 0x00, //:
+    0x00, 0x40, 0x34, 0x00, 0x00, //;
+    0x00, 0x08, 0x14, 0x22, 0x41, //<
+    0x14, 0x14, 0x14, 0x14, 0x14, //=
+    0x00, 0x41, 0x22, 0x14, 0x08, //>
+    0x02, 0x01, 0x59, 0x09, 0x06, //?
+    0x3E, 0x41, 0x5D, 0x59, 0x4E, //@
+    0x7C, 0x12, 0x11, 0x12, 0x7C, //A
+    0x7F, 0x49, 0x49, 0x49, 0x36, //B
+    0x3E, 0x41, 0x41, 0x41, 0x22, //C
+    0x7F, 0x41, 0x41, 0x41, 0x3E, //D
+    0x7F, 0x49, 0x49, 0x49, 0x41, //E
+    0x7F, 0x09, 0x09, 0x09, 0x01, //F
+    0x3E, 0x41, 0x41, 0x51, 0x73, //G
+    0x7F, 0x08, 0x08, 0x08, 0x7F, //H
+    0x00, 0x41, 0x7F, 0x41, 0x00, //I
+    0x20, 0x40, 0x41, 0x3F, 0x01, //J
+    0x7F, 0x08, 0x14, 0x22, 0x41, //K
+    0x7F, 0x40, 0x40, 0x40, 0x40, //L
+    0x7F, 0x02, 0x1C, 0x02, 0x7F, //M
+    0x7F, 0x04, 0x08, 0x10, 0x7F, //N
+    0x3E, 0x41, 0x41, 0x41, 0x3E, //O
+    0x7F, 0x09, 0x09, 0x09, 0x06, //P
+    0x3E, 0x41, 0x51, 0x21, 0x5E, //Q
+    0x7F, 0x09, 0x19, 0x29, 0x46, //R
+    0x26, 0x49, 0x49, 0x49, 0x32, //S
+    0x03, 0x01, 0x7F, 0x01, 0x03, //T
+    0x3F, 0x40, 0x40, 0x40, 0x3F, //U
+    0x1F, 0x20, 0x40, 0x20, 0x1F, //V
+    0x3F, 0x40, 0x38, 0x40, 0x3F, //W
+    0x63, 0x14, 0x08, 0x14, 0x63, //X
+    0x03, 0x04, 0x78, 0x04, 0x03, //Y
+    0x61, 0x59, 0x49, 0x4D, 0x43, //Z
+    0x00, 0x7F, 0x41, 0x41, 0x41, //[
+    0x02, 0x04, 0x08, 0x10, 0x20, //backslash
+    0x00, 0x41, 0x41, 0x41, 0x7F, //]
+    0x04, 0x02, 0x01, 0x02, 0x04, //^
+    0x40, 0x40, 0x40, 0x40, 0x40, //_
+    0x00, 0x03, 0x07, 0x08, 0x00, //`
+    0x20, 0x54, 0x54, 0x78, 0x40, //a
+    0x7F, 0x28, 0x44, 0x44, 0x38, //b
+    0x38, 0x44, 0x44, 0x44, 0x28, //c
+    0x38, 0x44, 0x44, 0x28, 0x7F, //d
+    0x38, 0x54, 0x54, 0x54, 0x18, //e
+    0x00, 0x08, 0x7E, 0x09, 0x02, //f
+    0x18, 0xA4, 0xA4, 0x9C, 0x78, //g
+    0x7F, 0x08, 0x04, 0x04, 0x78, //h
+    0x00, 0x44, 0x7D, 0x40, 0x00, //i
+    0x20, 0x40, 0x40, 0x3D, 0x00, //j
+    0x7F, 0x10, 0x28, 0x44, 0x00, //k
+    0x00, 0x41, 0x7F, 0x40, 0x00, //l
+    0x7C, 0x04, 0x78, 0x04, 0x78, //m
+    0x7C, 0x08, 0x04, 0x04, 0x78, //n
+    0x38, 0x44, 0x44, 0x44, 0x38, //o
+    0xFC, 0x18, 0x24, 0x24, 0x18, //p
+    0x18, 0x24, 0x24, 0x18, 0xFC, //q
+    0x7C, 0x08, 0x04, 0x04, 0x08, //r
+    0x48, 0x54, 0x54, 0x54, 0x24, //s
+    0x04, 0x04, 0x3F, 0x44, 0x24, //t
+    0x3C, 0x40, 0x40, 0x20, 0x7C, //u
+    0x1C, 0x20, 0x40, 0x20, 0x1C, //v
+    0x3C, 0x40, 0x30, 0x40, 0x3C, //w
+    0x44, 0x28, 0x10, 0x28, 0x44, //x
+    0x4C, 0x90, 0x90, 0x90, 0x7C, //y
+    0x44, 0x64, 0x54, 0x4C, 0x44, //z
+    0x00, 0x08, 0x36, 0x41, 0x00, //{
+    0x00, 0x00, 0x77, 0x00, 0x00, //|
+    0x00, 0x41, 0x36, 0x08, 0x00, //}
+    0x02, 0x01, 0x02, 0x04, 0x02, //~
+    0x00, 0x00, 0x7D, 0x00, 0x00, //¡
+    0x00, 0x06, 0x09, 0x09, 0x06, //°
+    0x30, 0x48, 0x4D, 0x40, 0x20, //¿
+    0x78, 0x14, 0x16, 0x15, 0x78, //Á
+    0x7C, 0x54, 0x56, 0x55, 0x44, //É
+    0x00, 0x44, 0x7E, 0x45, 0x00, //Í
+    0x7E, 0x09, 0x12, 0x21, 0x7C, //Ñ
+    0x3C, 0x44, 0x46, 0x45, 0x3C, //Ó
+    0x3C, 0x40, 0x42, 0x41, 0x3C, //Ú
+    0x20, 0x54, 0x56, 0x79, 0x40, //á
+    0x38, 0x54, 0x56, 0x55, 0x18, //é
+    0x00, 0x44, 0x7E, 0x41, 0x00, //í
+    0x7E, 0x09, 0x06, 0x05, 0x78, //ñ
+    0x38, 0x44, 0x46, 0x45, 0x38, //ó
+    0x3C, 0x40, 0x42, 0x21, 0x7C, //ú
+    0x3C, 0x41, 0x40, 0x21, 0x7C, //ü
+};
+
+//Size 2: 10 columns x 2 pages, top page first
+const uint8_t FONT_LARGE[FONT_N_GLYPHS*FONT_W*4] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x33, 0x33, 0x00, 0x00, 0x00, 0x00, //!
+    0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //"
+    0x30, 0x30, 0xFF, 0xFF, 0x30, 0x30, 0xFF, 0xFF, 0x30, 0x30, 0x03, 0x03, 0x3F, 0x3F, 0x03, 0x03, 0x3F, 0x3F, 0x03, 0x03, //#
+    0x30, 0x30, 0xCC, 0xCC, 0xFF, 0xFF, 0xCC, 0xCC, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x3F, 0x0C, 0x0C, 0x03, 0x03, //$
+    0x0F, 0x0F, 0x0F, 0x0F, 0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x3C, //%
+    0x3C, 0x3C, 0xC3, 0xC3, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x30, 0x30, 0x33, 0x33, 0x0C, 0x0C, 0x33, 0x33, //&
+    0x00, 0x00, 0xC0, 0xC0, 0x3F, 0x3F, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //'
+    0x00, 0x00, 0xF0, 0xF0, 0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x00, 0x00, //(
+    0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00, //)
+    0xCC, 0xCC, 0xF0, 0xF0, 0xFF, 0xFF, 0xF0, 0xF0, 0xCC, 0xCC, 0x0C, 0x0C, 0x03, 0x03, 0x3F, 0x3F, 0x03, 0x03, 0x0C, 0x0C, //*
+    0xC0, 0xC0, 0xC0, 0xC0, 0xFC, 0xFC, 0xC0, 0xC0, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00, //+
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xC0, 0x3F, 0x3F, 0x0F, 0x0F, 0x00, 0x00, //,
+    0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //-
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x3C, 0x00, 0x00, //.
+    0x00, 0x00, 0x00, 0x00, 0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, ///
+    0xFC, 0xFC, 0x03, 0x03, 0xC3, 0xC3, 0x33, 0x33, 0xFC, 0xFC, 0x0F, 0x0F, 0x33, 0x33, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //0
+    0x00, 0x00, 0x0C, 0x0C, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00, //1
+    0x0C, 0x0C, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, //2
+    0x03, 0x03, 0x03, 0x03, 0xC3, 0xC3, 0xF3, 0xF3, 0x0F, 0x0F, 0x0C, 0x0C, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //3
+    0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0xFF, 0xFF, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x3F, 0x3F, 0x03, 0x03, //4
+    0x3F, 0x3F, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0xC3, 0xC3, 0x0C, 0x0C, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //5
+    0xF0, 0xF0, 0xCC, 0xCC, 0xC3, 0xC3, 0xC3, 0xC3, 0x03, 0x03, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //6
+    0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xC3, 0xC3, 0x3F, 0x3F, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, //7
+    0x3C, 0x3C, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //8
+    0x3C, 0x3C, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFC, 0xFC, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, //9
+    0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, //:
+    0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00, //;
+    0x00, 0x00, 0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, //<
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, //=
+    0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0xC0, 0xC0, 0x00, 0x00, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x00, 0x00, //>
+    0x0C, 0x0C, 0x03, 0x03, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x33, 0x33, 0x00, 0x00, 0x00, 0x00, //?
+    0xFC, 0xFC, 0x03, 0x03, 0xF3, 0xF3, 0xC3, 0xC3, 0xFC, 0xFC, 0x0F, 0x0F, 0x30, 0x30, 0x33, 0x33, 0x33, 0x33, 0x30, 0x30, //@
+    0xF0, 0xF0, 0x0C, 0x0C, 0x03, 0x03, 0x0C, 0x0C, 0xF0, 0xF0, 0x3F, 0x3F, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x3F, 0x3F, //A
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //B
+    0xFC, 0xFC, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x0C, 0x0C, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, //C
+    0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFC, 0xFC, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //D
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x03, 0x03, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, //E
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x03, 0x03, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //F
+    0xFC, 0xFC, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x0F, 0x0F, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x33, 0x33, 0x3F, 0x3F, //G
+    0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xFF, 0xFF, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, //H
+    0x00, 0x00, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00, //I
+    0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, 0x00, 0x00, //J
+    0xFF, 0xFF, 0xC0, 0xC0, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x3F, 0x3F, 0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, //K
+    0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, //L
+    0xFF, 0xFF, 0x0C, 0x0C, 0xF0, 0xF0, 0x0C, 0x0C, 0xFF, 0xFF, 0x3F, 0x3F, 0x00, 0x00, 0x03, 0x03, 0x00, 0x00, 0x3F, 0x3F, //M
+    0xFF, 0xFF, 0x30, 0x30, 0xC0, 0xC0, 0x00, 0x00, 0xFF, 0xFF, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x3F, 0x3F, //N
+    0xFC, 0xFC, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFC, 0xFC, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //O
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //P
+    0xFC, 0xFC, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFC, 0xFC, 0x0F, 0x0F, 0x30, 0x30, 0x33, 0x33, 0x0C, 0x0C, 0x33, 0x33, //Q
+    0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x3F, 0x3F, 0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, //R
+    0x3C, 0x3C, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x0C, 0x0C, 0x0C, 0x0C, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //S
+    0x0F, 0x0F, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, //T
+    0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //U
+    0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, //V
+    0xFF, 0xFF, 0x00, 0x00, 0xC0, 0xC0, 0x00, 0x00, 0xFF, 0xFF, 0x0F, 0x0F, 0x30, 0x30, 0x0F, 0x0F, 0x30, 0x30, 0x0F, 0x0F, //W
+    0x0F, 0x0F, 0x30, 0x30, 0xC0, 0xC0, 0x30, 0x30, 0x0F, 0x0F, 0x3C, 0x3C, 0x03, 0x03, 0x00, 0x00, 0x03, 0x03, 0x3C, 0x3C, //X
+    0x0F, 0x0F, 0x30, 0x30, 0xC0, 0xC0, 0x30, 0x30, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, //Y
+    0x03, 0x03, 0xC3, 0xC3, 0xC3, 0xC3, 0xF3, 0xF3, 0x0F, 0x0F, 0x3C, 0x3C, 0x33, 0x33, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, //Z
+    0x00, 0x00, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x3F, 0x3F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, //[
+    0x0C, 0x0C, 0x30, 0x30, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, //backslash
+    0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFF, 0xFF, 0x00, 0x00, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x3F, 0x3F, //]
+    0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //^
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, //_
+    0x00, 0x00, 0x0F, 0x0F, 0x3F, 0x3F, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //`
+    0x00, 0x00, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x00, 0x00, 0x0C, 0x0C, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x3F, 0x30, 0x30, //a
+    0xFF, 0xFF, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F, 0x0C, 0x0C, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //b
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, //c
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0xFF, 0xFF, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, 0x3F, 0x3F, //d
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x0F, 0x0F, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x03, 0x03, //e
+    0x00, 0x00, 0xC0, 0xC0, 0xFC, 0xFC, 0xC3, 0xC3, 0x0C, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, //f
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xF0, 0xF0, 0xC0, 0xC0, 0x03, 0x03, 0xCC, 0xCC, 0xCC, 0xCC, 0xC3, 0xC3, 0x3F, 0x3F, //g
+    0xFF, 0xFF, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, //h
+    0x00, 0x00, 0x30, 0x30, 0xF3, 0xF3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00, //i
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF3, 0xF3, 0x00, 0x00, 0x0C, 0x0C, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, 0x00, 0x00, //j
+    0xFF, 0xFF, 0x00, 0x00, 0xC0, 0xC0, 0x30, 0x30, 0x00, 0x00, 0x3F, 0x3F, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x00, 0x00, //k
+    0x00, 0x00, 0x03, 0x03, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00, //l
+    0xF0, 0xF0, 0x30, 0x30, 0xC0, 0xC0, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x3F, 0x3F, //m
+    0xF0, 0xF0, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, //n
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //o
+    0xF0, 0xF0, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0x0C, 0x0C, 0x0C, 0x0C, 0x03, 0x03, //p
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0xF0, 0xF0, 0x03, 0x03, 0x0C, 0x0C, 0x0C, 0x0C, 0x03, 0x03, 0xFF, 0xFF, //q
+    0xF0, 0xF0, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0xC0, 0xC0, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //r
+    0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x0C, 0x0C, //s
+    0x30, 0x30, 0x30, 0x30, 0xFF, 0xFF, 0x30, 0x30, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x30, 0x30, 0x0C, 0x0C, //t
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, 0x3F, 0x3F, //u
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, //v
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x0F, 0x0F, 0x30, 0x30, 0x0F, 0x0F, 0x30, 0x30, 0x0F, 0x0F, //w
+    0x30, 0x30, 0xC0, 0xC0, 0x00, 0x00, 0xC0, 0xC0, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, //x
+    0xF0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0xF0, 0x30, 0x30, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0x3F, 0x3F, //y
+    0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0xF0, 0xF0, 0x30, 0x30, 0x30, 0x30, 0x3C, 0x3C, 0x33, 0x33, 0x30, 0x30, 0x30, 0x30, //z
+    0x00, 0x00, 0xC0, 0xC0, 0x3C, 0x3C, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x30, 0x30, 0x00, 0x00, //{
+    0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, //|
+    0x00, 0x00, 0x03, 0x03, 0x3C, 0x3C, 0xC0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00, //}
+    0x0C, 0x0C, 0x03, 0x03, 0x0C, 0x0C, 0x30, 0x30, 0x0C, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //~
+    0x00, 0x00, 0x00, 0x00, 0xF3, 0xF3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, //¡
+    0x00, 0x00, 0x3C, 0x3C, 0xC3, 0xC3, 0xC3, 0xC3, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //°
+    0x00, 0x00, 0xC0, 0xC0, 0xF3, 0xF3, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, //¿
+    0xC0, 0xC0, 0x30, 0x30, 0x3C, 0x3C, 0x33, 0x33, 0xC0, 0xC0, 0x3F, 0x3F, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x3F, 0x3F, //Á
+    0xF0, 0xF0, 0x30, 0x30, 0x3C, 0x3C, 0x33, 0x33, 0x30, 0x30, 0x3F, 0x3F, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x30, 0x30, //É
+    0x00, 0x00, 0x30, 0x30, 0xFC, 0xFC, 0x33, 0x33, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00, //Í
+    0xFC, 0xFC, 0xC3, 0xC3, 0x0C, 0x0C, 0x03, 0x03, 0xF0, 0xF0, 0x3F, 0x3F, 0x00, 0x00, 0x03, 0x03, 0x0C, 0x0C, 0x3F, 0x3F, //Ñ
+    0xF0, 0xF0, 0x30, 0x30, 0x3C, 0x3C, 0x33, 0x33, 0xF0, 0xF0, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //Ó
+    0xF0, 0xF0, 0x00, 0x00, 0x0C, 0x0C, 0x03, 0x03, 0xF0, 0xF0, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //Ú
+    0x00, 0x00, 0x30, 0x30, 0x3C, 0x3C, 0xC3, 0xC3, 0x00, 0x00, 0x0C, 0x0C, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x3F, 0x30, 0x30, //á
+    0xC0, 0xC0, 0x30, 0x30, 0x3C, 0x3C, 0x33, 0x33, 0xC0, 0xC0, 0x0F, 0x0F, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x03, 0x03, //é
+    0x00, 0x00, 0x30, 0x30, 0xFC, 0xFC, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x3F, 0x3F, 0x30, 0x30, 0x00, 0x00, //í
+    0xFC, 0xFC, 0xC3, 0xC3, 0x3C, 0x3C, 0x33, 0x33, 0xC0, 0xC0, 0x3F, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, //ñ
+    0xC0, 0xC0, 0x30, 0x30, 0x3C, 0x3C, 0x33, 0x33, 0xC0, 0xC0, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x0F, 0x0F, //ó
+    0xF0, 0xF0, 0x00, 0x00, 0x0C, 0x0C, 0x03, 0x03, 0xF0, 0xF0, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, 0x3F, 0x3F, //ú
+    0xF0, 0xF0, 0x03, 0x03, 0x00, 0x00, 0x03, 0x03, 0xF0, 0xF0, 0x0F, 0x0F, 0x30, 0x30, 0x30, 0x30, 0x0C, 0x0C, 0x3F, 0x3F, //ü
+};
+
+//Latin-1 code of the glyphs after FONT_LAST, same order
+const uint8_t FONT_LATIN1[FONT_N_LATIN1] = {
+    0xA1, 0xB0, 0xBF, 0xC1, 0xC9, 0xCD, 0xD1, 0xD3, 0xDA, 0xE1, 0xE9, 0xED, 0xF1, 0xF3, 0xFA, 0xFC
+};
+
+#endif
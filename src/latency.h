@@ -0,0 +1,132 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+//Input to photon latency: when an input happened, which frame carries its effect and
+//when that frame finished going out over I2C. Plain C++ so tools/latency_sim.cpp runs
+//the same probe on the PC against a modeled bus. "lat" on the serial console.
+//
+//An input is tagged with the next frame to be sent; the first flush that sends bytes
+//after that closes it. Only the oldest unanswered input per class counts, so a burst
+//of encoder steps is measured from its first step.
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+//Classes
+#define LAT_MENU 0  //Encoder turn or click in a menu
+#define LAT_PONG 1  //Potentiometer -> paddle
+#define LAT_TIMER 2 //Encoder adjusting the timer
+#define LAT_N 3
+
+#define LAT_BUCKET_US 8000 //Histogram bucket width
+#define LAT_BUCKETS 16     //The last one also counts everything above
+
+const char* const LAT_NAMES[LAT_N] = {"menu", "pong", "timer"};
+
+struct LatStat{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[LAT_BUCKETS];
+
+    void reset(){
+        memset(this, 0, sizeof(*this));
+        min = 0xFFFFFFFF;
+    }
+
+    void add(uint32_t us){
+        count++;
+        sum += us;
+        if(us < min) min = us;
+        if(us > max) max = us;
+        uint32_t b = us/LAT_BUCKET_US;
+        hist[b < LAT_BUCKETS ? b : LAT_BUCKETS-1]++;
+    }
+
+    //Upper edge of the bucket holding the p-th percentile (0-100), in us, at most the max
+    uint32_t percentile(int p){
+        uint32_t need = (uint64_t(count)*p + 99)/100, seen = 0;
+        for(int b=0; b<LAT_BUCKETS-1; b++){
+            seen += hist[b];
+            uint32_t edge = (b+1)*LAT_BUCKET_US;
+            if(seen >= need && need > 0)
+                return edge < max ? edge : max;
+        }
+        return max;
+    }
+};
+
+struct LatencyProbe{
+    LatStat stats[LAT_N];
+    bool pending[LAT_N];
+    uint32_t pending_at[LAT_N];
+    uint32_t pending_frame[LAT_N];
+    uint32_t frame = 0; //Frames sent so far
+    char out[160];
+
+    LatencyProbe(){
+        reset();
+    }
+
+    void reset(){
+        for(int i=0; i<LAT_N; i++){
+            stats[i].reset();
+            pending[i] = false;
+        }
+    }
+
+    //at_us: when the input physically happened (encoder ISR, button edge, ADC read)
+    void input(int cls, uint32_t at_us){
+        if(pending[cls])
+            return;
+        pending[cls] = true;
+        pending_at[cls] = at_us;
+        pending_frame[cls] = frame + 1;
+    }
+
+    //End of a flush, frames that send nothing change nothing on the glass
+    void flushed(uint32_t done_us, unsigned long bytes){
+        if(bytes == 0)
+            return;
+        frame++;
+        for(int i=0; i<LAT_N; i++)
+            if(pending[i] && pending_frame[i] <= frame){
+                stats[i].add(done_us - pending_at[i]);
+                pending[i] = false;
+            }
+    }
+
+    //"class count avg p50 p90 max (ms) | histogram", NULL if nothing was measured
+    const char* line(int cls){
+        LatStat &s = stats[cls];
+        if(s.count == 0)
+            return NULL;
+        int n = snprintf(out, sizeof(out), "%s %u %.1f %.0f %.0f %.1f |", LAT_NAMES[cls], (unsigned)s.count,
+            s.sum/1000.0/s.count, s.percentile(50)/1000.0, s.percentile(90)/1000.0, s.max/1000.0);
+        int last = LAT_BUCKETS-1;
+        while(last > 0 && s.hist[last] == 0)
+            last--;
+        for(int b=0; b<=last && n < int(sizeof(out)) - 12; b++)
+            n += snprintf(out + n, sizeof(out) - n, " %u", (unsigned)s.hist[b]);
+        return out;
+    }
+};
+
+#ifdef ARDUINO
+//On by default in the perf build, otherwise every LAT_ macro is empty
+#ifndef LATENCY_MODE
+#define LATENCY_MODE PERF_MODE
+#endif
+
+#if LATENCY_MODE
+LatencyProbe latency;
+#define LAT_INPUT(cls, at_us) latency.input(cls, at_us)
+#define LAT_FLUSHED(bytes) latency.flushed(micros(), bytes)
+#else
+#define LAT_INPUT(cls, at_us)
+#define LAT_FLUSHED(bytes)
+#endif
+#endif
+
+#endif
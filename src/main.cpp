@@ -1,6 +1,17 @@
 #include <objects.h>
 #include <esp_adc_cal.h>
 #include <birthday.h>
+#include <pong.h>
+#include <pong_render.h>
+#include <timeline.h>
+#include <power.h>
+#include <battery.h>
+#include <settings.h>
+#include <studylog.h>
+#include <face_model.h>
+#include <console.h>
+#include <bench.h>
+#include <new>
 
 //=====================================
 
@@ -17,10 +28,14 @@
 //ENCODER
 volatile bool encoderDirection;
 volatile bool encoderTurned;
+volatile unsigned long encoderTurnedAt; //micros(), for the latency probe
 
 void updateEncoder(){
     encoderDirection = (digitalRead(CLKPIN) != digitalRead(DTPIN));
     encoderTurned = true;
+    if(LATENCY_MODE)
+        encoderTurnedAt = micros();
+    TRACE_ISR(TRACE_ENCODER, encoderDirection);
 }
 
 //===================================
@@ -31,19 +46,255 @@ Speaker speaker;
 Encoder encoder;
 Potentiometer pot;
 HappyBday bday;
+Timeline timeline;
+FaceAnimator faces;
+Console console;
+Power power;
+BatteryEstimator battery;
+SettingsStore settings;
+StudyLog studylog;
 
 //===================================
 
 #define DEBG_MODE false
+bool BATTERY_LOG = false; //"bat log": one CSV line per sample for tools/battery_replay.cpp
+
+//===================================
+//SERIAL CONSOLE
+void cmdPerf(const char* args){
+#if PERF_MODE
+    if(strcmp(args, "reset") == 0){
+        perf.reset();
+        Serial.println("ok");
+    }
+    else
+        perf.dump(Serial);
+#else
+    Serial.println("perf is off, build with -DPERF_MODE=1");
+#endif
+}
+
+void cmdStall(const char* args){
+#if STALL_MODE
+    if(strcmp(args, "reset") == 0){
+        stall.reset();
+        Serial.println("ok");
+    }
+    else if(strncmp(args, "budget", 6) == 0){
+        int ms = atoi(args + 6);
+        if(ms > 0)
+            stall.budget_ms = ms;
+        Serial.print("budget ");
+        Serial.println(uint32_t(stall.budget_ms));
+    }
+    else
+        stall.dump(Serial);
+#else
+    Serial.println("stall monitor is off, build with -DPERF_MODE=1");
+#endif
+}
+
+void cmdLatency(const char* args){
+#if LATENCY_MODE
+    if(strcmp(args, "reset") == 0){
+        latency.reset();
+        Serial.println("ok");
+        return;
+    }
+    Serial.print("frames ");
+    Serial.println(latency.frame);
+    rep(i, LAT_N){
+        const char* line = latency.line(i);
+        if(line != NULL)
+            Serial.println(line);
+    }
+#else
+    Serial.println("latency probe is off, build with -DPERF_MODE=1");
+#endif
+}
+
+void cmdPower(const char* args){
+    if(strcmp(args, "reset") == 0){
+        power.reset();
+        Serial.println("ok");
+    }
+    else
+        power.dump(Serial);
+}
+
+//Stdout-like adapter for EnergyMeter::report()
+struct SerialOut{
+    void print(const char* s){
+        Serial.print(s);
+    }
+};
+
+void cmdEnergy(const char* args){
+#if ENERGY_MODE
+    if(strcmp(args, "reset") == 0){
+        energy.reset();
+        Serial.println("ok");
+        return;
+    }
+    if(strncmp(args, "cost", 4) == 0){
+        char name[16];
+        float value;
+        if(sscanf(args + 4, "%15s %f", name, &value) == 2){
+            float* cost = energy.cost.find(name);
+            if(cost == NULL){
+                Serial.println("unknown cost");
+                return;
+            }
+            *cost = value;
+        }
+        EnergyCosts &c = energy.cost;
+        Serial.printf("cpu_160 %.1f cpu_80 %.1f sleep %.1f panel %.1f panel_full %.1f (mA)\n", c.cpu_160_ma,
+            c.cpu_80_ma, c.sleep_ma, c.panel_ma, c.panel_full_ma);
+        Serial.printf("servo_move %.1f servo_hold %.1f buzzer %.1f (mA) i2c_byte %.3f (uAs) battery %.0f (mAh)\n",
+            c.servo_move_ma, c.servo_hold_ma, c.buzzer_ma, c.i2c_uas_byte, c.battery_mah);
+        return;
+    }
+    SerialOut out;
+    energy.report(out);
+#else
+    Serial.println("energy model is off, build with -DPERF_MODE=1");
+#endif
+}
+
+void cmdSettings(const char* args){
+    if(strcmp(args, "save") == 0)
+        settings.save(millis());
+    else if(strcmp(args, "reset") == 0)
+        settings.reset(millis());
+    SettingsData &d = settings.data;
+    Serial.printf("pong level %d rounds %d, choices %d, timer %ds\n", d.pong_level, d.pong_rounds,
+        d.gamble_choices, d.timer_preset);
+    Serial.printf("v%d %s, %lu writes total, %lu this boot (%lu coalesced, %lu failed)%s\n", d.version,
+        SETTINGS_LOAD_NAMES[settings.status], (unsigned long)d.writes, (unsigned long)settings.saves,
+        (unsigned long)settings.coalesced, (unsigned long)settings.failed, settings.dirty ? ", pending" : "");
+}
+
+void cmdStudy(const char* args){
+    if(strncmp(args, "clock", 5) == 0){
+        long local = atol(args + 5);
+        if(local > 0)
+            studylog.setClock(local, millis());
+        Serial.println(studylog.clock_set ? studylog.now(millis()) : 0);
+        return;
+    }
+    if(!studylog.ready){
+        Serial.println("no studylog partition");
+        return;
+    }
+    StudySummary today, week, total;
+    studylog.summary(millis(), today, week, total);
+    const char* names[3] = {studylog.clock_set ? "today" : "this boot", "week", "total"};
+    StudySummary* sums[3] = {&today, &week, &total};
+    rep(i, 3)
+        Serial.printf("%s %d sessions %d done %d pauses %lus\n", names[i], sums[i]->sessions, sums[i]->done,
+            sums[i]->pauses, (unsigned long)sums[i]->studied);
+    Serial.printf("boot %d, sector %d seq %lu, head 0x%lx%s\n", studylog.boot, studylog.newest,
+        (unsigned long)studylog.seq, (unsigned long)studylog.head, studylog.open ? ", session open" : "");
+}
+
+void cmdBattery(const char* args){
+    if(strcmp(args, "log") == 0){
+        BATTERY_LOG = !BATTERY_LOG;
+        Serial.println(BATTERY_LOG ? "bat,ms,mv,load_ma" : "log off");
+        return;
+    }
+    Serial.printf("%d%% %dmV (read %dmV at %dmA)%s%s\n", battery.percent(), int(battery.est_mv),
+        int(battery.raw_mv), battery.load_ma, battery.usb ? " usb" : "", battery.low ? " low" : "");
+}
+
+void cmdMirror(const char* args){
+#if MIRROR_MODE
+    MirrorEncoder &e = mirror.enc;
+    if(strcmp(args, "on") == 0){
+        Serial.println("ok");
+        mirror.start(SCREEN_WIDTH, SCREEN_HEIGHT);
+        screen.show(); //First key frame now, not on the next change
+    }
+    else if(strcmp(args, "off") == 0){
+        mirror.stop();
+        Serial.println("ok");
+    }
+    else if(strcmp(args, "key") == 0){
+        e.key();
+        Serial.println("ok");
+    }
+    else
+        Serial.printf("%s, %lu frames (%lu key, %lu deferred), %lu bytes for %lu raw\n", mirror.on ? "on" : "off",
+            (unsigned long)e.frames, (unsigned long)e.keys, (unsigned long)e.deferred, (unsigned long)e.bytes,
+            (unsigned long)e.raw);
+#else
+    (void)args;
+    Serial.println("mirror is off, build with -DPERF_MODE=1");
+#endif
+}
+
+//Next to the modes, they need them
+void cmdMemory(const char* args);
+void cmdRotate(const char* args);
+void cmdClick(const char* args);
+void cmdPot(const char* args);
+void cmdMode(const char* args);
+void cmdFace(const char* args);
+void cmdMelody(const char* args);
+void cmdBench(const char* args);
+
+void setupConsole(){
+    console.add("perf", "counters and histograms ('perf reset' clears them)", cmdPerf);
+    console.add("lat", "input to screen latency per class ('lat reset' clears it)", cmdLatency);
+    console.add("power", "time and estimated current per power profile ('power reset')", cmdPower);
+    console.add("bat", "battery estimate ('bat log' streams the samples)", cmdBattery);
+    console.add("energy", "estimated mAh per mode and subsystem ('energy cost <name> <value>', 'energy reset')", cmdEnergy);
+    console.add("cfg", "saved settings and flash writes ('cfg save' writes now, 'cfg reset')", cmdSettings);
+    console.add("study", "study sessions today/week/total ('study clock <local unix s>' sets the time)", cmdStudy);
+    console.add("mem", "RAM of the modes and the heap", cmdMemory);
+    console.add("stall", "slow loops by mode/section ('stall budget <ms>', 'stall reset')", cmdStall);
+    console.add("mirror", "stream the screen for tools/oled_viewer.py ('mirror on|off|key')", cmdMirror);
+    console.add("rotate", "turn the encoder <steps> (negative = left)", cmdRotate);
+    console.add("click", "press the encoder", cmdClick);
+    console.add("pot", "potentiometer at <0-100> ('pot off' goes back to the knob)", cmdPot);
+    console.add("mode", "switch mode (idle|bday|timer|stats|pong|gambling|battery|off)", cmdMode);
+    console.add("face", "show face <n>", cmdFace);
+    console.add("melody", "play bday|startup|action|alarm|success|gambling|sad|celebration|angry", cmdMelody);
+    console.add("bench", "cycles of face|menu|flush|melody|all [n]", cmdBench);
+}
+
+//===================================
 
 void setup() {
-    if(DEBG_MODE)
+    if(MIRROR_MODE)
+        Serial.setTxBufferSize(MIRROR_TX_BUFFER);
+    if(DEBG_MODE || PERF_MODE || TRACE_MODE || MIRROR_MODE)
         Serial.begin(115200);
+    setupConsole();
+    STALL_BEGIN();
+    settings.begin();
+    studylog.begin();
+
+    //Content from the assets partition (if it was flashed)
+    if(assets.map()){
+        int notes, tempo;
+        const int16_t* song = assets.melody(ASSET_MELODY_BIRTHDAY, notes, tempo);
+        if(song != NULL)
+            bday.load(song, notes, tempo);
+        if(DEBG_MODE){
+            Serial.print("Assets revision ");
+            Serial.println(assets.revision());
+        }
+    }
+
     speaker.init(BUZZERPIN, 2);
     bday.init(speaker);
+    timeline.init(screen, arm, speaker, bday);
     
     arm.init(SERVOPIN, 0);
     screen.init(speaker);
+    power.init(screen, arm, speaker);
+    faces.init(screen);
     pot.init(POTPIN);
     encoder.init(CLKPIN, DTPIN, SWPIN, encoderTurned, encoderDirection, speaker);
     attachInterrupt(digitalPinToInterrupt(CLKPIN), updateEncoder, CHANGE);
@@ -54,6 +305,10 @@ void setup() {
 
 //==================================
 //Menu handling
+#define MENU_LINE_H (Layout::MENU_LINE_H)
+#define MENU_TEXT_X (Layout::MENU_TEXT_X) //Options start after the "-> " marker
+#define MENU_SCROLL_STEP 4 //Rows per frame while scrolling
+
 struct Menu{
     int N_OPTIONS = 0;
     int MAX_OPTIONS = 4;
@@ -61,6 +316,12 @@ struct Menu{
 
     int current=0;
 
+    //Scroll position in rows, follows current*MENU_LINE_H a few rows per frame
+    int offset = 0;
+    bool drawn = false;
+    bool selected = false;
+    uint32_t drawn_hash = 0;
+
     Menu(){}
 
     void init(int n, String options[]){
@@ -68,35 +329,93 @@ struct Menu{
         this->options = options;
     }
 
-    void show(){
-        display.clearDisplay();
-        display.setTextSize(1);
-        int x = 0;
-        int i=0;
-        for(i=current; i < min(int(current+MAX_OPTIONS), int(N_OPTIONS)); i++){
-            display.setCursor(0, x);
-            if(i == current)
-                display.print("-> ");
-            display.print(options[i]);
-            x += 16;
+    //Options can change while the menu is open (e.g. "Dificultad ( 3 )")
+    uint32_t hash(){
+        uint32_t h = 2166136261u;
+        rep(i, N_OPTIONS)
+            for(const char* c = options[i].c_str(); ; c++){
+                h = (h ^ uint8_t(*c))*16777619u;
+                if(*c == 0)
+                    break;
+            }
+        return h;
+    }
+
+    //Only into the buffer, lines that were already there don't change
+    void drawList(){
+        rep(i, N_OPTIONS){
+            int y = i*MENU_LINE_H - offset;
+            if(y <= -8 || y >= SCREEN_HEIGHT)
+                continue;
+            int x = MENU_TEXT_X;
+            screen.text.draw(options[i].c_str(), x, y);
         }
+    }
+
+    void drawMarkers(){
+        display.setCursor(0, 0);
+        screen.print("->");
 
         //Check if the menu can be scrolled..
-        if(i < N_OPTIONS){
-            display.fillRect(115, 40, 8, 16, SH110X_WHITE);
-            display.fillTriangle(110, 56, 128, 56, 119, 62, SH110X_WHITE);
+        if(offset + MAX_OPTIONS*MENU_LINE_H < N_OPTIONS*MENU_LINE_H){
+            screen.fill(Layout::ARROW_STEM_X, Layout::ARROW_STEM_Y, Layout::ARROW_STEM_W, Layout::ARROW_STEM_H);
+            display.fillTriangle(Layout::ARROW_X, Layout::ARROW_HEAD_Y, SCREEN_WIDTH, Layout::ARROW_HEAD_Y,
+                SCREEN_WIDTH - Layout::ARROW_W/2, Layout::ARROW_HEAD_Y + Layout::ARROW_HEAD_H - 1, OLED_WHITE);
+            screen.markDirty(Layout::ARROW_X, Layout::ARROW_HEAD_Y, Layout::ARROW_W, Layout::ARROW_HEAD_H);
+        }
+    }
+
+    void show(){
+        if(selected)
+            return; //Whoever is next owns the screen
+
+        //Everything from scratch, sliding in over the previous screen
+        uint32_t h = hash();
+        if(!drawn || h != drawn_hash){
+            if(!drawn)
+                screen.beginTransition();
+            offset = current*MENU_LINE_H;
+            display.clearDisplay();
+            drawList();
+            drawMarkers();
+            if(!drawn)
+                screen.slide();
+            else
+                screen.show();
+            drawn = true;
+            drawn_hash = h;
+            return;
         }
 
-        display.display();
+        //Hardware scroll towards the current option, only the new rows are sent
+        int target = current*MENU_LINE_H;
+        if(offset == target)
+            return;
+        int d = constrain(target - offset, -MENU_SCROLL_STEP, MENU_SCROLL_STEP);
+        screen.scroll(d);
+        offset += d;
+
+        //The markers moved with the list
+        screen.fill(0, -d, MENU_TEXT_X, 8, ROP_CLEAR);
+        screen.fill(Layout::ARROW_X, Layout::ARROW_STEM_Y-d, Layout::ARROW_W, Layout::ARROW_STEM_H + Layout::ARROW_HEAD_H, ROP_CLEAR);
+        drawList();
+        drawMarkers();
+        screen.flushDirty();
     }
 
     //-1 if not selected, otherwise index
     int update(){
         int p = encoder.getRotation();
         current = constrain(current + p, 0, N_OPTIONS-1);
+        if(p != 0)
+            LAT_INPUT(LAT_MENU, encoderTurnedAt);
 
-        if(encoder.isPressed())
+        selected = encoder.isPressed();
+        if(selected){
+            LAT_INPUT(LAT_MENU, encoder.pressed_at);
+            drawn = false;
             return current;
+        }
         else
             return -1;
     }
@@ -106,20 +425,26 @@ struct Menu{
 //POWER OFF MODE
 bool POWER_ON = true;
 
+void applyPower();
+
 struct powerOffMode{
     bool first_time = true;
 
     powerOffMode(){}
 
     void turn_off_all(){
+        settings.save(millis());
         display.clearDisplay();
-        display.display();
+        screen.show();
         arm.move(0);
     }
 
+    //Panel, clock and sound come back before the loading screen, the off profile has
+    //the panel dark and the speaker muted
     void wake_up(){
-        screen.loading_screen();
         POWER_ON = true;
+        applyPower();
+        screen.loading_screen();
     }
 
     void run(){
@@ -137,21 +462,52 @@ struct powerOffMode{
 
 };
 
-powerOffMode powerOffScreen;
 //===================================
 //Idle mode
-String messages[] = {
+//Built-in messages, assets/messages.txt in the bundle replaces them
+const char* const MESSAGES[] = {
     "Hola :D", "Sigue asi!", "No pares!",
     "TKM :)", "Juguemos?", "FOCUS!",
     "Persiste", "SLAY", "Cuenta conmigo",
     "No pivote?", "Miedo al exito?", "Apunta alto"};
 
-int N_MESSAGES = sizeof(messages)/sizeof(messages[0]);
+const int N_BUILTIN_MESSAGES = sizeof(MESSAGES)/sizeof(MESSAGES[0]);
+
+int messageCount(){
+    int n = assets.textCount(ASSET_TEXT_MESSAGES);
+    return n > 0 ? n : N_BUILTIN_MESSAGES;
+}
+
+const char* message(int i){
+    const char* m = assets.text(ASSET_TEXT_MESSAGES, i);
+    return m != NULL ? m : MESSAGES[i % N_BUILTIN_MESSAGES];
+}
 
-// Idle | Battery check | Timer | Pong | Gambling | APAGAR
-String CURRENT_MODE = "Idle";
+//Modes, only the current one exists (ModeSlot). Low battery and power off take over
+//the screen without changing CURRENT_MODE, it comes back rebuilt afterwards
+#define MODE_NONE -1
+#define MODE_IDLE 0
+#define MODE_BDAY 1
+#define MODE_TIMER 2
+#define MODE_STATS 3
+#define MODE_PONG 4
+#define MODE_GAMBLING 5
+#define MODE_BATTERY 6     //Battery check
+#define MODE_LOW_BATTERY 7
+#define MODE_OFF 8
+#define N_MODES 9
+const char* const MODE_NAMES[N_MODES] = {"idle", "bday", "timer", "stats", "pong", "gambling", "battery", "lowbat", "off"};
+int CURRENT_MODE = MODE_IDLE;
 bool LOW_BATTERY = false;
 
+//What has to outlive a mode being destroyed and built again
+struct SharedState{
+    long timer_left = 0;
+    bool timer_loaded = false; //The saved preset is in timer_left
+};
+
+SharedState shared;
+
 struct idleMode{
     unsigned long last_change = 0;
     unsigned long time_now = 0;
@@ -159,14 +515,17 @@ struct idleMode{
 
     bool first_boot = true;
     bool show_message = false;
+    bool face_shown = false; //Eyes are on screen, only changes need drawing
+    bool message_shown = false;
     int idx = 0;
 
     bool on_menu = false;
-    String options[6] = {"Volver", "Feliz cumple", "Timer", "Pong", "Gambling", "APAGAR"};
+    String options[7] = {"Volver", "Feliz cumple", "Timer", "Estudio", "Pong", "Gambling", "APAGAR"};
+    const int option_modes[7] = {MODE_IDLE, MODE_BDAY, MODE_TIMER, MODE_STATS, MODE_PONG, MODE_GAMBLING, MODE_OFF};
     Menu menu;
 
     idleMode(){
-        menu.init(6, options);
+        menu.init(7, options);
     }
 
 
@@ -177,6 +536,8 @@ struct idleMode{
             show_message = false;
             last_change = get_time();
             arm.move(0);
+            faces.morphTo(FACE_IDLE);
+            face_shown = false;
             return;
         }
         
@@ -195,13 +556,15 @@ struct idleMode{
 
         if(show_message){
             while(new_idx == idx)
-                new_idx = random(0, N_MESSAGES);
+                new_idx = random(0, messageCount());
             idx = new_idx;
+            message_shown = false;
         }
         else{
-            while(new_idx == idx || new_idx == SAD || new_idx == ANGRY)
+            while(new_idx == idx || new_idx == FACE_SAD || new_idx == FACE_ANGRY)
                 new_idx = random(0, N_FACES);
             idx = new_idx;
+            faces.morphTo(idx);
         }
     }
 
@@ -211,39 +574,39 @@ struct idleMode{
         menu.show();
 
         if(choice != -1){
-            CURRENT_MODE = options[choice];
+            CURRENT_MODE = option_modes[choice];
             on_menu = false;
 
-            if(CURRENT_MODE == "Volver")
-                CURRENT_MODE = "Idle";
-            else if(CURRENT_MODE == "Pong"){
+            if(CURRENT_MODE == MODE_PONG){
+                screen.beginTransition();
                 display.clearDisplay();
                 screen.printCentered("PONG");
-                display.display();
+                screen.slide();
                 speaker.successBeep();
-                delay(800);
+                hold(800);
             }
-            else if(CURRENT_MODE == "Gambling"){
+            else if(CURRENT_MODE == MODE_GAMBLING){
+                screen.beginTransition();
                 display.clearDisplay();
-                screen.moveCursor(15, screen.centerY);
-                screen.print("LET'S GO GAMBLING");
-                display.display();
+                screen.printCentered("LET'S GO GAMBLING");
+                screen.slide();
 
                 speaker.gamblingBeep();
-                delay(50);    
+                hold(50);    
                 speaker.gamblingBeep();
-                delay(50);
+                hold(50);
                 speaker.successBeep();
             }
 
             //Turn off screen
-            if(CURRENT_MODE == "APAGAR"){
+            if(CURRENT_MODE == MODE_OFF){
                 POWER_ON = false;
+                screen.beginTransition();
                 display.clearDisplay();
                 screen.printCentered("Good Bye :p");
-                display.display();
+                screen.slide(-1);
                 speaker.sadBeep();
-                CURRENT_MODE = "Idle";
+                CURRENT_MODE = MODE_IDLE;
             }
         }
     }
@@ -252,46 +615,69 @@ struct idleMode{
         if(!on_menu){
             updateRandom();
             if(show_message){
-                display.clearDisplay();
-                screen.printCentered(messages[idx]);
-                display.display();
+                //Ticker: each new message slides in once, then nothing to send
+                if(!message_shown){
+                    screen.beginTransition();
+                    display.clearDisplay();
+                    screen.printCentered(message(idx));
+                    screen.slide();
+                    message_shown = true;
+                }
+                face_shown = false;
+            }
+            else{
+                if(!face_shown)
+                    faces.reset();
+                faces.update();
+                power.animating = faces.animating(get_time());
+                face_shown = true;
+                message_shown = false;
             }
-            else
-                screen.showFace(idx);
         }
-        else
+        else{
             menuSelector();
+            face_shown = false;
+            message_shown = false;
+        }
     }
 };
 
-idleMode idleScreen;
 
 
 //============================================
 //Battery related
-#define CRITICAL_VOLTAGE 3.6
-#define MAX_VOLTAGE 4.2
-#define BATTERY_MODE_VOLTAGE 4.1
+#define BAT_ADC_READS 8 //Averaged per sample
+#define BAT_TONE_MA 25 //Buzzer on
+#define BAT_SERVO_MOVE_MA 250 //Servo travelling (holding is in the power profile)
 
 float CURRENT_VOLTAGE = 4.2;
 bool BATTERY_MODE = false;
-
 esp_adc_cal_characteristics_t adc_chars;
 bool battery_initialized = false;
 
-float getVoltage(){
+//Cell voltage in mV (the divider halves it)
+int readBatteryMv(){
     if(!battery_initialized){
         battery_initialized = true;
         esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_12, ADC_WIDTH_BIT_12, 1100, &adc_chars);
     }
-    
-    float voltage = (esp_adc_cal_raw_to_voltage(analogRead(BAT_ADC), &adc_chars))*2;
-    voltage /= 1000.0;
 
-    if(abs(CURRENT_VOLTAGE-voltage) > 0.5)
-        return CURRENT_VOLTAGE; //Avoid spikes of noise
-    else
-        return voltage;
+    PERF_SCOPE(PERF_ADC);
+    STALL_SECTION(STALL_SEC_ADC);
+    uint32_t raw = 0;
+    rep(i, BAT_ADC_READS)
+        raw += analogRead(BAT_ADC);
+    return esp_adc_cal_raw_to_voltage(raw/BAT_ADC_READS, &adc_chars)*2;
+}
+
+//What the cell is delivering right now, from the states we know about
+int batteryLoadMa(){
+    int ma = power.profile >= 0 ? Power::estimateMa(power.profile) : PWR_MA_CPU_160;
+    if(arm.moving())
+        ma += BAT_SERVO_MOVE_MA;
+    if(speaker.playing())
+        ma += BAT_TONE_MA;
+    return ma;
 }
 
 
@@ -304,18 +690,15 @@ struct batteryCheckMenu{
     void run(){
         //Back to idle?
         if(encoder.isPressed()){
-            CURRENT_MODE = "Idle"; 
-            idleScreen.first_boot = true;
+            CURRENT_MODE = MODE_IDLE;
             return;
         }
         
-        charge_percentage = map(CURRENT_VOLTAGE, CRITICAL_VOLTAGE, MAX_VOLTAGE, 0.0, 100.0);
+        charge_percentage = battery.percent();
         display.clearDisplay();
         screen.header("Nivel de bateria");
-        display.setCursor(screen.centerX-(String(charge_percentage).length()*5)+15, screen.centerY);
-        screen.print(String(charge_percentage), 2);
-        screen.print("%", 2);
-        display.display();
+        screen.printCentered(String(charge_percentage) + "%", 2);
+        screen.show();
     }
 
 };
@@ -332,9 +715,9 @@ struct lowBatteryMenu{
         if(first_time){
             display.clearDisplay();
             screen.printCentered("Poca bateria :(");
-            screen.moveCursor(-1, display.getCursorY()+20);
+            screen.moveCursor(-1, Layout::CENTER_FAR_Y);
             screen.printCentered("( cargame )", 1, false);
-            display.display();
+            screen.show();
             speaker.sadBeep();
             first_time = false;
         }
@@ -350,8 +733,24 @@ struct lowBatteryMenu{
 
 };
 
-batteryCheckMenu batteryCheckScreen;
-lowBatteryMenu lowBatteryScreen;
+//Once a second, not every loop
+void updateBattery(){
+    unsigned long now = millis();
+    if(!battery.due(now))
+        return;
+    int mv = readBatteryMv();
+    int load = batteryLoadMa();
+    battery.sample(now, mv, load);
+    CURRENT_VOLTAGE = battery.volts();
+    BATTERY_MODE = !battery.usb;
+
+    if(BATTERY_LOG)
+        Serial.printf("bat,%lu,%d,%d\n", now, mv, load);
+
+    if(battery.low && !LOW_BATTERY)
+        settings.save(now); //The arm parks when the saver profile cuts the servo (Power::servo)
+    LOW_BATTERY = battery.low;
+}
 
 //===================================
 
@@ -360,12 +759,12 @@ struct timerMode{
     bool running = false;
     bool setting = true;
     
-    #define MAX_TIMER_TIME 10800 //3 hours
+    #define MAX_TIMER_TIME SETTINGS_MAX_TIMER //3 hours
     #define STEP 300
     #define ALARM_DELAY 800
 
     //Alarm & time management
-    long time_left = 0;
+    long &time_left = shared.timer_left;
     unsigned long last_change = 0;
     unsigned long time_now = 0;
     bool screen_on = true;
@@ -382,6 +781,11 @@ struct timerMode{
 
     timerMode(){menu.init(4, options);}
 
+    //Leaving mid-session (low battery, power off) counts as a pause
+    ~timerMode(){
+        studylog.pause(millis());
+    }
+
     void menuSelector(){
         options[0] = "Reanudar ( " + format_time(time_left) + " )";
         int choice = menu.update();
@@ -392,6 +796,7 @@ struct timerMode{
                 if(time_left > 0){
                     running = true; //Come back
                     setting = false;
+                    studylog.resume(millis());
                 }
                 else{
                     setting = true;
@@ -404,13 +809,14 @@ struct timerMode{
             }
             else if(choice == 2){
                 //Restart
+                studylog.finish(millis(), false);
                 time_left = 0;
                 setting = true;
                 running = false;
             }
             else{
-                CURRENT_MODE = "Idle"; //back to idle
-                idleScreen.first_boot = true;
+                studylog.finish(millis(), false);
+                CURRENT_MODE = MODE_IDLE; //back to idle
                 setting = true;
                 running = false;
             }
@@ -433,10 +839,10 @@ struct timerMode{
     void time_is_up(){
         if(encoder.isPressed()){
             //Show congrats face
-            screen.showFace(HAPPY);
-            delay(200);
+            screen.showFace(FACE_HAPPY);
+            hold(200);
             speaker.successBeep();
-            delay(1300);
+            hold(1300);
 
             //Back to setting mode
             setting = true;
@@ -470,6 +876,11 @@ struct timerMode{
 
 
     void setting_mode(){
+        if(!shared.timer_loaded){
+            time_left = settings.data.timer_preset;
+            shared.timer_loaded = true;
+        }
+
         //Check button
         if(encoder.isPressed()){
             if(time_left == 0){
@@ -479,6 +890,15 @@ struct timerMode{
             else{
                 setting = false;
                 running = true;
+                if(settings.data.timer_preset != time_left){
+                    settings.data.timer_preset = time_left;
+                    settings.changed(millis());
+                }
+                //"Ajustar" in the middle of a session keeps it going
+                if(studylog.open)
+                    studylog.resume(millis());
+                else
+                    studylog.start(millis(), time_left);
             }
             return;
         }
@@ -486,6 +906,8 @@ struct timerMode{
         //Adjust time
         int p = encoder.getRotation();
         time_left = constrain(time_left + STEP*p, 0 ,MAX_TIMER_TIME);
+        if(p != 0)
+            LAT_INPUT(LAT_TIMER, encoderTurnedAt);
 
         //Print current clock
         screen.printClock(time_left, "Ajustar tiempo");
@@ -497,6 +919,7 @@ struct timerMode{
         if(encoder.isPressed()){
             on_menu = true;
             running = false;
+            studylog.pause(millis());
             return;
         }
 
@@ -515,37 +938,103 @@ struct timerMode{
             screen.printClock(time_left, "Queda poco!");
 
         //Time is up?
-        if(time_left == 0)
+        if(time_left == 0){
             running = false;
+            studylog.finish(millis(), true);
+        }
 
     }
 };
 
-struct gameMode{
-    //Paddle
-    int paddle_high = 18;
-    int paddle_width = 3;
+//Study stats, from the log the timer writes
+String studyTime(uint32_t seconds){
+    uint32_t m = seconds/60;
+    if(m < 60)
+        return String(m) + "m";
+    return String(m/60) + "h" + (m%60 < 10 ? "0" : "") + String(m%60);
+}
 
-    int l_pos = SCREEN_HEIGHT/2;
-    int r_pos = SCREEN_HEIGHT/2;
+struct statsMenu{
+    bool first_time = true;
 
-    //Ball
-    int cpu_speed = 3;
-    int x_vel = 3;
-    int y_vel = 3;
+    statsMenu(){}
 
-    int x_pos = 40;
-    int y_pos = 26;
+    void line(int y, String label, const StudySummary &s){
+        screen.moveCursor(0, y);
+        screen.print(label + String(s.sessions) + " ses " + studyTime(s.studied));
+    }
+
+    void draw(){
+        display.clearDisplay();
+        screen.header("Estudio");
+        if(!studylog.ready){
+            screen.printCentered("Sin registro");
+            screen.show();
+            return;
+        }
+
+        StudySummary today, week, total;
+        studylog.summary(millis(), today, week, total);
+        String labels[3];
+        StudySummary* rows[3];
+        int n = 0;
+        if(studylog.clock_set){
+            labels[n] = "Hoy: ";
+            rows[n++] = &today;
+            labels[n] = "Semana: ";
+            rows[n++] = &week;
+        }
+        else{
+            labels[n] = "Encendido: "; //No clock, no days
+            rows[n++] = &today;
+        }
+        labels[n] = "Total: ";
+        rows[n++] = &total;
+
+        //A short panel has fewer rows, Total stays in the last one
+        int shown = n < Layout::ROW_N ? n : Layout::ROW_N;
+        rep(i, shown){
+            int k = i == shown-1 ? n-1 : i;
+            line(Layout::ROW_Y0 + i*Layout::ROW_H, labels[k], *rows[k]);
+        }
+
+        screen.moveCursor(0, Layout::STATUS_Y);
+        screen.print("Completas: " + String(total.done));
+        screen.show();
+    }
+
+    void run(){
+        if(first_time){
+            draw();
+            first_time = false;
+        }
+
+        //Back to idle?
+        if(encoder.isPressed()){
+            CURRENT_MODE = MODE_IDLE;
+            first_time = true;
+        }
+    }
+};
+
+struct gameMode{
+    PongPhysics pong;
+    PongClock clock;
+    PongRenderer renderer;
+
+    int16_t &cpu_speed = settings.data.pong_level;
 
     //Scores
-    int WINNING_SCORE = 3;
-    #define MAX_SCORE 20
-    #define MAX_DIF 5
+    int16_t &WINNING_SCORE = settings.data.pong_rounds;
+    #define MAX_SCORE SETTINGS_MAX_ROUNDS
+    #define MAX_DIF (PONG_N_LEVELS-1)
     int l_score = 0;
     int r_score = 0;
+    int last_paddle = -1; //Paddle moves are latency probe inputs
 
     bool playing = false;
     bool ending = false;
+    bool celebrating = false;
     bool choosing_dif = false;
     bool choosing_points = false;
 
@@ -561,6 +1050,8 @@ struct gameMode{
     Menu startMenu;
 
     gameMode(){
+        pong.init(SCREEN_WIDTH, SCREEN_HEIGHT, 1);
+        renderer.init(screen.blit, screen.text, screen.sync);
         menu.init(3, options);
         startMenu.init(4, start_options);
     }
@@ -572,6 +1063,8 @@ struct gameMode{
         if(choice != -1){
             if(choice == 0){
                 playing = true;
+                clock.reset(get_time());
+                renderer.reset();
             }
             else if(choice == 1){
                 playing = false;
@@ -582,11 +1075,10 @@ struct gameMode{
                 ending = false;
 
                 //Show sad face before leaving
-                screen.showFace(SAD);
+                screen.showFace(FACE_SAD);
                 speaker.sadBeep();
-                delay(1000);
-                CURRENT_MODE = "Idle";
-                idleScreen.first_boot = true;
+                hold(1000);
+                CURRENT_MODE = MODE_IDLE;
             }
             on_menu = false;
         }
@@ -621,8 +1113,7 @@ struct gameMode{
                 choosing_dif = false;
                 choosing_points = false;
 
-                CURRENT_MODE = "Idle";
-                idleScreen.first_boot = true;
+                CURRENT_MODE = MODE_IDLE;
             }
             on_menu = false;
         }   
@@ -634,25 +1125,21 @@ struct gameMode{
         l_score = 0;
         r_score = 0;
 
-        x_pos = 40;
-        y_pos = 26;
-
-        l_pos = SCREEN_HEIGHT/2;
-        r_pos = SCREEN_HEIGHT/2;
+        //Set out by diff
+        pong.rng = random(1, 0x7FFFFFFF);
+        pong.set_difficulty(cpu_speed);
+        pong.start();
 
         playing = true;
 
-        //Set out by diff
-        paddle_high = max(20 - cpu_speed, 2);
-        x_vel = 1 + cpu_speed;
-        y_vel = x_vel;
-
         //Start screen
         display.clearDisplay();
         screen.printCentered("A jugar :D");
-        display.display();
+        screen.show();
         speaker.successBeep();
-        delay(800);
+        hold(800);
+        clock.reset(get_time());
+        renderer.reset();
     }
 
     void run(){
@@ -677,18 +1164,20 @@ struct gameMode{
             return;
         }
 
-        WINNING_SCORE += encoder.getRotation();
-        WINNING_SCORE = constrain(WINNING_SCORE, 1, MAX_SCORE);
+        int p = encoder.getRotation();
+        WINNING_SCORE = constrain(WINNING_SCORE + p, 1, MAX_SCORE);
+        if(p != 0)
+            settings.changed(millis());
 
         screen.printCenteredTextNumber("Cant. rondas:", WINNING_SCORE);
 
         //Easter egg
         if(WINNING_SCORE == MAX_SCORE){
-            screen.moveCursor(screen.centerX-10, 50);
+            screen.moveCursor(Layout::CENTER_X-10, Layout::FOOTER_Y);
             screen.print("( INSANO )");
         }
         
-        display.display();     
+        screen.show();     
     }
 
 
@@ -698,62 +1187,35 @@ struct gameMode{
             return;
         }
 
-        cpu_speed += encoder.getRotation();
-        cpu_speed = constrain(cpu_speed, 0, MAX_DIF);
+        int p = encoder.getRotation();
+        cpu_speed = constrain(cpu_speed + p, 0, MAX_DIF);
+        if(p != 0)
+            settings.changed(millis());
 
         screen.printCenteredTextNumber("Dificultad:", cpu_speed);
 
         //Easter egg
         if(cpu_speed == MAX_DIF){
-            screen.moveCursor(screen.centerX-10, 50);
+            screen.moveCursor(Layout::CENTER_X-10, Layout::FOOTER_Y);
             screen.print("( INSANO )");
         }
         
-        display.display();
+        screen.show();
     }
 
 
     void ending_menu(){
-        if(r_score == WINNING_SCORE){
-            //Bot wins
-            screen.showFace(HAPPY);
-            speaker.celebrationBeep();
-            arm.move(100);
-            speaker.celebrationBeep();
-            arm.move(0);
-            screen.showFace(LOOK_LEFT);
-            speaker.successBeep();
-            arm.move(100);
-            screen.showFace(LOOK_RIGHT);
-            speaker.successBeep();
-            arm.move(0);   
-
-            //Show messages
-            display.clearDisplay();
-            screen.printCentered("TE GANEEE!");
-            display.display();
-            delay(2500);
+        //Start the show once, then wait until it is over
+        if(!celebrating){
+            timeline.play(r_score == WINNING_SCORE ? BOT_WINS : BOT_LOSES);
+            celebrating = true;
+            return;
         }
-        else{
-            //Bot losses
-            screen.showFace(ANGRY);
-            speaker.angryBeep();
-            arm.move(100);
-            speaker.angryBeep();
-            arm.move(0);
-            speaker.angryBeep();
-            arm.move(100);
-            screen.showFace(SAD);
-            arm.move(0);
-            speaker.sadBeep();
 
-            //Show message
-            display.clearDisplay();
-            screen.printCentered("HAS GANADO!");
-            display.display();
-            delay(2500);
-        }
+        if(timeline.busy())
+            return;
 
+        celebrating = false;
         ending = false;
         playing = false;
         choosing_dif = false;
@@ -769,65 +1231,40 @@ struct gameMode{
         }
 
         //Update positions
-        l_pos = map(pot.getReading(), MAX_POT_POS, MIN_POT_POS, 0, SCREEN_HEIGHT-paddle_high);
-
-        //cpu
-
-        //Move generator
-        int needs_move = random(1, 1001);
-        if(needs_move <= max(190*cpu_speed, 500)){
-            if(r_pos + paddle_high < y_pos)
-                r_pos = constrain(r_pos+cpu_speed*2+1, 0, SCREEN_HEIGHT-paddle_high);
-            else if(r_pos > y_pos)
-                r_pos = constrain(r_pos-cpu_speed*2+1, 0, SCREEN_HEIGHT-paddle_high);
+        int paddle = map(pot.getReading(), MAX_POT_POS, MIN_POT_POS, 0, SCREEN_HEIGHT-pong.paddle_high);
+        if(paddle != last_paddle)
+            LAT_INPUT(LAT_PONG, micros());
+        last_paddle = paddle;
+        pong.set_left(paddle);
+
+        //Fixed steps, however long the last frame took
+        uint8_t events = 0;
+        int steps = clock.advance(get_time());
+        rep(i, steps){
+            uint8_t ev = pong.step();
+            events |= ev;
+
+            if(ev & PONG_LEFT_SCORES)
+                l_score = constrain(l_score+1, 0, WINNING_SCORE);
+            if(ev & PONG_RIGHT_SCORES)
+                r_score = constrain(r_score+1, 0, WINNING_SCORE);
         }
 
         //Write to servo
-        arm.move(map(r_pos, 0, SCREEN_HEIGHT-paddle_high, 100, 0));
+        arm.move(map(FROM_FP(pong.r_pos), 0, SCREEN_HEIGHT-pong.paddle_high, 100, 0));
 
-        // Check for ball bouncing into paddles:
-        if (ball_on_right_paddle() || ball_on_left_paddle()){
-            x_vel = -x_vel;
-            speaker.beep(300, 100);
-        }
+        // Draw pong elements (only what changed)
+        fixed t = clock.alpha();
+        renderer.draw(pong.render_x(t), pong.render_y(t), FROM_FP(pong.l_pos), FROM_FP(pong.r_pos),
+                      pong.paddle_width, pong.paddle_high, l_score, r_score);
+        screen.flushDirty();
+        PERF_RECORD(PERF_PONG_BYTES, screen.flushed_bytes);
 
-        //Check hits on sides
-        if(x_pos > SCREEN_WIDTH-1){
-            ball_reset(false);
-            l_score = constrain(l_score+1, 0, WINNING_SCORE);
+        //Sounds go after the frame (they block)
+        if(events & PONG_HIT_PADDLE)
+            speaker.beep(300, 100);
+        if(events & (PONG_LEFT_SCORES | PONG_RIGHT_SCORES))
             speaker.actionBeep();
-        }
-        else if(x_pos < 0){
-            ball_reset(true);
-            r_score = constrain(r_score+1, 0, WINNING_SCORE);
-            speaker.actionBeep();          
-        }
-
-        //Check hits on ceiling
-        if(y_pos > SCREEN_HEIGHT-1 || y_pos < 0)
-            y_vel = -y_vel;
-
-        //Update ball
-        x_pos += x_vel;
-        y_pos += y_vel;
-
-        // Draw pong elements:
-        display.clearDisplay();
-        display.fillCircle(x_pos, y_pos, 3, SH110X_WHITE);
-        display.fillRect(0, l_pos, paddle_width, paddle_high, SH110X_WHITE);
-        display.fillRect(SCREEN_WIDTH-paddle_width , r_pos, paddle_width, paddle_high, SH110X_WHITE);
-
-        // Display scores
-        display.setTextSize(1);
-        display.setTextColor(SH110X_WHITE);
-        display.setCursor(display.width()/4,0);
-        display.println(l_score);
-        display.setCursor(display.width()*3/4,0);
-        display.println(r_score);
-
-        // Display all elements
-        display.display();
-
 
         //Check if winner
         if(l_score >= WINNING_SCORE || r_score >= WINNING_SCORE){
@@ -839,43 +1276,16 @@ struct gameMode{
 
     }
 
-
-    void ball_reset(bool left){
-        //If left is true, then ball should launch from the left, otherwise launch from the right
-        //Ball should launch at a random Y location and at a random Y velocity
-
-        y_pos = random(display.height());
-        if (random(2)>0)
-            y_vel = abs(y_vel);
-        else
-            y_vel = -abs(y_vel);
-
-        if (left){
-            x_vel = abs(x_vel);
-            x_pos = paddle_width-1;
-        }
-        else{
-            x_vel = -abs(x_vel);
-            x_pos = display.width()-paddle_width;  
-        }
-    }
-
-    bool ball_on_right_paddle(){
-        return((x_pos+x_vel) >= (SCREEN_WIDTH-paddle_width-1) && y_pos >= r_pos && y_pos <= (r_pos + paddle_high));
-    }
-
-    bool ball_on_left_paddle(){
-        return((x_pos+x_vel) <= paddle_width+1 && y_pos >= l_pos && y_pos <= (l_pos + paddle_high));
-    }
-
 };
 
 
 struct decisionMode{
     bool setting_up = false;
     bool gambling = false;
+    bool rolling = false;
+    bool showing = false;
     int threshold = (MAX_POT_POS-MIN_POT_POS)/2;
-    int choices = 2;
+    int16_t &choices = settings.data.gamble_choices;
 
     /*
     Main idea: Lift up the potentiometer arm and once ready
@@ -888,40 +1298,45 @@ struct decisionMode{
     decisionMode(){}
 
     void run(){
+        //The result screen uses the click to continue
+        if(gambling){
+            gambling_menu();
+            return;
+        }
+
         //Back to idle?
         if(encoder.isPressed()){
-            CURRENT_MODE = "Idle"; 
+            CURRENT_MODE = MODE_IDLE;
             setting_up = true;
             gambling = false;
-            idleScreen.first_boot = true;
             return;
         }
         
         if(!setting_up)
             setting_up = pot.getReading() > threshold;
 
-        if(gambling)
-            gambling_menu();
-        else if(setting_up)
+        if(setting_up)
             setting_up_menu();
         else{
             display.clearDisplay();
             screen.header("Decision maker");
             screen.printCentered("Levanta mi");
-            screen.moveCursor(-1, display.getCursorY()+10);
+            screen.moveCursor(-1, Layout::CENTER_NEXT_Y);
             screen.printCentered("Brazo derecho", 1, false);
-            display.display();
+            screen.show();
         }
     }
 
 
     void setting_up_menu(){
         int p = encoder.getRotation();
-        choices = constrain(choices + p, 2, 99);
+        choices = constrain(choices + p, 2, SETTINGS_MAX_CHOICES);
+        if(p != 0)
+            settings.changed(millis());
 
         screen.printCenteredTextNumber("Opciones:", choices);
         screen.print("Bajar brazo = elegir");
-        display.display();
+        screen.show();
 
         gambling = pot.getReading() <= threshold;
         setting_up = !gambling;
@@ -930,92 +1345,434 @@ struct decisionMode{
 
     void gambling_menu(){
         //Animation
-        screen.showFace(IDLE);
-        speaker.gamblingBeep();
-        screen.showFace(LOOK_RIGHT);
-        speaker.gamblingBeep();  
-        screen.showFace(LOOK_LEFT);
-        speaker.gamblingBeep();
-        screen.showFace(HAPPY);
-        speaker.successBeep();  
-
-        //Calculate & show
-        int number = random(1, choices+1);
-        screen.printCenteredTextNumber("ELEGIDO:", number); 
-        screen.moveCursor(0, 50);
-        screen.printCentered("Click = continuar", 1, false);
-        display.display();
-        
-        while(!encoder.isPressed()){}
+        if(!rolling && !showing){
+            timeline.play(GAMBLING_ROLL);
+            rolling = true;
+            return;
+        }
+
+        if(rolling){
+            if(timeline.busy())
+                return;
+            rolling = false;
+
+            //Calculate & show
+            int number = random(1, choices+1);
+            screen.printCenteredTextNumber("ELEGIDO:", number);
+            screen.moveCursor(0, Layout::FOOTER_Y);
+            screen.printCentered("Click = continuar", 1, false);
+            screen.show();
+            showing = true;
+            return;
+        }
+
+        if(encoder.isPressed()){
+            showing = false;
+            gambling = false;
+        }
+    }
+
+};
+
+
+//===================================
+//Birthday
+struct birthdayMode{
+    int stage = 0;
+
+    birthdayMode(){}
+
+    void run(){
+        if(timeline.busy())
+            return;
+
+        if(stage == 0)
+            timeline.play(BDAY_INTRO); //Song
+        else if(stage == 1)
+            timeline.play(BDAY_OUTRO);
+        else
+            CURRENT_MODE = MODE_IDLE;
+
+        stage = (stage + 1) % 3;
+    }
+};
+
+
+//Only the current mode exists: built when it is entered, destroyed when it is left
+struct ModeSlot{
+    int tag = MODE_NONE;
+    union{
+        idleMode idle;
+        birthdayMode birthday;
+        timerMode timer;
+        statsMenu stats;
+        gameMode game;
+        decisionMode decision;
+        batteryCheckMenu batteryCheck;
+        lowBatteryMenu lowBattery;
+        powerOffMode powerOff;
+    };
+
+    ModeSlot(){}
+    ~ModeSlot(){
+        leave();
+    }
+
+    void leave(){
+        switch(tag){
+            case MODE_IDLE: idle.~idleMode(); break;
+            case MODE_BDAY: birthday.~birthdayMode(); break;
+            case MODE_TIMER: timer.~timerMode(); break;
+            case MODE_STATS: stats.~statsMenu(); break;
+            case MODE_PONG: game.~gameMode(); break;
+            case MODE_GAMBLING: decision.~decisionMode(); break;
+            case MODE_BATTERY: batteryCheck.~batteryCheckMenu(); break;
+            case MODE_LOW_BATTERY: lowBattery.~lowBatteryMenu(); break;
+            case MODE_OFF: powerOff.~powerOffMode(); break;
+        }
+        tag = MODE_NONE;
+    }
+
+    void enter(int mode){
+        leave();
+        switch(mode){
+            case MODE_IDLE: new (&idle) idleMode(); break;
+            case MODE_BDAY: new (&birthday) birthdayMode(); break;
+            case MODE_TIMER: new (&timer) timerMode(); break;
+            case MODE_STATS: new (&stats) statsMenu(); break;
+            case MODE_PONG: new (&game) gameMode(); break;
+            case MODE_GAMBLING: new (&decision) decisionMode(); break;
+            case MODE_BATTERY: new (&batteryCheck) batteryCheckMenu(); break;
+            case MODE_LOW_BATTERY: new (&lowBattery) lowBatteryMenu(); break;
+            case MODE_OFF: new (&powerOff) powerOffMode(); break;
+            default: return;
+        }
+        tag = mode;
+    }
 
-        gambling = false;
+    void run(){
+        switch(tag){
+            case MODE_IDLE: idle.run(); break;
+            case MODE_BDAY: birthday.run(); break;
+            case MODE_TIMER: timer.run(); break;
+            case MODE_STATS: stats.run(); break;
+            case MODE_PONG: game.run(); break;
+            case MODE_GAMBLING: decision.run(); break;
+            case MODE_BATTERY: batteryCheck.run(); break;
+            case MODE_LOW_BATTERY: lowBattery.run(); break;
+            case MODE_OFF: powerOff.run(); break;
+        }
     }
 
+    //Static RAM of the slot against every mode as its own global ("mem")
+    void footprint(Print &out){
+        const char* names[] = {"idle", "birthday", "timer", "stats", "pong", "gambling", "battery", "low battery", "off"};
+        size_t sizes[] = {sizeof(idleMode), sizeof(birthdayMode), sizeof(timerMode), sizeof(statsMenu), sizeof(gameMode),
+            sizeof(decisionMode), sizeof(batteryCheckMenu), sizeof(lowBatteryMenu), sizeof(powerOffMode)};
+        size_t all = 0;
+        rep(i, 9){
+            out.printf("%-12s %5u\n", names[i], unsigned(sizes[i]));
+            all += sizes[i];
+        }
+        out.printf("globals %u, slot %u (+%u shared): %u bytes saved\n", unsigned(all), unsigned(sizeof(ModeSlot)),
+            unsigned(sizeof(SharedState)), unsigned(all - sizeof(ModeSlot) - sizeof(SharedState)));
+    }
 };
 
+ModeSlot modes;
+
+void cmdMemory(const char* args){
+    modes.footprint(Serial);
+    Serial.printf("heap free %u, min %u\n", unsigned(ESP.getFreeHeap()), unsigned(ESP.getMinFreeHeap()));
+}
+
+//Remote control: the input goes through Encoder/Potentiometer, so modes take it like the real thing
+void cmdRotate(const char* args){
+    int steps = atoi(args);
+    encoder.injected_steps += steps != 0 ? steps : 1;
+    if(LATENCY_MODE)
+        encoderTurnedAt = micros();
+}
+
+void cmdClick(const char* args){
+    encoder.injected_click = true;
+}
+
+void cmdPot(const char* args){
+    if(strcmp(args, "off") == 0)
+        pot.forced = -1;
+    else if(*args != 0)
+        pot.forced = constrain(atoi(args), 0, 100);
+    Serial.printf("%d%s\n", pot.getReading(), pot.forced >= 0 ? " (forced)" : "");
+}
+
+//Takes effect on this loop, the mode is built from scratch
+void cmdMode(const char* args){
+    int mode = -1;
+    rep(i, N_MODES)
+        if(strcmp(args, MODE_NAMES[i]) == 0)
+            mode = i;
+    if(mode == MODE_LOW_BATTERY)
+        mode = -1; //Only the battery gets there
+    if(mode < 0){
+        Serial.printf("%s%s\n", POWER_ON ? "" : "off, ", MODE_NAMES[CURRENT_MODE]);
+        return;
+    }
+
+    POWER_ON = mode != MODE_OFF; //The loop stops the timeline when it rebuilds the mode
+    if(POWER_ON)
+        CURRENT_MODE = mode;
+    modes.leave();
+    Serial.println("ok");
+}
+
+void cmdFace(const char* args){
+    //Only idle's face view draws faces, any other screen would paint over it next frame
+    if(modes.tag != MODE_IDLE || modes.idle.on_menu){
+        Serial.println("? face: only on the idle face (mode idle)");
+        return;
+    }
+    int idx = constrain(atoi(args), 0, N_FACES-1);
+    faces.morphTo(idx); //Idle's next run() morphs to it
+    modes.idle.show_message = false;
+    Serial.println(idx);
+}
 
-timerMode timerScreen;
-gameMode gameScreen;
-decisionMode decisionScreen;
+//The beeps block the loop like they do in the modes, the song does not
+void cmdMelody(const char* args){
+    if(strcmp(args, "bday") == 0) bday.start();
+    else if(strcmp(args, "startup") == 0) speaker.startupBeep();
+    else if(strcmp(args, "action") == 0) speaker.actionBeep();
+    else if(strcmp(args, "alarm") == 0) speaker.alarmBeep();
+    else if(strcmp(args, "success") == 0) speaker.successBeep();
+    else if(strcmp(args, "gambling") == 0) speaker.gamblingBeep();
+    else if(strcmp(args, "sad") == 0) speaker.sadBeep();
+    else if(strcmp(args, "celebration") == 0) speaker.celebrationBeep();
+    else if(strcmp(args, "angry") == 0) speaker.angryBeep();
+    else{
+        Serial.println("? melody");
+        return;
+    }
+    Serial.println("ok");
+}
+
+//Built-in benchmarks, ESP.getCycleCount() around the real code paths. face and menu
+//draw into the buffer only and put the screen back afterwards, flush sends to the panel
+#define BENCH_DEFAULT_N 20
+#define BENCH_FACE_ROWS 32 //Face band blitted at the top, on the glass of both panels
+
+void benchFace(SerialOut &out, int n){
+    BenchStat bitmap, model;
+    rep(k, n)
+        rep(i, N_FACES){
+            uint32_t start = ESP.getCycleCount();
+            screen.blit.rowBitmap(0, 0, Faces[i] + (Layout::FACE_H - BENCH_FACE_ROWS)/2*Layout::FACE_W/8,
+                                  Layout::FACE_W, BENCH_FACE_ROWS, ROP_SET);
+            bitmap.add(ESP.getCycleCount() - start);
+
+            FaceParams f;
+            memcpy_P(&f, &FACE_PRESETS[i], sizeof(f));
+            display.clearDisplay();
+            start = ESP.getCycleCount();
+            faces.renderer.draw(f, display.getBuffer());
+            model.add(ESP.getCycleCount() - start);
+        }
+    bitmap.print(out, "face bitmap", "cycles", getCpuFrequencyMhz());
+    model.print(out, "face model", "cycles", getCpuFrequencyMhz());
+}
+
+void benchMenu(SerialOut &out, int n){
+    String options[7] = {"Volver", "Feliz cumple", "Timer", "Estudio", "Pong", "Gambling", "APAGAR"};
+    Menu menu;
+    menu.init(7, options);
+    BenchStat list, markers;
+    rep(k, n){
+        menu.offset = (k % 7)*MENU_LINE_H;
+        display.clearDisplay();
+        uint32_t start = ESP.getCycleCount();
+        menu.drawList();
+        list.add(ESP.getCycleCount() - start);
+        start = ESP.getCycleCount();
+        menu.drawMarkers();
+        markers.add(ESP.getCycleCount() - start);
+    }
+    list.print(out, "menu list", "cycles", getCpuFrequencyMhz());
+    markers.print(out, "menu markers", "cycles", getCpuFrequencyMhz());
+}
+
+void benchFlush(SerialOut &out, int n){
+    BenchStat full, small;
+    rep(k, n){
+        uint32_t start = ESP.getCycleCount();
+        screen.show();
+        full.add(ESP.getCycleCount() - start);
+
+        //A blinking 8x8 corner, like a cursor or a clock digit
+        screen.fill(SCREEN_WIDTH-8, 0, 8, 8, ROP_XOR);
+        start = ESP.getCycleCount();
+        screen.flushDirty();
+        small.add(ESP.getCycleCount() - start);
+    }
+    if(n % 2 == 1){
+        screen.fill(SCREEN_WIDTH-8, 0, 8, 8, ROP_XOR);
+        screen.flushDirty();
+    }
+    full.print(out, "flush full", "cycles", getCpuFrequencyMhz());
+    small.print(out, "flush 8x8", "cycles", getCpuFrequencyMhz());
+}
+
+//The song plays on its own timing: the first call starts it, the next ones report
+bool melody_bench = false;
+
+void benchMelody(SerialOut &out){
+#if PERF_MODE
+    if(bday.playing()){
+        Serial.printf("melody note %d/%d\n", bday.thisNote/2, bday.tune_notes);
+        return;
+    }
+    if(!melody_bench){
+        timeline.stop();
+        bday.start();
+        melody_bench = true;
+        Serial.printf("melody playing %d notes, 'bench melody' again when it ends\n", bday.tune_notes);
+        return;
+    }
+    melody_bench = false;
+    bday.note_cycles.print(out, "melody note", "cycles", getCpuFrequencyMhz());
+    bday.note_late.print(out, "melody late", "ms", 0);
+#else
+    (void)out;
+    Serial.println("melody bench is off, build with -DPERF_MODE=1");
+#endif
+}
+
+void cmdBench(const char* args){
+    char what[8] = "";
+    int n = BENCH_DEFAULT_N;
+    sscanf(args, "%7s %d", what, &n);
+    n = constrain(n, 1, 1000);
+    bool all = strcmp(what, "all") == 0;
+    SerialOut out;
+
+    //face and menu draw over the screen, it comes back when they are done
+    screen.beginTransition();
+    bool drew = false;
+    if(all || strcmp(what, "face") == 0){
+        benchFace(out, n);
+        drew = true;
+    }
+    if(all || strcmp(what, "menu") == 0){
+        benchMenu(out, n);
+        drew = true;
+    }
+    if(drew){
+        memcpy(display.getBuffer(), screen.back, sizeof(screen.back));
+        screen.show();
+    }
+    if(all || strcmp(what, "flush") == 0)
+        benchFlush(out, n);
+    if(all || strcmp(what, "melody") == 0)
+        benchMelody(out);
+    else if(!drew && strcmp(what, "flush") != 0)
+        Serial.println("? bench face|menu|flush|melody|all [n]");
+}
 
 
 //===================================
 
+//PERF_MODE_* numbering, also used by the tracer
+int modeId(){
+    if(LOW_BATTERY || !POWER_ON) return PERF_MODE_OTHER;
+    switch(CURRENT_MODE){
+        case MODE_IDLE: return PERF_MODE_IDLE;
+        case MODE_BDAY: return PERF_MODE_BDAY;
+        case MODE_TIMER: return PERF_MODE_TIMER;
+        case MODE_PONG: return PERF_MODE_PONG;
+        case MODE_GAMBLING: return PERF_MODE_GAMBLING;
+    }
+    return PERF_MODE_OTHER;
+}
+
+int traced_mode = -1;
+
+//Power profile for what the bot is doing now
+int powerProfile(){
+    if(!POWER_ON)
+        return PWR_OFF;
+    if(LOW_BATTERY)
+        return PWR_SAVER;
+    if(CURRENT_MODE == MODE_PONG)
+        return PWR_GAME;
+
+    unsigned long idle_after = BATTERY_MODE ? PWR_IDLE_AFTER_BATTERY_MS : PWR_IDLE_AFTER_MS;
+    if(modes.tag == MODE_IDLE && !modes.idle.on_menu && millis() - encoder.last_input > idle_after)
+        return PWR_IDLE;
+    return PWR_UI;
+}
+
+void applyPower(){
+    power.apply(powerProfile(), BATTERY_MODE);
+}
+
 void loop(){
-    //Check battery
-    CURRENT_VOLTAGE = getVoltage();
-    // if(CURRENT_VOLTAGE <= CRITICAL_VOLTAGE && !LOW_BATTERY){
-    //     LOW_BATTERY = true;
-    //     lowBatteryScreen.first_time = true;
-    // }
-    // else if(CURRENT_VOLTAGE >= CRITICAL_VOLTAGE && LOW_BATTERY)
-    //     LOW_BATTERY = false;
-
-    //Activate battery mode
-    BATTERY_MODE = (CURRENT_VOLTAGE < BATTERY_MODE_VOLTAGE);
-    arm.ACTIVE_ARM = !BATTERY_MODE;
+    PERF_TICK(PERF_LOOP);
+    STALL_NEXT(modeId());
+    TRACE_PUMP();
+    TRACE_SCOPE(TRACE_LOOP, 0);
+    if(DEBG_MODE || PERF_MODE || MIRROR_MODE){
+        STALL_SECTION(STALL_SEC_CONSOLE);
+        console.update();
+    }
+
+    //Check battery (low battery, running from the battery)
+    updateBattery();
+    applyPower();
+    settings.update(millis());
+
+    ENERGY_SET_MODE(modeId());
+    if(TRACE_MODE && modeId() != traced_mode){
+        traced_mode = modeId();
+        TRACE_INSTANT(TRACE_MODE_SET, traced_mode);
+    }
     
+    //Mode changes asked for during the last loop happen here, never inside a run()
+    int mode = LOW_BATTERY ? MODE_LOW_BATTERY : (!POWER_ON ? MODE_OFF : CURRENT_MODE);
+    if(modes.tag != mode){
+        timeline.stop(); //A show never outlives its mode (low battery and power off too)
+        modes.enter(mode);
+    }
+
+    //These branches pump the arm too: a move() right after an update() waits for it
     if(LOW_BATTERY){
-        lowBatteryScreen.run();
-        delay(100);
+        PERF_SCOPE(PERF_MODE_OTHER);
+        modes.run();
+        speaker.update();
+        arm.update();
+        power.pace();
         return;
     }
 
 
     //Is powered off?
     if(!POWER_ON){
-        powerOffScreen.run();
+        PERF_SCOPE(PERF_MODE_OTHER);
+        modes.run();
+        arm.update();
+        power.pace();
         return;
     }
 
 
     //Normal behaviour
-    if(CURRENT_MODE == "Idle")
-        idleScreen.run();
-    else if(CURRENT_MODE == "Feliz cumple"){
-        screen.clear();
-        screen.printCentered("Feliz cumple :D");
-        screen.show();
-        bday.run();
-        CURRENT_MODE = "Idle";
-        screen.showFace(HAPPY);
-        delay(1500);
-        screen.clear();
-        screen.printCentered("Con cariño");
-        screen.show();
-        speaker.successBeep();
-        delay(900);
-        screen.clear();
-        screen.printCentered("By Mati :)");
-        screen.show();
-        delay(1000);
-    }
-    else if(CURRENT_MODE == "Timer")
-        timerScreen.run();
-    else if(CURRENT_MODE == "Pong")
-        gameScreen.run();
-    else if(CURRENT_MODE == "Gambling")
-        decisionScreen.run();
-    
-    delay(20);
+    {
+        PERF_SCOPE(modeId());
+        modes.run();
+    }
+
+    {
+        STALL_SECTION(STALL_SEC_TIMELINE);
+        timeline.update();
+    }
+    arm.update();
+    power.pace();
 }
@@ -0,0 +1,222 @@
+#ifndef MIRROR_H
+#define MIRROR_H
+
+//Screen mirror: after every flush the pages that changed since the last frame sent go
+//out over the serial port, XOR'd with what was sent and run length coded, so a still
+//screen costs nothing and a Pong frame a few dozen bytes. tools/oled_viewer.py
+//rebuilds the frames on the PC (live view, fps, PNG capture). "mirror on" starts it.
+//
+//Frame: MIRROR_FRAME_START, flags (bit 0 key, bits 1-3 pages-1), seq, width, page
+//mask, ms (u16), payload length (u16), payload, xor of everything after the start.
+//A key frame is coded against a blank screen, the viewer starts from one. Payload,
+//per page in the mask, tokens until the page is covered:
+//  0x00-0x7F  n+1 unchanged bytes
+//  0x80-0xBF  n+1 bytes follow, XOR with the previous frame
+//  0xC0-0xFF  the next byte n+3 times (XOR)
+//
+//Frames only go out when the whole frame fits in the UART buffer. Otherwise nothing is
+//sent and the pages stay different, the next frame carries them: the stream never
+//waits and never gets ahead of the link (115200 baud = 11.5 kB/s).
+//
+//Plain C++, tools/mirror_sim.cpp runs the same encoder on the PC.
+#include <stdint.h>
+#include <string.h>
+
+#define MIRROR_FRAME_START 0xD7
+#define MIRROR_HEADER 9 //Start to length
+#define MIRROR_KEY 1
+#define MIRROR_MAX_PAGES 8
+#define MIRROR_MAX_WIDTH 128
+#define MIRROR_LITERAL 64
+#define MIRROR_REPEAT 66
+#define MIRROR_MAX_FRAME (MIRROR_HEADER + MIRROR_MAX_PAGES*(MIRROR_MAX_WIDTH + MIRROR_MAX_WIDTH/MIRROR_LITERAL) + 1)
+#define MIRROR_KEY_MS 5000 //Key frame every so often, a viewer can join any time
+
+struct MirrorEncoder{
+    int width = 0;
+    int pages = 0;
+    uint8_t prev[MIRROR_MAX_PAGES*MIRROR_MAX_WIDTH]; //What the viewer has
+    uint8_t out[MIRROR_MAX_FRAME + MIRROR_LITERAL + 2]; //Room for the token that gives up on a page
+    uint8_t seq = 0;
+    bool key_pending = true;
+    uint8_t mask = 0; //Pages in the frame in out[]
+
+    //Stats
+    uint32_t frames = 0;
+    uint32_t keys = 0;
+    uint32_t deferred = 0; //Frames that did not fit, carried by the next one
+    uint32_t bytes = 0;
+    uint32_t raw = 0;      //Bytes of the pages sent, uncompressed
+
+    MirrorEncoder(){}
+
+    void init(int width, int height){
+        this->width = width < MIRROR_MAX_WIDTH ? width : MIRROR_MAX_WIDTH;
+        pages = height/8 < MIRROR_MAX_PAGES ? height/8 : MIRROR_MAX_PAGES;
+        key_pending = true;
+    }
+
+    void key(){
+        key_pending = true;
+    }
+
+    //One page, XOR with ref (NULL = blank), returns bytes written. Noise would code
+    //bigger than the page, then it goes as plain literals
+    int page(const uint8_t* cur, const uint8_t* ref, uint8_t* dst){
+        int limit = width + (width + MIRROR_LITERAL - 1)/MIRROR_LITERAL;
+        uint8_t* d = dst;
+        int x = 0;
+        while(x < width){
+            if(d - dst > limit)
+                return literals(cur, ref, dst);
+            uint8_t v = cur[x] ^ (ref ? ref[x] : 0);
+            int n = 1;
+            if(v == 0){
+                while(x + n < width && n < 128 && (cur[x+n] ^ (ref ? ref[x+n] : 0)) == 0)
+                    n++;
+                *d++ = n - 1;
+                x += n;
+                continue;
+            }
+            while(x + n < width && n < MIRROR_REPEAT && (cur[x+n] ^ (ref ? ref[x+n] : 0)) == v)
+                n++;
+            if(n >= 3){
+                *d++ = 0xC0 | (n - 3);
+                *d++ = v;
+                x += n;
+                continue;
+            }
+
+            //Literal until a zero or a run of 3 starts
+            uint8_t* ctrl = d++;
+            n = 0;
+            while(x < width && n < MIRROR_LITERAL){
+                uint8_t a = cur[x] ^ (ref ? ref[x] : 0);
+                if(a == 0)
+                    break;
+                if(x + 2 < width && (cur[x+1] ^ (ref ? ref[x+1] : 0)) == a && (cur[x+2] ^ (ref ? ref[x+2] : 0)) == a)
+                    break;
+                *d++ = a;
+                x++;
+                n++;
+            }
+            *ctrl = 0x80 | (n - 1);
+        }
+        if(d - dst > limit)
+            return literals(cur, ref, dst);
+        return d - dst;
+    }
+
+    int literals(const uint8_t* cur, const uint8_t* ref, uint8_t* dst){
+        uint8_t* d = dst;
+        for(int x=0; x<width; x+=MIRROR_LITERAL){
+            int n = width - x < MIRROR_LITERAL ? width - x : MIRROR_LITERAL;
+            *d++ = 0x80 | (n - 1);
+            for(int i=0; i<n; i++)
+                *d++ = cur[x+i] ^ (ref ? ref[x+i] : 0);
+        }
+        return d - dst;
+    }
+
+    //Codes buf against what the viewer has into out[], returns the frame size (0 = no change)
+    int encode(const uint8_t* buf, uint16_t ms){
+        bool is_key = key_pending;
+        mask = 0;
+        int n = MIRROR_HEADER;
+        for(int p=0; p<pages; p++){
+            const uint8_t* cur = buf + p*width;
+            if(!is_key && memcmp(cur, prev + p*width, width) == 0)
+                continue;
+            mask |= 1 << p;
+            n += page(cur, is_key ? NULL : prev + p*width, out + n);
+        }
+        if(mask == 0)
+            return 0;
+
+        int len = n - MIRROR_HEADER;
+        out[0] = MIRROR_FRAME_START;
+        out[1] = (is_key ? MIRROR_KEY : 0) | (pages - 1) << 1;
+        out[2] = seq;
+        out[3] = width;
+        out[4] = mask;
+        out[5] = ms & 0xFF;
+        out[6] = ms >> 8;
+        out[7] = len & 0xFF;
+        out[8] = len >> 8;
+        uint8_t x = 0;
+        for(int i=1; i<n; i++)
+            x ^= out[i];
+        out[n++] = x;
+        return n;
+    }
+
+    //The frame in out[] went out: the viewer now has buf
+    void sent(const uint8_t* buf, int n){
+        for(int p=0; p<pages; p++)
+            if(mask >> p & 1){
+                memcpy(prev + p*width, buf + p*width, width);
+                raw += width;
+            }
+        if(out[1] & MIRROR_KEY)
+            keys++;
+        key_pending = false;
+        seq++;
+        frames++;
+        bytes += n;
+    }
+};
+
+#ifdef ARDUINO
+//On by default in the perf build (streams only after "mirror on")
+#ifndef MIRROR_MODE
+#define MIRROR_MODE PERF_MODE
+#endif
+
+#define MIRROR_TX_BUFFER 2048 //Serial TX buffer, a key frame has to fit
+
+struct Mirror{
+    MirrorEncoder enc;
+    bool on = false;
+    unsigned long last_key = 0;
+
+    Mirror(){}
+
+    void start(int width, int height){
+        enc.init(width, height);
+        on = true;
+    }
+
+    void stop(){
+        on = false;
+    }
+
+    //After a flush, sends the changes if the whole frame fits in the UART buffer
+    void frame(HardwareSerial &out, const uint8_t* buf){
+        if(!on)
+            return;
+        unsigned long now = millis();
+        if(now - last_key >= MIRROR_KEY_MS){
+            enc.key();
+            last_key = now;
+        }
+        int n = enc.encode(buf, now);
+        if(n == 0)
+            return;
+        if(out.availableForWrite() < n){
+            enc.deferred++;
+            return;
+        }
+        out.write(enc.out, n);
+        enc.sent(buf, n);
+    }
+};
+
+#if MIRROR_MODE
+Mirror mirror;
+#define MIRROR_FRAME(buf) mirror.frame(Serial, buf)
+#else
+#define MIRROR_FRAME(buf)
+#endif
+#endif
+
+#endif
@@ -6,26 +6,69 @@
 #include <SPI.h>
 #include <Wire.h>
 #include <Adafruit_GFX.h>
+#include <panel.h>
+#ifdef PANEL_SSD1306_128X32
+#include <Adafruit_SSD1306.h>
+#else
 #include <Adafruit_SH110X.h>
+#endif
 
 #include <faces.h>
+#include <blit.h>
+#include <text.h>
+#include <page_sync.h>
+#include <arm_motion.h>
+#include <assets.h>
+#include <perf.h>
+#include <stall.h>
+#include <latency.h>
+#include <trace.h>
+#include <energy.h>
+#include <mirror.h>
 #define rep(i, n) for(int i=0; i<n; i++)
 
 //SCREEN
 #define i2c_Address 0x3c //initialize with the I2C addr 0x3C Typically eBay OLED's
-#define SCREEN_WIDTH 128 // OLED display width, in pixels
-#define SCREEN_HEIGHT 64 // OLED display height, in pixels
+#define SCREEN_WIDTH (Panel::WIDTH) // OLED display width, in pixels (src/panel.h)
+#define SCREEN_HEIGHT (Panel::HEIGHT) // OLED display height, in pixels
 #define OLED_RESET -1   //   QT-PY / XIAO
+#define N_PAGES (SCREEN_HEIGHT/8)
+#define I2C_CHUNK 64 //Data bytes per I2C transaction (Wire buffer is 128)
+#define I2C_CLOCK 400000 //GFX drops back to 100 kHz after each of its own transfers
+#define SLIDE_STEP 8 //Rows per frame of a slide transition
+#define SLIDE_STEP_MS 15
+#define SH1106_CONTRAST 0x81 //Followed by the value, same on the SSD1306
+#define SH1106_DISPLAY_OFF 0xAE
+#define SH1106_DISPLAY_ON 0xAF
+#ifdef PANEL_SSD1306_128X32
+#define OLED_WHITE SSD1306_WHITE
+Adafruit_SSD1306 display = Adafruit_SSD1306(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+inline bool displayBegin(){
+    return display.begin(SSD1306_SWITCHCAPVCC, i2c_Address);
+}
+#else
+#define OLED_WHITE SH110X_WHITE
 Adafruit_SH1106G display = Adafruit_SH1106G(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+inline bool displayBegin(){
+    return display.begin(i2c_Address, true); // Address 0x3C default
+}
+#endif
 
 //Globals
 Servo pwm;
+AssetBundle assets; //Flash partition, built-in tables are the fallback
 #define MAX_ARDUINO_TIME 3294967295
 
 unsigned long get_time(){
     return (millis()%MAX_ARDUINO_TIME);
 }
 
+//delay() that the stall monitor reports as a deliberate pause
+void hold(unsigned long ms){
+    STALL_SECTION(STALL_SEC_WAIT);
+    delay(ms);
+}
+
 
 //Format from seconds to MM:SS
 String format_time(long seconds){
@@ -52,6 +95,10 @@ struct Speaker{
     int pin = 0;
     int channel = 0;
 
+    //Non blocking tone in progress (0 = none)
+    unsigned long tone_off = 0;
+    bool mute = false; //Power profile, beeps keep their timing
+
     Speaker(){}
 
     void init(int pin, int channel){
@@ -61,29 +108,64 @@ struct Speaker{
     }
 
     void beep(unsigned int frec, unsigned int dur){
+        PERF_SCOPE(PERF_BEEP);
+        TRACE_SCOPE(TRACE_BEEP, frec);
+        STALL_SECTION(STALL_SEC_BEEP);
+        tone_off = 0;
+        if(mute){
+            delay(dur); //Same timing, sequences depend on it
+            return;
+        }
+        ENERGY_BUZZER(dur);
         pwm.attach(pin, channel);
         pwm.tone(pin, frec, dur);
         delay(dur);
         pwm.detach(pin);
     }
 
+    //Starts a tone and returns, update() stops it
+    void play(unsigned int frec, unsigned int dur){
+        TRACE_INSTANT(TRACE_TONE, dur);
+        if(mute)
+            return;
+        ENERGY_BUZZER(dur);
+        pwm.attach(pin, channel);
+        pwm.tone(pin, frec, dur);
+        tone_off = max(get_time() + dur, 1UL);
+    }
+
+    bool playing(){
+        return tone_off != 0;
+    }
+
+    void update(){
+        if(tone_off == 0 || long(get_time() - tone_off) < 0)
+            return;
+        pwm.detach(pin);
+        tone_off = 0;
+    }
+
 
     void startupBeep(){
+        STALL_SECTION(STALL_SEC_BEEP);
         beep(700, 100);
         beep(900, 100);
     }
 
     void actionBeep(){
+        STALL_SECTION(STALL_SEC_BEEP);
         beep(700, 100);
     }
 
     void alarmBeep(){
+        STALL_SECTION(STALL_SEC_BEEP);
         beep(1000, 200);
         delay(100);
         beep(800, 300);
     }
 
     void successBeep(){
+        STALL_SECTION(STALL_SEC_BEEP);
         beep(700, 100);
         delay(50);
         beep(1000, 100);
@@ -92,6 +174,7 @@ struct Speaker{
     }
 
     void gamblingBeep(){
+        STALL_SECTION(STALL_SEC_BEEP);
         beep(700, 100);
         delay(50);
         beep(1000, 100);
@@ -99,6 +182,7 @@ struct Speaker{
     }
 
     void sadBeep(){
+        STALL_SECTION(STALL_SEC_BEEP);
         beep(1300, 100); 
         delay(50);
         beep(1000, 100); 
@@ -109,6 +193,7 @@ struct Speaker{
     }
 
     void celebrationBeep(){
+        STALL_SECTION(STALL_SEC_BEEP);
         beep(1000, 200);
         delay(300);
         beep(800, 300);
@@ -117,6 +202,7 @@ struct Speaker{
     }
 
     void angryBeep(){
+        STALL_SECTION(STALL_SEC_BEEP);
         beep(600, 100);
         delay(50);
         beep(800, 100);
@@ -126,23 +212,64 @@ struct Speaker{
 };
 
 
-struct Screen{
-    int centerX = 42;
-    int centerY = 26;
+//Controller command / data streams over I2C, for PageSync::flush()
+struct WireBus{
+    unsigned long bytes = 0;
+
+    void command(const uint8_t* cmd, int n){
+        Wire.beginTransmission(i2c_Address);
+        Wire.write(0x00); //Command stream
+        Wire.write(cmd, n);
+        Wire.endTransmission();
+        bytes += n + 1;
+    }
+
+    void data(const uint8_t* buf, int n){
+        for(int x=0; x<n; x+=I2C_CHUNK){
+            int len = min(I2C_CHUNK, n-x);
+            Wire.beginTransmission(i2c_Address);
+            Wire.write(0x40); //Data stream
+            Wire.write(buf + x, len);
+            Wire.endTransmission();
+            bytes += len + 1;
+        }
+    }
+};
+
+
+//Every position comes from PanelLayout<P, F> (src/panel.h), Screen is the one the build picked
+template<class P, class F>
+struct ScreenT{
+    typedef PanelLayout<P, F> L;
+    static constexpr int WIDTH = P::WIDTH;
+    static constexpr int HEIGHT = P::HEIGHT;
+    static constexpr int PAGES = P::PAGES;
+
     Speaker* spk;
+    Blitter blit;
+    Text text;
+
+    PageSync sync;
+    WireBus bus;
+    unsigned long flushed_bytes = 0; //Bytes sent by the last flushDirty()
+    uint16_t lit = 0; //Pixels on in the last frame, only counted for the energy model and the tracer
 
-    const int CHAR_WIDTH = SCREEN_WIDTH/20;
-    const int CHAR_HEIGHT = SCREEN_HEIGHT/8;
+    uint8_t back[WIDTH*PAGES]; //Outgoing frame of a transition
 
-    Screen(){}
+    ScreenT(){}
 
     void init(Speaker &spk){
         this->spk = &spk;
-        display.begin(i2c_Address, true); // Address 0x3C default
+        displayBegin();
+        Wire.setClock(I2C_CLOCK); //WireBus talks to the panel directly
+        P::setup(bus);
+        blit.init(display.getBuffer(), WIDTH, HEIGHT);
+        text.init(blit);
+        sync.init(display.getBuffer(), WIDTH, HEIGHT, P::RAM_HEIGHT, P::COL_OFFSET);
         display.clearDisplay();
-        display.display();
+        show();
         display.setTextSize(1);
-        display.setTextColor(SH110X_WHITE);
+        display.setTextColor(OLED_WHITE);
         display.setCursor(0,0);
         delay(500);
     }
@@ -151,7 +278,7 @@ struct Screen{
         display.setTextSize(1);
         display.setCursor(0, 0);
         printCentered(title, 1, false);
-        display.drawLine (0,10,128,10, SH110X_WHITE);  
+        display.drawLine(0, L::HEADER_RULE_Y, WIDTH, L::HEADER_RULE_Y, OLED_WHITE);
     }
 
     void moveCursor(int x=-1, int y=-1){
@@ -164,42 +291,49 @@ struct Screen{
         for(int i=0; i<=100; i+=20){
             display.clearDisplay();
             header("Cargando...");
-            display.setCursor(centerX-(String(i).length()*5)+15, centerY);
-            print(String(i), 2);
-            print("%", 2);
-            display.display();
+            printCentered(String(i) + "%", 2);
+            show();
 
             delay(800);
         }
 
         display.clearDisplay();
         printCentered("A . M . E");
-        display.display();
+        show();
         spk->startupBeep();
     }
 
-    //FIXME: Messages showing correctly (lenght)
+    //Prints at the GFX cursor with the pre-rendered font (sizes 1 and 2)
     void print(String message, int sz=1){
-        display.setTextSize(sz);
-        display.print(message);
+        int x = display.getCursorX();
+        int y = display.getCursorY();
+        int x0 = x, y0 = y;
+        text.draw(message.c_str(), x, y, sz);
+        display.setCursor(x, y);
+
+        sz = Text::size(sz);
+        if(y == y0)
+            markDirty(x0, y0, x-x0, 8*sz);
+        else
+            markDirty(0, y0, WIDTH, y-y0 + 8*sz);
     }
 
-    
-    void printCentered(String message, int sz=1, bool absolute=true){
-        int aux = max(0, int(message.length()-10));
-        if(absolute)
-            display.setCursor(max(0, int(centerX-(message.length()*2)+18-aux)), centerY);
-        else
-            display.setCursor(max(0, int(centerX-(message.length()*2)+18-aux)), display.getCursorY());
 
+    //Width in px of a message, UTF-8 aware
+    int textWidth(String message, int sz=1){
+        return Text::width(message.c_str(), sz);
+    }
+
+
+    void printCentered(String message, int sz=1, bool absolute=true){
+        int x = max(0, (WIDTH - textWidth(message, sz))/2);
+        display.setCursor(x, absolute ? L::CENTER_Y : display.getCursorY());
         print(message, sz);
     }
 
 
     void printCenteredNumber(int number, int sz=2){
-        display.setTextSize(sz);
-        display.setCursor(centerX-(String(number).length()*5)+20, centerY);
-        display.print(number);
+        printCentered(String(number), sz);
     }
 
 
@@ -207,7 +341,7 @@ struct Screen{
         display.clearDisplay();
         header(text);
         printCenteredNumber(number);
-        display.setCursor(0, 50);
+        display.setCursor(0, L::FOOTER_Y);
     }
 
 
@@ -216,25 +350,123 @@ struct Screen{
         display.clearDisplay();
         header(message);
 
-        if(screen_on){
-            display.setCursor(centerX-5, centerY);
-            print(format_time(seconds), 2);
-        }
+        if(screen_on)
+            printCentered(format_time(seconds), 2);
         
-        display.display();
+        show();
     }
 
 
+    //The bundle can bring more faces than the built-in ones. Faces are 128x64, a
+    //shorter panel shows their middle (the rows of the art from FACE_CROP)
     void showFace(int idx){
-        idx = constrain(idx, 0, N_FACES-1);
-        display.clearDisplay();
-        display.drawBitmap(0, 0, Faces[idx], 128, 64, SH110X_WHITE);
-        display.display();
+        idx = constrain(idx, 0, max(N_FACES, assets.count(ASSET_FACE))-1);
+        if(!assets.face(idx, display.getBuffer(), WIDTH*PAGES)){
+            idx = min(idx, N_FACES-1);
+            display.clearDisplay();
+            const uint8_t* band = Faces[idx] + L::FACE_CROP*L::FACE_W/8;
+            if(!blit.rowBitmap(0, L::FACE_VIS_Y, band, L::FACE_W, L::FACE_VIS_H, ROP_SET))
+                display.drawBitmap(0, L::FACE_Y, Faces[idx], L::FACE_W, L::FACE_H, OLED_WHITE);
+        }
+        show();
     }
 
 
+    //Whole frame, through flushDirty() so the start line is respected
     void show(){
-        display.display();
+        sync.markAll();
+        flushDirty();
+    }
+
+
+    //Hardware scroll: the frame moves d rows up (d < 0 = down) and only the
+    //rows that come in have to be drawn and sent
+    void scroll(int d){
+        blit.shiftRows(d);
+        sync.scrolled(d);
+    }
+
+
+    //Call before drawing the next frame, slide() then animates old -> new
+    void beginTransition(){
+        memcpy(back, display.getBuffer(), sizeof(back));
+    }
+
+
+    //New frame comes in from below (dir = 1) or from above (dir = -1)
+    void slide(int dir=1){
+        STALL_SECTION(STALL_SEC_SLIDE);
+        uint8_t* buf = display.getBuffer();
+        rep(i, int(sizeof(back))){
+            uint8_t aux = buf[i];
+            buf[i] = back[i];
+            back[i] = aux;
+        }
+
+        Sprite next = {WIDTH, HEIGHT, back, NULL};
+        for(int done=SLIDE_STEP; done<=HEIGHT; done+=SLIDE_STEP){
+            scroll(dir*SLIDE_STEP);
+            blit.sprite(next, 0, dir > 0 ? HEIGHT-done : done-HEIGHT, ROP_SET);
+            flushDirty();
+            delay(SLIDE_STEP_MS);
+        }
+    }
+
+
+    //Blitter shortcuts, they also mark the area for flushDirty()
+    void fill(int x, int y, int w, int h, int op=ROP_SET){
+        blit.fill(x, y, w, h, op);
+        markDirty(x, y, w, h);
+    }
+
+    void sprite(const Sprite &s, int x, int y, int op=ROP_SET){
+        blit.sprite(s, x, y, op);
+        markDirty(x, y, s.w, s.h);
+    }
+
+
+    //Remember that this rectangle changed since the last flushDirty()
+    void markDirty(int x, int y, int w, int h){
+        sync.markDirty(x, y, w, h);
+    }
+
+
+    //Panel settings, straight to the controller
+    void contrast(uint8_t value){
+        uint8_t cmd[2] = {SH1106_CONTRAST, value};
+        bus.command(cmd, 2);
+    }
+
+    void panel(bool on){
+        uint8_t cmd = on ? SH1106_DISPLAY_ON : SH1106_DISPLAY_OFF;
+        bus.command(&cmd, 1);
+    }
+
+
+    //Lit pixels of the whole buffer, panel current grows with them
+    uint16_t litPixels(){
+        const uint32_t* words = (const uint32_t*)display.getBuffer();
+        uint16_t n = 0;
+        rep(i, WIDTH*PAGES/4)
+            n += __builtin_popcount(words[i]);
+        return n;
+    }
+
+    //Flush only the touched spans of the touched pages
+    void flushDirty(){
+        PERF_SCOPE(PERF_FLUSH);
+        STALL_SECTION(STALL_SEC_FLUSH);
+        if(ENERGY_MODE || TRACE_MODE)
+            lit = litPixels();
+        TRACE_BEGIN(TRACE_FLUSH, lit);
+        bus.bytes = 0;
+        sync.flush(bus);
+        flushed_bytes = bus.bytes;
+        PERF_RECORD(PERF_FLUSH_BYTES, flushed_bytes);
+        TRACE_END(TRACE_FLUSH, flushed_bytes);
+        LAT_FLUSHED(flushed_bytes);
+        ENERGY_FLUSH(flushed_bytes, lit);
+        MIRROR_FRAME(display.getBuffer());
     }
 
 
@@ -244,6 +476,8 @@ struct Screen{
 
 };
 
+typedef ScreenT<Panel, Font5x7> Screen;
+
 
 struct Encoder{
     int swpin, swState;
@@ -257,6 +491,12 @@ struct Encoder{
     unsigned long last_check = 0;
     unsigned long time_now = 0;
     bool last_state = HIGH;
+    unsigned long pressed_at = 0; //micros() of the last press, before its beep
+    unsigned long last_input = 0; //millis() of the last press or turn
+
+    //Console input ("rotate", "click"), taken like the real thing
+    int injected_steps = 0;
+    bool injected_click = false;
 
     Encoder(){}
 
@@ -276,6 +516,15 @@ struct Encoder{
 
     //Is switch pressed?
     bool isPressed(){
+        if(injected_click){
+            injected_click = false;
+            TRACE_INSTANT(TRACE_CLICK, 0);
+            pressed_at = micros();
+            last_input = millis();
+            spk->actionBeep();
+            return true;
+        }
+
         time_now = get_time();
 
         if(time_now-last_check <= debounce)
@@ -285,6 +534,9 @@ struct Encoder{
         swState = digitalRead(swpin);
 
         if(swState == LOW && last_state == HIGH){
+            TRACE_INSTANT(TRACE_CLICK, 0);
+            pressed_at = micros();
+            last_input = millis();
             spk->actionBeep();
             last_state = LOW;
             return true;
@@ -297,10 +549,18 @@ struct Encoder{
     //-1 = left | 0 = still | 1 = right
     //Detect encoder rotation
     int getRotation(){
+        if(injected_steps != 0){
+            int step = injected_steps > 0 ? 1 : -1;
+            injected_steps -= step;
+            last_input = millis();
+            return step;
+        }
+
         if(!*encoderTurned) 
             return 0;
 
         *encoderTurned = false;
+        last_input = millis();
 
         if(*encoderDirection)
             return 1; //Derecha
@@ -316,8 +576,7 @@ struct Arm{
     int channel;
     bool ACTIVE_ARM = true;
 
-    #define RELAXED 103
-    #define POINTING 6
+    ArmMotion motion; //src/arm_motion.h
 
     Arm(){}
 
@@ -328,17 +587,55 @@ struct Arm{
         pwm.attach(pin, ch);
     }
 
+    void write(int deg){
+        if(deg == motion.commanded)
+            return;
+        pwm.write(pin, deg);
+        TRACE_INSTANT(TRACE_SERVO, deg);
+        motion.wrote(deg, get_time());
+    }
+
+    //Sets the target, the motion itself happens in update()
     void move(int pos, int speed=500){
         if(!ACTIVE_ARM)
             return;
-        int real = map(pos, 0, 100, RELAXED, POINTING);
-        pwm.write(pin, real, speed, 0.0);
+        if(!motion.aim(map(pos, 0, 100, RELAXED, POINTING), speed))
+            return;
+        TRACE_INSTANT(TRACE_ARM, motion.target);
+        ENERGY_SERVO_MOVE();
+
+        //Blocking sequences don't pump update(), just go there
+        if(motion.stale(get_time())){
+            motion.jump();
+            write(motion.target);
+        }
+    }
+
+    //Straight to rest, profile or not: the servo is about to stop taking targets
+    void park(){
+        motion.target = RELAXED;
+        motion.jump();
+        TRACE_INSTANT(TRACE_ARM, RELAXED);
+        write(RELAXED);
+    }
+
+    //Drawing motor current (battery load estimate)
+    bool moving(){
+        return motion.moving(get_time(), ACTIVE_ARM);
+    }
+
+    //Advance the trapezoidal profile, call every loop
+    void update(){
+        int deg = motion.update(get_time(), ACTIVE_ARM);
+        if(deg >= 0)
+            write(deg);
     }
 };
 
 
 struct Potentiometer{
     int pin;
+    int forced = -1; //0 - 100 from the console ("pot"), -1 = the knob
 
     #define MIN_POT_POS 0
     #define MAX_POT_POS 26
@@ -352,6 +649,10 @@ struct Potentiometer{
 
     //0 - 100
     int getReading(){
+        if(forced >= 0)
+            return forced;
+        PERF_SCOPE(PERF_ADC);
+        STALL_SECTION(STALL_SEC_ADC);
         int read = analogRead(pin);
         return map(read, 4095, 0, 0, 100);
     }
@@ -0,0 +1,166 @@
+#ifndef PAGE_SYNC_H
+#define PAGE_SYNC_H
+
+//Keeps the controller RAM in step with the page buffer: dirty spans per page and the
+//display start line used for hardware vertical scroll.
+//
+//Panel row y shows RAM row (start_line + y) % ram_height, so logical row L of the
+//page buffer lives in RAM row (L + start_line) % ram_height. Scrolling the frame by d
+//rows only moves start_line, the rows that stay on screen are already in RAM. RAM
+//rows no logical row maps to are off the glass (a 32 row panel on a 64 row RAM)
+//and get zeros.
+#include <stdint.h>
+#include <string.h>
+
+#define SH1106_COL_OFFSET 2 //SH1106 has 132 columns, the panel starts at 2
+#define SH1106_START_LINE 0x40 //| line (0-63), same commands on the SSD1306
+#define SH1106_PAGE 0xB0 //| page
+#define SH1106_COL_HIGH 0x10 //| col >> 4
+#define SH1106_COL_LOW 0x00 //| col & 0xF
+#define SYNC_MAX_PAGES 8
+#define SYNC_MAX_WIDTH 132
+
+struct PageSync{
+    const uint8_t* buf = NULL;
+    int width = 0;
+    int pages = 0;
+    int ram_pages = 0;
+    int col_offset = SH1106_COL_OFFSET;
+
+    //Dirty columns per logical page (x1 > x2 = clean)
+    int16_t dirty_x1[SYNC_MAX_PAGES];
+    int16_t dirty_x2[SYNC_MAX_PAGES];
+
+    uint8_t start_line = 0;
+    bool start_pending = false;
+
+    PageSync(){}
+
+    //ram_height 0 = same as the panel
+    void init(const uint8_t* buf, int width, int height, int ram_height=0, int col_offset=SH1106_COL_OFFSET){
+        this->buf = buf;
+        this->width = width;
+        this->col_offset = col_offset;
+        pages = height/8;
+        ram_pages = ram_height > 0 ? ram_height/8 : pages;
+        clean();
+    }
+
+    void clean(){
+        for(int p=0; p<SYNC_MAX_PAGES; p++){
+            dirty_x1[p] = width;
+            dirty_x2[p] = -1;
+        }
+    }
+
+    void markDirty(int x, int y, int w, int h){
+        int x1 = x > 0 ? x : 0;
+        int x2 = x+w-1 < width-1 ? x+w-1 : width-1;
+        int y1 = y > 0 ? y : 0;
+        int y2 = y+h-1 < pages*8-1 ? y+h-1 : pages*8-1;
+        if(x1 > x2 || y1 > y2)
+            return;
+
+        for(int p=y1/8; p<=y2/8; p++){
+            if(x1 < dirty_x1[p]) dirty_x1[p] = x1;
+            if(x2 > dirty_x2[p]) dirty_x2[p] = x2;
+        }
+    }
+
+    void markAll(){
+        markDirty(0, 0, width, pages*8);
+    }
+
+    //The buffer was shifted d rows (d > 0 = up), see Blitter::shiftRows()
+    void scrolled(int d){
+        int h = pages*8;
+        int ram_h = ram_pages*8;
+        if(d == 0)
+            return;
+
+        //Pending marks move with the rows they cover
+        int16_t x1[SYNC_MAX_PAGES], x2[SYNC_MAX_PAGES];
+        memcpy(x1, dirty_x1, sizeof(x1));
+        memcpy(x2, dirty_x2, sizeof(x2));
+        clean();
+        for(int p=0; p<pages; p++)
+            if(x1[p] <= x2[p])
+                markDirty(x1[p], p*8 - d, x2[p] - x1[p] + 1, 8);
+
+        //Rows that came in
+        if(d > 0)
+            markDirty(0, h - d, width, d);
+        else
+            markDirty(0, 0, width, -d);
+
+        start_line = ((start_line + d) % ram_h + ram_h) % ram_h;
+        start_pending = true;
+    }
+
+    //Logical page stored from RAM page P on, NULL if it is off the glass
+    const uint8_t* logical(int P){
+        int q = start_line >> 3;
+        int p = ((P - q) % ram_pages + ram_pages) % ram_pages;
+        return p < pages ? buf + p*width : NULL;
+    }
+
+    //What RAM page P must hold, columns x1..x2
+    void ramPage(int P, int x1, int x2, uint8_t* out){
+        int t = start_line & 7;
+        const uint8_t* a = logical(P);
+        const uint8_t* b = logical(P - 1);
+        for(int x=x1; x<=x2; x++){
+            uint8_t lo = a ? a[x] << t : 0;
+            uint8_t hi = b && t ? b[x] >> (8 - t) : 0;
+            out[x - x1] = lo | hi;
+        }
+    }
+
+    //Sends the start line and the dirty spans through bus.command() / bus.data()
+    template<class Bus>
+    void flush(Bus &bus){
+        if(start_pending){
+            uint8_t cmd = SH1106_START_LINE | start_line;
+            bus.command(&cmd, 1);
+            start_pending = false;
+        }
+
+        //Logical pages -> RAM pages (a logical page straddles two when not aligned)
+        int q = start_line >> 3;
+        int t = start_line & 7;
+        int16_t x1[SYNC_MAX_PAGES], x2[SYNC_MAX_PAGES];
+        for(int P=0; P<ram_pages; P++){
+            x1[P] = width;
+            x2[P] = -1;
+        }
+        for(int p=0; p<pages; p++){
+            if(dirty_x1[p] > dirty_x2[p])
+                continue;
+            for(int k=0; k<=(t ? 1 : 0); k++){
+                int P = (p + q + k) % ram_pages;
+                if(dirty_x1[p] < x1[P]) x1[P] = dirty_x1[p];
+                if(dirty_x2[p] > x2[P]) x2[P] = dirty_x2[p];
+            }
+        }
+        clean();
+
+        uint8_t row[SYNC_MAX_WIDTH];
+        for(int P=0; P<ram_pages; P++){
+            if(x1[P] > x2[P])
+                continue;
+            uint8_t col = x1[P] + col_offset;
+            uint8_t cmd[3] = {uint8_t(SH1106_PAGE | P), uint8_t(SH1106_COL_HIGH | (col >> 4)), uint8_t(SH1106_COL_LOW | (col & 0x0F))};
+            bus.command(cmd, 3);
+
+            int n = x2[P] - x1[P] + 1;
+            if(t == 0 && logical(P) != NULL)
+                bus.data(logical(P) + x1[P], n);
+            else{
+                ramPage(P, x1[P], x2[P], row);
+                bus.data(row, n);
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef PANEL_H
+#define PANEL_H
+
+//Panel geometry and screen layout, all compile time. A panel trait says how big the
+//glass is and how its controller RAM maps to it, PanelLayout turns that and the font
+//metrics into every position the UI draws at. The build picks one panel:
+//  default                  SH1106 128x64
+//  -DPANEL_SSD1306_128X32   SSD1306 128x32 (env ttgo-t-oi-plus-ssd1306)
+//
+//Positions keep the 128x64 numbers on the SH1106. On 32 rows the UI is the same
+//code with the rows scaled: lists show the ROW_N rows that fit above the status
+//row. LayoutCheck below fails the build if anything lands off the glass.
+//
+//Plain C++, tools/panel_emu.cpp checks both panels on the PC.
+#include <stdint.h>
+#include <font.h>
+
+//Controller commands both panels share
+#define OLED_PAGE_ADDRESSING 0x20 //Followed by 0x02, SSD1306 only (SH1106 only has page mode)
+#define OLED_PAGE_MODE 0x02
+
+//SH1106: 132 column RAM, the glass starts at column 2, page addressing only
+struct PanelSH1106{
+    static constexpr int WIDTH = 128;
+    static constexpr int HEIGHT = 64;
+    static constexpr int PAGES = HEIGHT/8;
+    static constexpr int RAM_WIDTH = 132;
+    static constexpr int RAM_HEIGHT = 64;
+    static constexpr int COL_OFFSET = 2;
+
+    //After the driver's own init, before the first PageSync::flush()
+    template<class Bus>
+    static void setup(Bus &bus){
+        (void)bus;
+    }
+};
+
+//SSD1306 wired for 32 rows: the RAM still has 64, the start line wraps over all of
+//them and the glass shows 32 from there. Adafruit leaves it in horizontal
+//addressing, PageSync talks page addressing
+struct PanelSSD1306_128x32{
+    static constexpr int WIDTH = 128;
+    static constexpr int HEIGHT = 32;
+    static constexpr int PAGES = HEIGHT/8;
+    static constexpr int RAM_WIDTH = 128;
+    static constexpr int RAM_HEIGHT = 64;
+    static constexpr int COL_OFFSET = 0;
+
+    template<class Bus>
+    static void setup(Bus &bus){
+        uint8_t cmd[2] = {OLED_PAGE_ADDRESSING, OLED_PAGE_MODE};
+        bus.command(cmd, 2);
+    }
+};
+
+//src/font.h
+struct Font5x7{
+    static constexpr int ADVANCE = FONT_ADVANCE;
+    static constexpr int HEIGHT = 8;
+};
+
+#ifdef PANEL_SSD1306_128X32
+typedef PanelSSD1306_128x32 Panel;
+#else
+typedef PanelSH1106 Panel;
+#endif
+
+template<class P, class F>
+struct PanelLayout{
+    static constexpr int W = P::WIDTH;
+    static constexpr int H = P::HEIGHT;
+
+    //Title on row 0, a rule under it
+    static constexpr int HEADER_RULE_Y = F::HEIGHT + 2;
+
+    //Big centered line, and the lines printed under it
+    static constexpr int CENTER_X = W*21/64;
+    static constexpr int CENTER_Y = H*13/32;
+    static constexpr int CENTER_NEXT_Y = CENTER_Y + H*5/32;
+    static constexpr int CENTER_FAR_Y = CENTER_Y + H*5/16;
+
+    //Hint line at the bottom ("Click = continuar")
+    static constexpr int FOOTER_Y = H*25/32 < H - F::HEIGHT ? H*25/32 : H - F::HEIGHT;
+
+    //List of text lines under the header
+    static constexpr int ROW_Y0 = HEADER_RULE_Y + H*3/32;
+    static constexpr int ROW_H = H*3/16 > F::HEIGHT ? H*3/16 : F::HEIGHT + 1;
+
+    //Status line under three rows, or the last text line when that does not fit
+    static constexpr int STATUS_Y = ROW_Y0 + 3*ROW_H + 2 + F::HEIGHT <= H ? ROW_Y0 + 3*ROW_H + 2 : H - F::HEIGHT;
+    static constexpr int ROW_N = (STATUS_Y - ROW_Y0 - F::HEIGHT)/ROW_H + 1; //Rows above it
+
+    //Menu: option lines, "-> " marker and the "more below" arrow (stem + head)
+    static constexpr int MENU_LINE_H = H/4;
+    static constexpr int MENU_TEXT_X = 3*F::ADVANCE;
+    static constexpr int ARROW_X = W - 18;
+    static constexpr int ARROW_W = 18;
+    static constexpr int ARROW_HEAD_Y = H - 8;
+    static constexpr int ARROW_HEAD_H = 7;
+    static constexpr int ARROW_STEM_X = W - 13;
+    static constexpr int ARROW_STEM_W = 8;
+    static constexpr int ARROW_STEM_H = H/4;
+    static constexpr int ARROW_STEM_Y = ARROW_HEAD_Y - ARROW_STEM_H;
+
+    //The 128x64 face art, centered: a short panel shows the eye band. FACE_Y is where
+    //the art starts (above the glass on a short panel), FACE_CROP art rows are cut off
+    //the top and FACE_VIS_H rows from FACE_VIS_Y are on the glass
+    static constexpr int FACE_W = 128;
+    static constexpr int FACE_H = 64;
+    static constexpr int FACE_Y = (H - FACE_H)/2;
+    static constexpr int FACE_CROP = FACE_Y < 0 ? -FACE_Y : 0;
+    static constexpr int FACE_VIS_Y = FACE_Y < 0 ? 0 : FACE_Y;
+    static constexpr int FACE_VIS_H = FACE_H - 2*FACE_CROP;
+};
+
+//Every row and column the UI draws at is on the glass, checked for both panels
+template<class P, class F>
+struct LayoutCheck{
+    typedef PanelLayout<P, F> L;
+
+    static constexpr bool rows(int y, int h){
+        return y >= 0 && y + h <= L::H;
+    }
+
+    static constexpr bool cols(int x, int w){
+        return x >= 0 && x + w <= L::W;
+    }
+
+    static_assert(rows(L::HEADER_RULE_Y, 1), "header rule off the panel");
+    static_assert(rows(L::CENTER_Y, 2*F::HEIGHT), "centered line off the panel");
+    static_assert(rows(L::CENTER_NEXT_Y, F::HEIGHT) && rows(L::CENTER_FAR_Y, F::HEIGHT), "lines under the centered one off the panel");
+    static_assert(rows(L::FOOTER_Y, F::HEIGHT), "footer off the panel");
+    static_assert(rows(L::ROW_Y0, F::HEIGHT) && L::ROW_N >= 1, "no list row fits");
+    static_assert(L::ROW_Y0 + (L::ROW_N-1)*L::ROW_H + F::HEIGHT <= L::STATUS_Y, "list rows run into the status row");
+    static_assert(rows(L::STATUS_Y, F::HEIGHT) && L::STATUS_Y > L::HEADER_RULE_Y, "status row off the panel");
+    static_assert(rows(3*L::MENU_LINE_H, F::HEIGHT) && cols(L::MENU_TEXT_X, F::ADVANCE), "menu lines off the panel");
+    static_assert(rows(L::ARROW_STEM_Y, L::ARROW_STEM_H + L::ARROW_HEAD_H) && cols(L::ARROW_X, L::ARROW_W) &&
+        cols(L::ARROW_STEM_X, L::ARROW_STEM_W), "menu arrow off the panel");
+    static_assert(rows(L::FACE_VIS_Y, L::FACE_VIS_H) && cols(0, L::FACE_W), "face off the panel");
+    static_assert(L::FACE_VIS_H == (L::FACE_H < L::H ? L::FACE_H : L::H), "face band does not fill the panel");
+};
+
+static_assert(sizeof(LayoutCheck<PanelSH1106, Font5x7>) > 0, "SH1106 layout");
+static_assert(sizeof(LayoutCheck<PanelSSD1306_128x32, Font5x7>) > 0, "SSD1306 layout");
+
+typedef PanelLayout<Panel, Font5x7> Layout;
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef PERF_H
+#define PERF_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+//Runtime counters and histograms, dumped with the "perf" console command.
+//Build with -DPERF_MODE=1 (env ttgo-t-oi-plus-perf), otherwise every PERF_ macro is empty.
+//Off the bot (host tools) only the ids are there and the macros are empty.
+#ifndef PERF_MODE
+#define PERF_MODE 0
+#endif
+
+//Stats
+#define PERF_LOOP 0          //us between loop() starts
+#define PERF_MODE_IDLE 1     //us in each mode's run()
+#define PERF_MODE_TIMER 2
+#define PERF_MODE_PONG 3
+#define PERF_MODE_GAMBLING 4
+#define PERF_MODE_BDAY 5
+#define PERF_MODE_OTHER 6    //Power off, low battery
+#define PERF_FLUSH 7         //us per flushDirty()
+#define PERF_FLUSH_BYTES 8   //I2C bytes per flushDirty()
+#define PERF_BEEP 9          //us blocked in Speaker::beep()
+#define PERF_ADC 10          //us per ADC read
+#define PERF_PONG_BYTES 11   //I2C bytes per Pong frame (partial redraw)
+#define PERF_N_STATS 12
+
+const char* const PERF_NAMES[PERF_N_STATS] = {
+    "loop_us", "idle_us", "timer_us", "pong_us", "gambling_us", "bday_us",
+    "other_us", "flush_us", "flush_bytes", "beep_us", "adc_us",
+    "pong_bytes"
+};
+
+#define PERF_BUCKETS 16 //Bucket i counts values in [2^i, 2^(i+1)), the last one also everything above
+
+struct PerfStat{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[PERF_BUCKETS];
+
+    void reset(){
+        memset(this, 0, sizeof(*this));
+        min = 0xFFFFFFFF;
+    }
+
+    void add(uint32_t v){
+        count++;
+        sum += v;
+        if(v < min) min = v;
+        if(v > max) max = v;
+        int b = v ? 31 - __builtin_clz(v) : 0;
+        hist[b < PERF_BUCKETS ? b : PERF_BUCKETS-1]++;
+    }
+};
+
+#ifdef ARDUINO
+struct Perf{
+    PerfStat stats[PERF_N_STATS];
+    unsigned long last_tick = 0;
+    unsigned long since = 0;
+
+    Perf(){
+        reset();
+    }
+
+    void reset(){
+        for(int i=0; i<PERF_N_STATS; i++)
+            stats[i].reset();
+        last_tick = 0;
+        since = millis();
+    }
+
+    void record(int id, uint32_t v){
+        stats[id].add(v);
+    }
+
+    //Time since the previous tick() of the same stat (one stat uses it: PERF_LOOP)
+    void tick(int id){
+        unsigned long now = micros();
+        if(last_tick != 0)
+            record(id, now - last_tick);
+        last_tick = now;
+    }
+
+    //One line per stat: name count avg min max | histogram buckets (trailing zeros cut)
+    void dump(Print &out){
+        out.print("perf ");
+        out.print((millis() - since)/1000);
+        out.print("s heap_free ");
+        out.print(ESP.getFreeHeap());
+        out.print(" heap_min ");
+        out.println(ESP.getMinFreeHeap());
+
+        for(int i=0; i<PERF_N_STATS; i++){
+            PerfStat &s = stats[i];
+            if(s.count == 0)
+                continue;
+            out.print(PERF_NAMES[i]);
+            out.print(' ');
+            out.print(s.count);
+            out.print(' ');
+            out.print(uint32_t(s.sum/s.count));
+            out.print(' ');
+            out.print(s.min);
+            out.print(' ');
+            out.print(s.max);
+            out.print(" |");
+
+            int last = PERF_BUCKETS-1;
+            while(last > 0 && s.hist[last] == 0)
+                last--;
+            for(int b=0; b<=last; b++){
+                out.print(' ');
+                out.print(s.hist[b]);
+            }
+            out.println();
+        }
+    }
+};
+#endif
+
+#if PERF_MODE && defined(ARDUINO)
+Perf perf;
+
+struct PerfScope{
+    int id;
+    unsigned long start;
+
+    PerfScope(int id): id(id), start(micros()){}
+
+    ~PerfScope(){
+        perf.record(id, micros() - start);
+    }
+};
+
+#define PERF_CAT2(a, b) a##b
+#define PERF_CAT(a, b) PERF_CAT2(a, b)
+#define PERF_SCOPE(id) PerfScope PERF_CAT(perf_scope_, __LINE__)(id)
+#define PERF_RECORD(id, v) perf.record(id, v)
+#define PERF_TICK(id) perf.tick(id)
+#else
+#define PERF_SCOPE(id)
+#define PERF_RECORD(id, v)
+#define PERF_TICK(id)
+#endif
+
+#endif
@@ -0,0 +1,368 @@
+#ifndef PONG_H
+#define PONG_H
+
+//Pong core (plain C++, no Arduino calls so it also runs on the host)
+#include <stdint.h>
+
+//Fixed point Q8.8, stored in 32 bits so the whole screen fits
+typedef int32_t fixed;
+#define FP_SHIFT 8
+#define FP_ONE (1 << FP_SHIFT)
+#define TO_FP(x) ((fixed)(x) * FP_ONE)
+#define FROM_FP(x) ((int)((x) >> FP_SHIFT))
+
+//The simulation always advances in steps of PONG_STEP_MS,
+//rendering happens whenever loop() gets around to it
+#define PONG_STEP_MS 20
+#define PONG_MAX_STEPS 8 //Catch up limit after a long stall
+
+//Speeds are in px per second, one difficulty level = PONG_SPEED_UNIT
+#define PONG_SPEED_UNIT 20
+#define PX_PER_STEP(px_s) ((fixed)(px_s) * FP_ONE * PONG_STEP_MS / 1000)
+
+//Step events
+#define PONG_HIT_PADDLE 1
+#define PONG_HIT_WALL 2
+#define PONG_LEFT_SCORES 4
+#define PONG_RIGHT_SCORES 8
+
+//Collisions
+#define PONG_MAX_CONTACTS 6 //Per step, more than enough even at silly speeds
+#define PONG_MAX_SLOPE 5 //|vy| <= ball_speed*5/4 at the paddle tips
+#define PONG_MIN_SLOPE_DIV 4 //|vy| >= ball_speed/4 so rallies never go flat
+
+//CPU difficulty table, one row per level, from tools/pong_calibrate.cpp at the paddle
+//and ball speed set_difficulty gives each level (bot win rate against the default
+//player, 2000 matches, seed 1: 1%, 5%, 57%, 87%, 89%, 100%). The aim error decides most of it,
+//reaction and speed only bind once the ball is fast, so the upper levels aim better
+//but react later to keep the curve from jumping straight to 100%
+struct PongAILevel{
+    uint8_t reaction_steps; //Steps before it reacts to a new volley
+    uint8_t error_px;       //Max aim error on the intercept
+    uint8_t speed;          //Paddle speed in px per second
+};
+
+const PongAILevel PONG_AI_LEVELS[] = {
+    {12, 8, 40},
+    {10, 7, 60},
+    {8, 6, 80},
+    {16, 5, 30},
+    {24, 5, 60},
+    {4, 4, 130}
+};
+
+const int PONG_N_LEVELS = sizeof(PONG_AI_LEVELS)/sizeof(PONG_AI_LEVELS[0]);
+
+//Tiny deterministic RNG (xorshift32), same sequence on the bot and on the host
+inline uint32_t pong_rand(uint32_t &state){
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+inline fixed fp_abs(fixed v){
+    return v < 0 ? -v : v;
+}
+
+inline fixed fp_clamp(fixed v, fixed lo, fixed hi){
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+//a + (b-a)*t, t in Q8.8 [0, 1]
+inline fixed fp_lerp(fixed a, fixed b, fixed t){
+    return a + (fixed)(((int64_t)(b - a) * t) >> FP_SHIFT);
+}
+
+//==========================================================
+
+struct PongBall{
+    fixed x = 0, y = 0;
+    fixed vx = 0, vy = 0; //Per step
+};
+
+
+struct PongPhysics{
+    int width = 128;
+    int height = 64;
+
+    //Paddles (top position)
+    int paddle_high = 18;
+    int paddle_width = 3;
+    fixed l_pos = 0;
+    fixed r_pos = 0;
+
+    //Ball, prev is the state before the last step (for interpolation)
+    PongBall ball, prev;
+    int ball_radius = 3;
+    fixed ball_speed = PX_PER_STEP(4*PONG_SPEED_UNIT);
+
+    //CPU, the plan is made once per volley
+    int cpu_speed = 3;
+    PongAILevel ai = PONG_AI_LEVELS[3];
+    fixed cpu_step = PX_PER_STEP(100);
+    fixed cpu_target = 0;
+    int cpu_wait = 0;
+
+    uint32_t rng = 1;
+
+    PongPhysics(){}
+
+    void init(int width, int height, uint32_t seed){
+        this->width = width;
+        this->height = height;
+        rng = seed ? seed : 1;
+    }
+
+    //Difficulty formula (paddle size, ball & cpu speed)
+    void set_difficulty(int cpu_speed){
+        this->cpu_speed = cpu_speed;
+        paddle_high = cpu_speed < 18 ? 20 - cpu_speed : 2;
+        ball_speed = PX_PER_STEP((1 + cpu_speed)*PONG_SPEED_UNIT);
+
+        ai = PONG_AI_LEVELS[cpu_speed < 0 ? 0 : (cpu_speed >= PONG_N_LEVELS ? PONG_N_LEVELS-1 : cpu_speed)];
+        cpu_step = PX_PER_STEP(ai.speed);
+    }
+
+    fixed max_paddle(){
+        return TO_FP(height - paddle_high);
+    }
+
+    void start(){
+        ball.x = TO_FP(40);
+        ball.y = TO_FP(26);
+        ball.vx = ball_speed;
+        ball.vy = ball_speed;
+        prev = ball;
+
+        l_pos = TO_FP(height/2);
+        r_pos = TO_FP(height/2);
+        plan_cpu();
+    }
+
+    //Left paddle comes from the player, in pixels
+    void set_left(int pos){
+        l_pos = fp_clamp(TO_FP(pos), 0, max_paddle());
+    }
+
+    //If left is true, then ball should launch from the left, otherwise launch from the right
+    //Ball should launch at a random Y location and at a random Y velocity
+    void ball_reset(bool left){
+        ball.y = top() + TO_FP(pong_rand(rng) % (height - 2*ball_radius));
+        ball.vy = (pong_rand(rng) & 1) ? ball_speed : -ball_speed;
+
+        if(left){
+            ball.vx = fp_abs(ball.vx);
+            ball.x = TO_FP(paddle_width-1);
+        }
+        else{
+            ball.vx = -fp_abs(ball.vx);
+            ball.x = TO_FP(width-paddle_width);
+        }
+        prev = ball; //No interpolation across a serve
+    }
+
+    //Where will the ball cross the face at x? Wall bounces are folded analytically
+    fixed intercept_y(fixed face){
+        int64_t steps_fp = ((int64_t)(face - ball.x) << FP_SHIFT) / ball.vx;
+        int64_t y = ball.y - top() + ((ball.vy * steps_fp) >> FP_SHIFT);
+
+        int64_t span = bottom() - top();
+        int64_t u = y % (2*span);
+        if(u < 0)
+            u += 2*span;
+        return top() + (fixed)(u <= span ? u : 2*span - u);
+    }
+
+    //Called when a volley starts (serve or bounce), never per step
+    void plan_cpu(){
+        cpu_wait = ai.reaction_steps;
+
+        if(ball.vx <= 0){
+            //Ball going away, drift back to the middle
+            cpu_target = TO_FP(height - paddle_high)/2;
+            return;
+        }
+
+        int error = (int)(pong_rand(rng) % (2*ai.error_px + 1)) - ai.error_px;
+        cpu_target = fp_clamp(intercept_y(right_face()) - TO_FP(paddle_high)/2 + TO_FP(error), 0, max_paddle());
+    }
+
+    void move_cpu(){
+        if(cpu_wait > 0){
+            cpu_wait--;
+            return;
+        }
+
+        if(r_pos < cpu_target)
+            r_pos = r_pos + cpu_step < cpu_target ? r_pos + cpu_step : cpu_target;
+        else if(r_pos > cpu_target)
+            r_pos = r_pos - cpu_step > cpu_target ? r_pos - cpu_step : cpu_target;
+    }
+
+    //Ball center limits
+    fixed top(){ return TO_FP(ball_radius); }
+    fixed bottom(){ return TO_FP(height-1-ball_radius); }
+    fixed left_face(){ return TO_FP(paddle_width + ball_radius); }
+    fixed right_face(){ return TO_FP(width-1-paddle_width-ball_radius); }
+
+    //Does a ball at y touch a paddle whose top is at pos?
+    bool on_paddle(fixed y, fixed pos){
+        return y >= pos - TO_FP(ball_radius) && y <= pos + TO_FP(paddle_high + ball_radius);
+    }
+
+    //Time (Q16 fraction of a step) until the ball covers dist at speed v
+    static int32_t time_to(fixed dist, fixed v){
+        return (int32_t)(((int64_t)dist << 16) / v);
+    }
+
+    //Bounce angle depends on where the ball hits the paddle
+    void bounce_from(fixed pos){
+        fixed half = TO_FP(paddle_high + 2*ball_radius)/2;
+        fixed offset = ball.y - (pos + TO_FP(paddle_high)/2);
+        fixed rel = fp_clamp((fixed)(((int64_t)offset << FP_SHIFT) / half), -FP_ONE, FP_ONE);
+
+        fixed vy = (fixed)(((int64_t)ball_speed * rel * PONG_MAX_SLOPE) >> (2*FP_SHIFT));
+        fixed min_vy = ball_speed/PONG_MIN_SLOPE_DIV;
+        if(fp_abs(vy) < min_vy)
+            vy = (vy < 0 || (vy == 0 && ball.vy < 0)) ? -min_vy : min_vy;
+
+        ball.vx = -ball.vx;
+        ball.vy = vy;
+    }
+
+    //Swept move: finds the exact time of every wall/paddle contact inside the step
+    uint8_t sweep(){
+        uint8_t events = 0;
+        int32_t rem = 1L << 16;
+
+        for(int contact=0; contact<PONG_MAX_CONTACTS; contact++){
+            int32_t t = rem;
+            int what = 0; //1 = wall, 2 = left face, 3 = right face
+
+            //Walls
+            if(ball.vy > 0 && ball.y <= bottom()){
+                int32_t tw = time_to(bottom() - ball.y, ball.vy);
+                if(tw <= t){ t = tw; what = 1; }
+            }
+            else if(ball.vy < 0 && ball.y >= top()){
+                int32_t tw = time_to(top() - ball.y, ball.vy);
+                if(tw <= t){ t = tw; what = 1; }
+            }
+
+            //Paddle faces (only when reaching them from the field side)
+            if(ball.vx < 0 && ball.x >= left_face()){
+                int32_t tp = time_to(left_face() - ball.x, ball.vx);
+                if(tp <= t){ t = tp; what = 2; }
+            }
+            else if(ball.vx > 0 && ball.x <= right_face()){
+                int32_t tp = time_to(right_face() - ball.x, ball.vx);
+                if(tp <= t){ t = tp; what = 3; }
+            }
+
+            ball.x += (fixed)(((int64_t)ball.vx * t) >> 16);
+            ball.y += (fixed)(((int64_t)ball.vy * t) >> 16);
+            rem -= t;
+
+            if(what == 1){
+                ball.y = ball.vy > 0 ? bottom() : top();
+                ball.vy = -ball.vy;
+                events |= PONG_HIT_WALL;
+            }
+            else if(what == 2){
+                ball.x = left_face();
+                if(on_paddle(ball.y, l_pos)){
+                    bounce_from(l_pos);
+                    events |= PONG_HIT_PADDLE;
+                }
+                else
+                    ball.x -= 1; //Missed, keep going past the face
+            }
+            else if(what == 3){
+                ball.x = right_face();
+                if(on_paddle(ball.y, r_pos)){
+                    bounce_from(r_pos);
+                    events |= PONG_HIT_PADDLE;
+                }
+                else
+                    ball.x += 1;
+            }
+            else
+                break;
+
+            if(rem <= 0)
+                break;
+        }
+
+        ball.y = fp_clamp(ball.y, top(), bottom());
+        return events;
+    }
+
+    //One fixed simulation step, returns PONG_* events
+    uint8_t step(){
+        prev = ball;
+
+        move_cpu();
+        uint8_t events = sweep();
+
+        //Out on the sides?
+        if(ball.x > TO_FP(width-1)){
+            ball_reset(false);
+            events |= PONG_LEFT_SCORES;
+        }
+        else if(ball.x < 0){
+            ball_reset(true);
+            events |= PONG_RIGHT_SCORES;
+        }
+
+        //New volley, new plan
+        if(events & (PONG_HIT_PADDLE | PONG_LEFT_SCORES | PONG_RIGHT_SCORES))
+            plan_cpu();
+        return events;
+    }
+
+    //Interpolated ball position for rendering, t in Q8.8
+    int render_x(fixed t){
+        return FROM_FP(fp_lerp(prev.x, ball.x, t) + FP_ONE/2);
+    }
+
+    int render_y(fixed t){
+        return FROM_FP(fp_lerp(prev.y, ball.y, t) + FP_ONE/2);
+    }
+};
+
+
+//Fixed timestep accumulator
+struct PongClock{
+    unsigned long last = 0;
+    unsigned long acc = 0;
+
+    PongClock(){}
+
+    void reset(unsigned long now){
+        last = now;
+        acc = 0;
+    }
+
+    //How many steps are due since the last call
+    int advance(unsigned long now){
+        acc += now - last;
+        last = now;
+
+        unsigned long steps = acc / PONG_STEP_MS;
+        if(steps > PONG_MAX_STEPS){
+            //Too far behind, drop the rest instead of spiraling
+            acc = 0;
+            return PONG_MAX_STEPS;
+        }
+        acc -= steps*PONG_STEP_MS;
+        return (int)steps;
+    }
+
+    //How far we are into the next step (Q8.8)
+    fixed alpha(){
+        return (fixed)((acc << FP_SHIFT) / PONG_STEP_MS);
+    }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef PONG_RENDER_H
+#define PONG_RENDER_H
+
+//Pong renderer: erases last frame's sprites and redraws only what changed, marking
+//the touched rectangles on the PageSync. The caller flushes.
+//Plain C++, tools/pong_bytes.cpp counts the bytes it sends per frame on the PC.
+#include <stdio.h>
+#include <blit.h>
+#include <text.h>
+#include <page_sync.h>
+
+struct Rect{
+    int x, y, w, h;
+
+    bool operator==(const Rect &o) const {
+        return x == o.x && y == o.y && w == o.w && h == o.h;
+    }
+
+    bool overlaps(const Rect &o) const {
+        return x < o.x+o.w && o.x < x+w && y < o.y+o.h && o.y < y+h;
+    }
+};
+
+#define N_SPRITES 5 //Ball, paddles, scores
+
+struct PongRenderer{
+    Blitter* blit = NULL;
+    Text* text = NULL;
+    PageSync* sync = NULL;
+
+    Rect last[N_SPRITES];
+    int last_score[2] = {-1, -1};
+    bool fresh = true;
+
+    PongRenderer(){}
+
+    void init(Blitter &blit, Text &text, PageSync &sync){
+        this->blit = &blit;
+        this->text = &text;
+        this->sync = &sync;
+        fresh = true;
+    }
+
+    //Next frame is drawn from scratch
+    void reset(){
+        fresh = true;
+    }
+
+    static void scoreText(int score, char* out, int n){
+        snprintf(out, n, "%d", score);
+    }
+
+    Rect scoreRect(int x, int score){
+        char s[8];
+        scoreText(score, s, sizeof(s));
+        return {x, 0, Text::width(s), 8};
+    }
+
+    void fill(const Rect &r, int op){
+        blit->fill(r.x, r.y, r.w, r.h, op);
+        sync->markDirty(r.x, r.y, r.w, r.h);
+    }
+
+    void drawSprite(int i, const Rect &r, int score){
+        if(i == 0){
+            blit->sprite(BALL_SPRITE, r.x, r.y, ROP_SET);
+            sync->markDirty(r.x, r.y, r.w, r.h);
+        }
+        else if(i <= 2)
+            fill(r, ROP_SET);
+        else{
+            char s[8];
+            scoreText(score, s, sizeof(s));
+            int x = r.x, y = r.y;
+            text->draw(s, x, y);
+            sync->markDirty(r.x, r.y, x - r.x, 8);
+        }
+    }
+
+    void draw(int bx, int by, int l_pos, int r_pos, int paddle_width, int paddle_high, int l_score, int r_score){
+        int width = blit->width, height = blit->pages*8;
+        int score[2] = {l_score, r_score};
+        Rect now[N_SPRITES] = {
+            {bx-3, by-3, 7, 7},
+            {0, l_pos, paddle_width, paddle_high},
+            {width-paddle_width, r_pos, paddle_width, paddle_high},
+            scoreRect(width/4, l_score),
+            scoreRect(width*3/4, r_score)
+        };
+
+        bool redraw[N_SPRITES];
+        if(fresh){
+            memset(blit->buf, 0, width*blit->pages);
+            sync->markDirty(0, 0, width, height);
+            for(int i=0; i<N_SPRITES; i++)
+                redraw[i] = true;
+            fresh = false;
+        }
+        else{
+            //Erase whatever moved or changed
+            for(int i=0; i<N_SPRITES; i++){
+                redraw[i] = !(now[i] == last[i]) || (i >= 3 && score[i-3] != last_score[i-3]);
+                if(redraw[i])
+                    fill(last[i], ROP_CLEAR);
+            }
+
+            //Anything under an erased rectangle has to come back too
+            for(int i=0; i<N_SPRITES; i++){
+                if(!redraw[i])
+                    continue;
+                for(int j=0; j<N_SPRITES; j++)
+                    if(j != i && !redraw[j] && last[i].overlaps(now[j]))
+                        redraw[j] = true;
+            }
+        }
+
+        for(int i=0; i<N_SPRITES; i++){
+            if(redraw[i])
+                drawSprite(i, now[i], i >= 3 ? score[i-3] : 0);
+            last[i] = now[i];
+        }
+        last_score[0] = l_score;
+        last_score[1] = r_score;
+    }
+};
+
+#endif
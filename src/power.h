@@ -0,0 +1,182 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+#include <objects.h>
+
+//Power governor: one profile at a time sets the CPU clock, the loop period, the panel
+//contrast (or turns it off), the servo and the buzzer. main.cpp picks the profile from
+//the mode, the battery and how long nobody touched the bot. "power" on the serial
+//console shows the time spent in each profile and its estimated current.
+
+//Profiles
+#define PWR_GAME 0  //Pong
+#define PWR_UI 1    //Menus, timer, gambling, birthday
+#define PWR_IDLE 2  //Idle face, nobody around
+#define PWR_SAVER 3 //Low battery
+#define PWR_OFF 4   //"APAGAR"
+#define PWR_N_PROFILES 5
+
+#define PWR_IDLE_AFTER_MS 15000 //Without input before PWR_IDLE
+#define PWR_IDLE_AFTER_BATTERY_MS 5000
+#define PWR_ANIM_FRAME_MS 33 //Longest frame while the face morphs or blinks (30 fps), any profile
+
+//Rough current figures (mA) for the estimate, ESP32-C3 datasheet and bench numbers
+#define PWR_MA_CPU_160 27   //CPU busy or waiting, radio off
+#define PWR_MA_CPU_80 19
+#define PWR_MA_PANEL 2      //Panel on, charge pump
+#define PWR_MA_PANEL_FULL 10 //Lit pixels of a typical frame at contrast 255
+#define PWR_MA_SERVO 6      //Servo powered and holding
+
+struct PowerProfile{
+    const char* name;
+    uint16_t cpu_mhz; //80 or 160, below 80 the APB clock (LEDC, I2C, timers) changes too
+    uint16_t frame_ms; //Minimum loop() period
+    uint8_t contrast; //0 = panel off
+    bool servo;
+    bool sound;
+};
+
+const PowerProfile PWR_PROFILES[PWR_N_PROFILES] = {
+    {"game", 160, 20, 0xCF, true, true},
+    {"ui", 80, 20, 0xCF, true, true},
+    {"idle", 80, 50, 0x60, true, true},
+    {"saver", 80, 50, 0x20, false, true}, //Sound on: the low battery warnings are its only beeps
+    {"off", 80, 200, 0, false, true} //The wake up click still beeps
+};
+
+struct Power{
+    Screen* screen;
+    Arm* arm;
+    Speaker* spk;
+
+    int profile = -1;
+    bool battery = false; //Running from the battery: the servo stays off whatever the profile
+    unsigned long since = 0; //Current profile start
+    unsigned long last_frame = 0;
+    unsigned long residency[PWR_N_PROFILES]; //ms, closed periods only
+    unsigned long switches = 0;
+    bool animating = false; //Set by the mode for this frame only
+
+    Power(){}
+
+    void init(Screen &screen, Arm &arm, Speaker &spk){
+        this->screen = &screen;
+        this->arm = &arm;
+        this->spk = &spk;
+        reset();
+    }
+
+    void reset(){
+        rep(i, PWR_N_PROFILES)
+            residency[i] = 0;
+        since = millis();
+        switches = 0;
+    }
+
+    static int estimateMa(int p){
+        const PowerProfile &pp = PWR_PROFILES[p];
+        int ma = pp.cpu_mhz > 80 ? PWR_MA_CPU_160 : PWR_MA_CPU_80;
+        if(pp.contrast > 0)
+            ma += PWR_MA_PANEL + PWR_MA_PANEL_FULL*pp.contrast/255;
+        if(pp.servo)
+            ma += PWR_MA_SERVO;
+        return ma;
+    }
+
+    void apply(int p, bool on_battery){
+        if(on_battery != battery){
+            battery = on_battery;
+            servo(PWR_PROFILES[p].servo && !battery);
+            if(p == profile)
+                traceState();
+        }
+        if(p == profile)
+            return;
+        unsigned long now = millis();
+        if(profile >= 0)
+            residency[profile] += now - since;
+        since = now;
+        switches++;
+
+        const PowerProfile &next = PWR_PROFILES[p];
+        const PowerProfile* prev = profile >= 0 ? &PWR_PROFILES[profile] : NULL;
+        profile = p;
+
+        if(prev == NULL || prev->cpu_mhz != next.cpu_mhz){
+            setCpuFrequencyMhz(next.cpu_mhz);
+            TRACE_SYNC_NOW(); //Cycles per us changed
+        }
+        if(prev == NULL || prev->contrast != next.contrast){
+            screen->panel(next.contrast > 0);
+            if(next.contrast > 0)
+                screen->contrast(next.contrast);
+        }
+        servo(next.servo && !battery);
+        spk->mute = !next.sound;
+        traceState();
+    }
+
+    //Nobody pumps update() once the arm is off (low battery, power off), so it
+    //parks first instead of being left wherever the last move was going
+    void servo(bool on){
+        if(arm->ACTIVE_ARM && !on)
+            arm->park();
+        arm->ACTIVE_ARM = on;
+    }
+
+    //What the energy replay needs to know, see TRACE_POWER
+    void traceState(){
+        TRACE_INSTANT(TRACE_POWER, profile | arm->ACTIVE_ARM << 3 | spk->mute << 4 | PWR_PROFILES[profile].contrast << 8);
+    }
+
+    //End of loop(): sleeps what is left of the frame
+    void pace(){
+        STALL_IDLE();
+        unsigned long frame = profile >= 0 ? PWR_PROFILES[profile].frame_ms : 20;
+        if(animating && frame > PWR_ANIM_FRAME_MS)
+            frame = PWR_ANIM_FRAME_MS; //The idle profile still sleeps 50 ms while the face is still
+        animating = false;
+        unsigned long elapsed = millis() - last_frame;
+        unsigned long sleep = elapsed < frame ? frame - elapsed : 0;
+        TRACE_INSTANT(TRACE_PACE, sleep);
+        if(profile >= 0 && last_frame != 0)
+            ENERGY_FRAME(elapsed, sleep, PWR_PROFILES[profile].cpu_mhz, PWR_PROFILES[profile].contrast, arm->ACTIVE_ARM, arm->moving());
+        if(sleep > 0)
+            delay(sleep);
+        last_frame = millis();
+    }
+
+    //profile seconds % mA, then the time weighted average
+    void dump(Print &out){
+        unsigned long now = millis();
+        unsigned long total = now - since;
+        rep(i, PWR_N_PROFILES)
+            total += residency[i];
+
+        float avg = 0;
+        rep(i, PWR_N_PROFILES){
+            unsigned long ms = residency[i] + (i == profile ? now - since : 0);
+            float share = total ? float(ms)/total : 0;
+            avg += share*estimateMa(i);
+            out.print(i == profile ? "* " : "  ");
+            out.print(PWR_PROFILES[i].name);
+            out.print(' ');
+            out.print(ms/1000);
+            out.print("s ");
+            out.print(int(share*100 + 0.5));
+            out.print("% ");
+            out.print(estimateMa(i));
+            out.println("mA");
+        }
+        out.print("avg ");
+        out.print(avg, 1);
+        out.print("mA, ");
+        out.print(switches);
+        out.print(" switches, cpu ");
+        out.print(getCpuFrequencyMhz());
+        out.println("MHz");
+    }
+};
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef SCRIPT_H
+#define SCRIPT_H
+
+//Command language of the serial console: one command per line (or separated by ';'),
+//"name args...". Bytes go into a ring as they arrive and poll() parses a few of them
+//per loop, running at most one command, so a pasted script never holds up a frame.
+//"wait <ms>" pauses the script: what follows stays in the ring until it is due.
+//
+//  rotate 3; wait 200; click        a scripted walk through the menu
+//  mode pong; pot 80; wait 5000; bench flush
+//
+//Plain C++, the bot reads it from Serial (src/console.h) and tools/mirror_sim.cpp
+//from a script file or its pseudo terminal.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCRIPT_RING 256          //Bytes waiting, a short pasted script fits
+#define SCRIPT_LINE 64
+#define SCRIPT_MAX_COMMANDS 24
+#define SCRIPT_BYTES_PER_POLL 32 //Parsed per loop at most
+
+//What poll() did
+#define SCRIPT_IDLE 0    //Nothing complete yet (or waiting)
+#define SCRIPT_RAN 1
+#define SCRIPT_UNKNOWN 2 //line holds the name
+#define SCRIPT_HELP 3
+#define SCRIPT_TOO_LONG 4
+
+typedef void (*ScriptFn)(const char* args);
+
+struct ScriptCommand{
+    const char* name;
+    const char* help;
+    ScriptFn fn;
+};
+
+struct ScriptReader{
+    ScriptCommand commands[SCRIPT_MAX_COMMANDS];
+    int n_commands = 0;
+
+    char ring[SCRIPT_RING];
+    uint16_t head = 0;
+    uint16_t tail = 0;
+    uint32_t dropped = 0; //Bytes that found the ring full
+
+    char line[SCRIPT_LINE];
+    int len = 0;
+    bool overflow = false;
+
+    bool waiting = false;
+    unsigned long wait_until = 0;
+    uint32_t ran = 0;
+
+    ScriptReader(){}
+
+    bool add(const char* name, const char* help, ScriptFn fn){
+        if(n_commands >= SCRIPT_MAX_COMMANDS)
+            return false;
+        commands[n_commands++] = {name, help, fn};
+        return true;
+    }
+
+    int room(){
+        return SCRIPT_RING - uint16_t(head - tail);
+    }
+
+    //Producer side: bytes that arrived
+    void push(char c){
+        if(room() == 0){
+            dropped++;
+            return;
+        }
+        ring[head % SCRIPT_RING] = c;
+        head++;
+    }
+
+    void push(const char* s, int n){
+        for(int i=0; i<n; i++)
+            push(s[i]);
+    }
+
+    //Stops a running wait and throws away what is queued
+    void cancel(){
+        tail = head;
+        len = 0;
+        overflow = false;
+        waiting = false;
+    }
+
+    //Consumer side, every loop
+    int poll(unsigned long now){
+        if(waiting){
+            if(long(now - wait_until) < 0)
+                return SCRIPT_IDLE;
+            waiting = false;
+        }
+
+        for(int k=0; k<SCRIPT_BYTES_PER_POLL && tail != head; k++){
+            char c = ring[tail % SCRIPT_RING];
+            tail++;
+            if(c == '\r')
+                continue;
+            if(c != '\n' && c != ';'){
+                if(len < SCRIPT_LINE-1)
+                    line[len++] = c;
+                else
+                    overflow = true;
+                continue;
+            }
+
+            line[len] = 0;
+            bool too_long = overflow;
+            len = 0;
+            overflow = false;
+            if(too_long)
+                return SCRIPT_TOO_LONG;
+            int status = exec(line, now);
+            if(status != SCRIPT_IDLE)
+                return status;
+        }
+        return SCRIPT_IDLE;
+    }
+
+    //"name args...", IDLE for an empty command
+    int exec(char* cmd, unsigned long now){
+        while(*cmd == ' ')
+            cmd++;
+        char* args = cmd;
+        while(*args != 0 && *args != ' ')
+            args++;
+        if(*args != 0)
+            *args++ = 0;
+        while(*args == ' ')
+            args++;
+        for(char* e = args + strlen(args); e > args && e[-1] == ' '; )
+            *--e = 0;
+
+        if(*cmd == 0)
+            return SCRIPT_IDLE;
+        if(strcmp(cmd, "help") == 0)
+            return SCRIPT_HELP;
+        if(strcmp(cmd, "wait") == 0){
+            waiting = true;
+            wait_until = now + strtoul(args, NULL, 10);
+            ran++;
+            return SCRIPT_RAN;
+        }
+        for(int i=0; i<n_commands; i++){
+            if(strcmp(cmd, commands[i].name) == 0){
+                commands[i].fn(args);
+                ran++;
+                return SCRIPT_RAN;
+            }
+        }
+        if(cmd != line)
+            memmove(line, cmd, strlen(cmd) + 1);
+        return SCRIPT_UNKNOWN;
+    }
+};
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+//User settings that survive a reboot: Pong difficulty and rounds, the gambling choices
+//and the last timer preset. One blob under one NVS key, read once at boot. The modes
+//edit SettingsStore::data and call changed(); the write happens SETTINGS_DELAY_MS after
+//the last change (a burst of encoder steps is one write) and at most once every
+//SETTINGS_MIN_INTERVAL_MS, unless save() forces it (power off, low battery).
+//
+//Layout: SettingsData, little endian. Fields are only ever appended: an older, shorter
+//blob keeps the defaults for what it lacks, a newer one is read up to what this build
+//knows. Bump SETTINGS_VERSION when a field changes meaning and convert it in migrate().
+//
+//Plain C++, on the PC the blob lives in a file (tools/settings_sim.cpp).
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <assets.h> //asset_crc32()
+#include <pong.h> //PONG_N_LEVELS
+#ifdef ARDUINO
+#include <Preferences.h>
+#endif
+
+#define SETTINGS_VERSION 1
+#define SETTINGS_NAMESPACE "ame"
+#define SETTINGS_KEY "cfg"
+#define SETTINGS_MAX_BYTES 64 //Biggest blob a future build may write
+#define SETTINGS_DELAY_MS 5000
+#define SETTINGS_MIN_INTERVAL_MS 60000 //Failed writes are retried at this pace too
+
+//Ranges the menus allow, a loaded blob is clamped to them
+#define SETTINGS_MAX_ROUNDS 20
+#define SETTINGS_MAX_CHOICES 99
+#define SETTINGS_MAX_TIMER 10800 //3 hours
+
+//How begin() went
+#define SETTINGS_LOADED 0
+#define SETTINGS_DEFAULTS 1 //Nothing stored yet
+#define SETTINGS_MIGRATED 2 //Other version or size, saved again on the next write
+#define SETTINGS_CORRUPT 3  //Bad CRC or header, defaults
+
+const char* const SETTINGS_LOAD_NAMES[] = {"loaded", "defaults", "migrated", "corrupt"};
+
+struct SettingsData{
+    uint16_t version;
+    uint16_t size;        //Bytes written, header included
+    uint32_t crc;         //Everything after this field
+    uint32_t writes;      //Wear counter, every save of this blob
+    int16_t pong_level;   //PongLevel index
+    int16_t pong_rounds;
+    int16_t gamble_choices;
+    int16_t timer_preset; //s
+};
+
+#define SETTINGS_BODY offsetof(SettingsData, writes)
+#define SETTINGS_VALUES offsetof(SettingsData, pong_level)
+
+inline void settings_defaults(SettingsData &s){
+    memset(&s, 0, sizeof(s));
+    s.version = SETTINGS_VERSION;
+    s.size = sizeof(SettingsData);
+    s.pong_level = 3;
+    s.pong_rounds = 3;
+    s.gamble_choices = 2;
+    s.timer_preset = 0;
+}
+
+inline int16_t settings_clamp(int16_t v, int16_t lo, int16_t hi){
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+//A blob from another build (or a bad one with a good CRC) can't put the menus out of range
+inline void settings_sanitize(SettingsData &s){
+    s.pong_level = settings_clamp(s.pong_level, 0, PONG_N_LEVELS-1);
+    s.pong_rounds = settings_clamp(s.pong_rounds, 1, SETTINGS_MAX_ROUNDS);
+    s.gamble_choices = settings_clamp(s.gamble_choices, 2, SETTINGS_MAX_CHOICES);
+    s.timer_preset = settings_clamp(s.timer_preset, 0, SETTINGS_MAX_TIMER);
+}
+
+inline uint32_t settings_crc(const uint8_t* blob, uint32_t size){
+    return asset_crc32(blob + SETTINGS_BODY, size - SETTINGS_BODY);
+}
+
+#ifdef ARDUINO
+//NVS through Preferences, it already spreads the writes over its pages
+struct SettingsBackend{
+    Preferences prefs;
+
+    size_t read(uint8_t* buf, size_t cap){
+        if(!prefs.begin(SETTINGS_NAMESPACE, true))
+            return 0;
+        size_t n = prefs.getBytesLength(SETTINGS_KEY);
+        n = n <= cap ? prefs.getBytes(SETTINGS_KEY, buf, cap) : 0;
+        prefs.end();
+        return n;
+    }
+
+    bool write(const uint8_t* buf, size_t n){
+        if(!prefs.begin(SETTINGS_NAMESPACE, false))
+            return false;
+        bool ok = prefs.putBytes(SETTINGS_KEY, buf, n) == n;
+        prefs.end();
+        return ok;
+    }
+};
+#else
+//Whole file = the blob
+struct SettingsBackend{
+    const char* path = "settings.bin";
+
+    size_t read(uint8_t* buf, size_t cap){
+        FILE* f = fopen(path, "rb");
+        if(f == NULL)
+            return 0;
+        size_t n = fread(buf, 1, cap, f);
+        if(fgetc(f) != EOF)
+            n = 0; //Bigger than any blob
+        fclose(f);
+        return n;
+    }
+
+    bool write(const uint8_t* buf, size_t n){
+        FILE* f = fopen(path, "wb");
+        if(f == NULL)
+            return false;
+        bool ok = fwrite(buf, 1, n, f) == n;
+        return fclose(f) == 0 && ok;
+    }
+};
+#endif
+
+struct SettingsStore{
+    SettingsData data;   //Live values
+    SettingsData stored; //What the flash holds
+    SettingsBackend backend;
+    int status = SETTINGS_DEFAULTS;
+    bool dirty = false;
+    unsigned long changed_at = 0;
+    unsigned long saved_at = 0;
+    bool saved_once = false;
+    uint32_t saves = 0;     //This boot
+    uint32_t coalesced = 0; //Changes that joined a pending write
+    uint32_t failed = 0;
+
+    SettingsStore(){
+        settings_defaults(data);
+        stored = data;
+    }
+
+    //Older versions -> this one, nothing to convert yet
+    static void migrate(SettingsData &s, int from){
+        (void)s;
+        (void)from;
+    }
+
+    static int decode(const uint8_t* blob, size_t n, SettingsData &out){
+        settings_defaults(out);
+        if(n == 0)
+            return SETTINGS_DEFAULTS;
+        SettingsData head;
+        if(n < SETTINGS_VALUES)
+            return SETTINGS_CORRUPT;
+        memcpy(&head, blob, SETTINGS_VALUES);
+        if(head.size != n || head.version == 0 || settings_crc(blob, n) != head.crc)
+            return SETTINGS_CORRUPT;
+
+        memcpy(&out, blob, n < sizeof(out) ? n : sizeof(out));
+        if(head.version == SETTINGS_VERSION && n == sizeof(out)){
+            settings_sanitize(out);
+            return SETTINGS_LOADED;
+        }
+        if(head.version < SETTINGS_VERSION)
+            migrate(out, head.version);
+        settings_sanitize(out);
+        out.version = SETTINGS_VERSION;
+        out.size = sizeof(out);
+        return SETTINGS_MIGRATED;
+    }
+
+    //One read for everything
+    void begin(){
+        uint8_t blob[SETTINGS_MAX_BYTES];
+        size_t n = backend.read(blob, sizeof(blob));
+        status = decode(blob, n, data);
+        stored = data;
+        if(status == SETTINGS_MIGRATED)
+            stored.version = 0; //Differs, the next save writes the new layout
+    }
+
+    //Call after editing data
+    void changed(unsigned long now){
+        if(dirty)
+            coalesced++;
+        dirty = true;
+        changed_at = now;
+    }
+
+    //Every loop, writes once the changes settle
+    void update(unsigned long now){
+        if(!dirty || now - changed_at < SETTINGS_DELAY_MS)
+            return;
+        if(saved_once && now - saved_at < SETTINGS_MIN_INTERVAL_MS)
+            return;
+        save(now);
+    }
+
+    //Writes now if anything differs from the flash. A failed write leaves it dirty:
+    //update() tries again, the wear counter only counts blobs that made it
+    void save(unsigned long now){
+        if(stored.version == data.version &&
+           memcmp((const uint8_t*)&stored + SETTINGS_VALUES, (const uint8_t*)&data + SETTINGS_VALUES,
+                  sizeof(data) - SETTINGS_VALUES) == 0){
+            dirty = false;
+            return;
+        }
+
+        SettingsData next = data;
+        next.writes++;
+        next.crc = settings_crc((const uint8_t*)&next, sizeof(next));
+        saved_at = now; //Last attempt, paces the retries
+        saved_once = true;
+        if(!backend.write((const uint8_t*)&next, sizeof(next))){
+            failed++;
+            dirty = true;
+            return;
+        }
+        data.writes = next.writes;
+        data.crc = next.crc;
+        stored = data;
+        dirty = false;
+        saves++;
+    }
+
+    void reset(unsigned long now){
+        uint32_t writes = data.writes;
+        settings_defaults(data);
+        data.writes = writes;
+        save(now);
+    }
+};
+
+#endif
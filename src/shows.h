@@ -0,0 +1,152 @@
+#ifndef SHOWS_H
+#define SHOWS_H
+
+//Keyframe scripts of the bot and the track stepping of the Timeline (plain C++, no
+//Arduino calls so tools/timeline_check.cpp can play them on the PC)
+#include <stddef.h>
+#include <stdint.h>
+#include <face_ids.h>
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
+//Keyframe ops
+#define KF_END 0   //at = length of the script
+#define KF_FACE 1  //a = face idx
+#define KF_ARM 2   //a = arm position (0-100)
+#define KF_TONE 3  //a = frequency, b = duration
+#define KF_TEXT 4  //ptr = centered message
+#define KF_PLAY 5  //ptr = script to start on its own track
+#define KF_SONG 6  //Starts the birthday melody
+
+//One step of a script, scripts are const tables (they stay in flash)
+struct Keyframe{
+    uint16_t at; //ms from the start of the script
+    uint8_t op;
+    int16_t a;
+    int16_t b;
+    const void* ptr;
+};
+
+#define MAX_TRACKS 6
+
+struct Track{
+    const Keyframe* script = NULL;
+    uint8_t next = 0;
+    unsigned long start = 0;
+};
+
+//Runs every keyframe that is due on this track at now, player.exec() does the work
+template<class Player>
+void run_track(Track &t, unsigned long now, Player &player){
+    unsigned long elapsed = now - t.start;
+    while(t.script != NULL && t.script[t.next].at <= elapsed){
+        const Keyframe &k = t.script[t.next];
+        if(k.op == KF_END){
+            t.script = NULL;
+            return;
+        }
+        t.next++;
+        player.exec(k);
+    }
+}
+
+//==========================================================
+//Sound patterns (the same notes the blocking Speaker beeps play)
+const Keyframe SND_SUCCESS[] PROGMEM = {
+    {0, KF_TONE, 700, 100, NULL},
+    {150, KF_TONE, 1000, 100, NULL},
+    {300, KF_TONE, 1300, 100, NULL},
+    {400, KF_END, 0, 0, NULL}
+};
+
+const Keyframe SND_GAMBLING[] PROGMEM = {
+    {0, KF_TONE, 700, 100, NULL},
+    {150, KF_TONE, 1000, 100, NULL},
+    {450, KF_END, 0, 0, NULL}
+};
+
+const Keyframe SND_SAD[] PROGMEM = {
+    {0, KF_TONE, 1300, 100, NULL},
+    {150, KF_TONE, 1000, 100, NULL},
+    {300, KF_TONE, 700, 100, NULL},
+    {450, KF_TONE, 500, 200, NULL},
+    {650, KF_END, 0, 0, NULL}
+};
+
+const Keyframe SND_CELEBRATION[] PROGMEM = {
+    {0, KF_TONE, 1000, 200, NULL},
+    {500, KF_TONE, 800, 300, NULL},
+    {1100, KF_TONE, 600, 300, NULL},
+    {1400, KF_END, 0, 0, NULL}
+};
+
+const Keyframe SND_ANGRY[] PROGMEM = {
+    {0, KF_TONE, 600, 100, NULL},
+    {150, KF_TONE, 800, 100, NULL},
+    {450, KF_END, 0, 0, NULL}
+};
+
+//==========================================================
+//Pong ending shows
+const Keyframe BOT_WINS[] PROGMEM = {
+    {0, KF_FACE, FACE_HAPPY, 0, NULL},
+    {0, KF_PLAY, 0, 0, SND_CELEBRATION},
+    {1400, KF_ARM, 100, 0, NULL},
+    {1400, KF_PLAY, 0, 0, SND_CELEBRATION},
+    {2800, KF_ARM, 0, 0, NULL},
+    {2800, KF_FACE, FACE_LOOK_LEFT, 0, NULL},
+    {2800, KF_PLAY, 0, 0, SND_SUCCESS},
+    {3200, KF_ARM, 100, 0, NULL},
+    {3200, KF_FACE, FACE_LOOK_RIGHT, 0, NULL},
+    {3200, KF_PLAY, 0, 0, SND_SUCCESS},
+    {3600, KF_ARM, 0, 0, NULL},
+    {3600, KF_TEXT, 0, 0, "TE GANEEE!"},
+    {6100, KF_END, 0, 0, NULL}
+};
+
+const Keyframe BOT_LOSES[] PROGMEM = {
+    {0, KF_FACE, FACE_ANGRY, 0, NULL},
+    {0, KF_PLAY, 0, 0, SND_ANGRY},
+    {450, KF_ARM, 100, 0, NULL},
+    {450, KF_PLAY, 0, 0, SND_ANGRY},
+    {900, KF_ARM, 0, 0, NULL},
+    {900, KF_PLAY, 0, 0, SND_ANGRY},
+    {1350, KF_ARM, 100, 0, NULL},
+    {1350, KF_FACE, FACE_SAD, 0, NULL},
+    {1600, KF_ARM, 0, 0, NULL},
+    {1600, KF_PLAY, 0, 0, SND_SAD},
+    {2250, KF_TEXT, 0, 0, "HAS GANADO!"},
+    {4750, KF_END, 0, 0, NULL}
+};
+
+//Gambling
+const Keyframe GAMBLING_ROLL[] PROGMEM = {
+    {0, KF_FACE, FACE_IDLE, 0, NULL},
+    {0, KF_PLAY, 0, 0, SND_GAMBLING},
+    {450, KF_FACE, FACE_LOOK_RIGHT, 0, NULL},
+    {450, KF_PLAY, 0, 0, SND_GAMBLING},
+    {900, KF_FACE, FACE_LOOK_LEFT, 0, NULL},
+    {900, KF_PLAY, 0, 0, SND_GAMBLING},
+    {1350, KF_FACE, FACE_HAPPY, 0, NULL},
+    {1350, KF_PLAY, 0, 0, SND_SUCCESS},
+    {1750, KF_END, 0, 0, NULL}
+};
+
+//Birthday
+const Keyframe BDAY_INTRO[] PROGMEM = {
+    {0, KF_TEXT, 0, 0, "Feliz cumple :D"},
+    {0, KF_SONG, 0, 0, NULL},
+    {0, KF_END, 0, 0, NULL}
+};
+
+const Keyframe BDAY_OUTRO[] PROGMEM = {
+    {0, KF_FACE, FACE_HAPPY, 0, NULL},
+    {1500, KF_TEXT, 0, 0, "Con cariño"},
+    {1500, KF_PLAY, 0, 0, SND_SUCCESS},
+    {2800, KF_TEXT, 0, 0, "By Mati :)"},
+    {3800, KF_END, 0, 0, NULL}
+};
+
+#endif
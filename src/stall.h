@@ -0,0 +1,214 @@
+#ifndef STALL_H
+#define STALL_H
+
+#include <Arduino.h>
+
+//Loop stall monitor. A hardware timer looks every STALL_TICK_MS at how long the current
+//loop() iteration has been running, so a busy-wait that never returns is caught too.
+//Past the budget it notes the mode and the innermost tagged section (STALL_SECTION),
+//and the worst offenders are kept in a table ("stall" on the serial console).
+//On by default in the perf build, otherwise every STALL_ macro is empty.
+#ifndef STALL_MODE
+#define STALL_MODE PERF_MODE
+#endif
+
+#define STALL_BUDGET_MS 100 //Default, "stall budget <ms>" changes it
+#define STALL_TICK_MS 10
+#define STALL_HANG_MS 3000  //Printed from the ISR, the loop may never come back
+#define STALL_TIMER 0
+#define STALL_SLOTS 12
+
+//Sections
+#define STALL_SEC_NONE 0     //Untagged code
+#define STALL_SEC_BEEP 1     //Blocking beeps and their sequences
+#define STALL_SEC_FLUSH 2    //Page buffer -> panel
+#define STALL_SEC_SLIDE 3    //Screen transition
+#define STALL_SEC_WAIT 4     //Deliberate pauses (hold())
+#define STALL_SEC_ADC 5
+#define STALL_SEC_TIMELINE 6
+#define STALL_SEC_CONSOLE 7
+#define STALL_N_SECTIONS 8
+
+const char* const STALL_SECTION_NAMES[STALL_N_SECTIONS] = {
+    "none", "beep", "flush", "slide", "wait", "adc", "timeline", "console"
+};
+
+//PERF_MODE_* numbering
+const char* const STALL_MODE_NAMES[] = {"?", "idle", "timer", "pong", "gambling", "bday", "other"};
+#define STALL_N_MODES 7
+
+struct StallEntry{
+    uint8_t mode;
+    uint8_t section;
+    uint16_t count;
+    uint32_t max_ms;
+    uint32_t total_ms;
+};
+
+struct StallMonitor{
+    //Shared with the timer ISR
+    volatile uint32_t loop_start = 0;
+    volatile uint8_t mode = 0;
+    volatile uint8_t section = STALL_SEC_NONE;
+    volatile bool armed = false;
+    volatile bool stalled = false;
+    volatile bool hang_reported = false;
+    volatile uint8_t stall_mode = 0;
+    volatile uint8_t stall_section = STALL_SEC_NONE;
+    volatile uint32_t budget_ms = STALL_BUDGET_MS;
+    uint32_t work_end = 0;
+
+    StallEntry table[STALL_SLOTS];
+    int used = 0;
+    uint32_t stalls = 0;
+    uint32_t loops = 0;
+
+    StallMonitor(){}
+
+    void reset(){
+        used = 0;
+        stalls = 0;
+        loops = 0;
+    }
+
+    //Timer ISR, nothing but volatile reads and writes
+    void IRAM_ATTR check(uint32_t now){
+        if(!armed)
+            return;
+        uint32_t age = now - loop_start;
+        if(!stalled && age > budget_ms){
+            stall_mode = mode;
+            stall_section = section;
+            stalled = true;
+        }
+        if(stalled && !hang_reported && age > STALL_HANG_MS){
+            hang_reported = true;
+            ets_printf("stall: loop stuck %u ms in %s/%s\n", (unsigned)age,
+                stall_mode < STALL_N_MODES ? STALL_MODE_NAMES[stall_mode] : "?",
+                STALL_SECTION_NAMES[stall_section]);
+        }
+    }
+
+    //Same (mode, section) accumulates, a new one replaces the mildest entry if the table is full
+    void add(uint8_t m, uint8_t s, uint32_t ms){
+        stalls++;
+        int slot = -1, mildest = 0;
+        for(int i=0; i<used; i++){
+            if(table[i].mode == m && table[i].section == s)
+                slot = i;
+            if(table[i].max_ms < table[mildest].max_ms)
+                mildest = i;
+        }
+        if(slot < 0){
+            if(used < STALL_SLOTS)
+                slot = used++;
+            else if(ms > table[mildest].max_ms)
+                slot = mildest;
+            else
+                return;
+            table[slot] = {m, s, 0, 0, 0};
+        }
+        StallEntry &e = table[slot];
+        if(e.count < 0xFFFF)
+            e.count++;
+        if(ms > e.max_ms)
+            e.max_ms = ms;
+        e.total_ms += ms;
+    }
+
+    //The rest of the iteration is frame pacing, not work
+    void idle(){
+        if(!armed)
+            return;
+        armed = false;
+        work_end = millis();
+    }
+
+    //Start of loop(): closes the previous iteration (early returns included) and opens the next
+    void next(uint8_t m){
+        uint32_t now = millis();
+        if(stalled)
+            add(stall_mode, stall_section, (armed ? now : work_end) - loop_start);
+        armed = false; //The ISR must not see the old start with the flags cleared
+        stalled = false;
+        hang_reported = false;
+        section = STALL_SEC_NONE;
+        mode = m;
+        loop_start = now;
+        armed = true;
+        loops++;
+    }
+
+    //Worst first: mode section count max avg (ms)
+    void dump(Print &out){
+        out.print("stall budget ");
+        out.print(uint32_t(budget_ms));
+        out.print("ms, ");
+        out.print(stalls);
+        out.print(" of ");
+        out.print(loops);
+        out.println(" loops");
+
+        bool done[STALL_SLOTS] = {};
+        for(int k=0; k<used; k++){
+            int w = -1;
+            for(int i=0; i<used; i++)
+                if(!done[i] && (w < 0 || table[i].max_ms > table[w].max_ms))
+                    w = i;
+            done[w] = true;
+            StallEntry &e = table[w];
+            out.print(e.mode < STALL_N_MODES ? STALL_MODE_NAMES[e.mode] : "?");
+            out.print(' ');
+            out.print(STALL_SECTION_NAMES[e.section]);
+            out.print(' ');
+            out.print(e.count);
+            out.print(' ');
+            out.print(e.max_ms);
+            out.print(' ');
+            out.println(e.total_ms/e.count);
+        }
+    }
+};
+
+#if STALL_MODE
+StallMonitor stall;
+
+//Tags the enclosing block, restores the outer section on exit
+struct StallScope{
+    uint8_t prev;
+
+    StallScope(uint8_t s): prev(stall.section){
+        stall.section = s;
+    }
+
+    ~StallScope(){
+        stall.section = prev;
+    }
+};
+
+void IRAM_ATTR stallISR(){
+    stall.check(millis());
+}
+
+//APB clock is 80 MHz whatever the CPU runs at, so /80 ticks in us
+void stallBegin(){
+    hw_timer_t* timer = timerBegin(STALL_TIMER, 80, true);
+    timerAttachInterrupt(timer, stallISR, true);
+    timerAlarmWrite(timer, STALL_TICK_MS*1000, true);
+    timerAlarmEnable(timer);
+}
+
+#define STALL_CAT2(a, b) a##b
+#define STALL_CAT(a, b) STALL_CAT2(a, b)
+#define STALL_SECTION(s) StallScope STALL_CAT(stall_scope_, __LINE__)(s)
+#define STALL_NEXT(mode) stall.next(mode)
+#define STALL_IDLE() stall.idle()
+#define STALL_BEGIN() stallBegin()
+#else
+#define STALL_SECTION(s)
+#define STALL_NEXT(mode)
+#define STALL_IDLE()
+#define STALL_BEGIN()
+#endif
+
+#endif
@@ -0,0 +1,371 @@
+#ifndef STUDYLOG_H
+#define STUDYLOG_H
+
+//Study log: one 16 byte record per timer session (start, planned and studied time,
+//pauses, finished or not) appended to the "studylog" partition. No filesystem: the
+//partition is a ring of 4 KB sectors, each starting with a header record that holds
+//its sequence number, and records fill the sectors in order. When the newest sector
+//is full the next one is erased and takes over, so every sector wears the same and
+//the oldest sessions go first.
+//
+//Boot reads the sector headers and binary searches the newest sector for its first
+//erased slot, appending is one 16 byte write. Reads go straight to the memory mapped
+//partition. tools/studylog_decode.py decodes a dump of it.
+//
+//Plain C++, on the PC the partition is a file (same bytes as the flash).
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef ARDUINO
+#include <esp_partition.h>
+#endif
+
+#define STUDY_PARTITION "studylog"
+#define STUDY_PARTITION_SUBTYPE 0x41
+#define STUDY_SECTOR 4096
+#define STUDY_RECORD 16
+#define STUDY_PER_SECTOR (STUDY_SECTOR/STUDY_RECORD) //Header included
+#define STUDY_HOST_SIZE 0x10000
+
+//Tags, erased flash reads 0xFF
+#define STUDY_TAG_SECTOR 0x5E
+#define STUDY_TAG_SESSION 0x5A
+#define STUDY_TAG_FREE 0xFF
+
+//Flags
+#define STUDY_DONE 1  //The countdown reached zero
+#define STUDY_CLOCK 2 //start is local time (s since 1970), otherwise s since power on
+
+#define STUDY_DAY 86400L
+
+struct StudyRecord{
+    uint8_t tag;
+    uint8_t flags;
+    uint8_t pauses;
+    uint8_t check;    //See study_check()
+    uint32_t start;   //Sector header: sequence number
+    uint16_t boot;    //Power on count, sessions of the same boot share it
+    uint16_t planned; //s
+    uint16_t studied; //s, pauses excluded
+    uint16_t paused;  //s
+};
+
+inline uint8_t study_check(const StudyRecord &r){
+    const uint8_t* p = (const uint8_t*)&r;
+    uint8_t c = 0x5C;
+    for(int i=0; i<STUDY_RECORD; i++)
+        if(i != 3)
+            c = (c << 1 | c >> 7) ^ p[i];
+    return c;
+}
+
+inline bool study_valid(const StudyRecord &r, uint8_t tag){
+    return r.tag == tag && r.check == study_check(r);
+}
+
+struct StudySummary{
+    uint16_t sessions;
+    uint16_t done;
+    uint16_t pauses;
+    uint32_t studied; //s
+
+    void add(const StudyRecord &r){
+        sessions++;
+        done += (r.flags & STUDY_DONE) != 0;
+        pauses += r.pauses;
+        studied += r.studied;
+    }
+};
+
+#ifdef ARDUINO
+//The partition, mapped for reads and written through the flash driver
+struct StudyFlash{
+    const esp_partition_t* part = NULL;
+    const uint8_t* base = NULL;
+    uint32_t size = 0;
+    spi_flash_mmap_handle_t handle;
+
+    bool open(){
+        part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+            (esp_partition_subtype_t)STUDY_PARTITION_SUBTYPE, STUDY_PARTITION);
+        if(part == NULL)
+            return false;
+        const void* ptr = NULL;
+        if(esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &handle) != ESP_OK)
+            return false;
+        base = (const uint8_t*)ptr;
+        size = part->size;
+        return true;
+    }
+
+    bool write(uint32_t offset, const void* data, uint32_t n){
+        return esp_partition_write(part, offset, data, n) == ESP_OK;
+    }
+
+    bool erase(uint32_t offset){
+        return esp_partition_erase_range(part, offset, STUDY_SECTOR) == ESP_OK;
+    }
+};
+#else
+//NOR flash in RAM, kept in a file: a write can only clear bits, an erase sets 0xFF
+struct StudyFlash{
+    uint8_t mem[STUDY_HOST_SIZE];
+    const uint8_t* base = mem;
+    uint32_t size = STUDY_HOST_SIZE;
+    const char* path = "studylog.bin";
+    uint32_t erases = 0;
+
+    bool open(){
+        memset(mem, 0xFF, size);
+        FILE* f = fopen(path, "rb");
+        if(f != NULL){
+            size_t n = fread(mem, 1, size, f);
+            (void)n;
+            fclose(f);
+        }
+        return true;
+    }
+
+    bool save(){
+        FILE* f = fopen(path, "wb");
+        if(f == NULL)
+            return false;
+        bool ok = fwrite(mem, 1, size, f) == size;
+        return fclose(f) == 0 && ok;
+    }
+
+    bool write(uint32_t offset, const void* data, uint32_t n){
+        const uint8_t* p = (const uint8_t*)data;
+        for(uint32_t i=0; i<n; i++)
+            mem[offset + i] &= p[i];
+        return save();
+    }
+
+    bool erase(uint32_t offset){
+        memset(mem + offset, 0xFF, STUDY_SECTOR);
+        erases++;
+        return save();
+    }
+};
+#endif
+
+struct StudyLog{
+    StudyFlash flash;
+    bool ready = false;
+    int sectors = 0;
+    int newest = 0;       //Sector being filled
+    uint32_t seq = 0;     //Its sequence number
+    uint32_t head = 0;    //Offset of the next record
+    uint16_t boot = 1;
+
+    //Session in progress (timer running or paused)
+    bool open = false;
+    StudyRecord cur;
+    unsigned long started_ms = 0;
+    unsigned long paused_at = 0;
+    unsigned long paused_ms = 0;
+
+    //Local time = clock_base + uptime, once someone told us ("clock" on the console)
+    bool clock_set = false;
+    uint32_t clock_base = 0;
+
+    StudyLog(){}
+
+    const StudyRecord& at(uint32_t offset){
+        return *(const StudyRecord*)(flash.base + offset);
+    }
+
+    bool begin(){
+        if(!flash.open() || flash.size < 2*STUDY_SECTOR)
+            return false;
+        sectors = flash.size/STUDY_SECTOR;
+
+        //Newest sector = highest valid sequence
+        seq = 0;
+        for(int s=0; s<sectors; s++){
+            const StudyRecord &h = at(s*STUDY_SECTOR);
+            if(study_valid(h, STUDY_TAG_SECTOR) && h.start > seq){
+                seq = h.start;
+                newest = s;
+            }
+        }
+        if(seq == 0){
+            if(!startSector(0, 1))
+                return false;
+        }
+        else{
+            //Records are written in order, the first free slot splits used from free
+            int lo = 1, hi = STUDY_PER_SECTOR;
+            while(lo < hi){
+                int mid = (lo + hi)/2;
+                if(at(newest*STUDY_SECTOR + mid*STUDY_RECORD).tag == STUDY_TAG_FREE)
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            head = newest*STUDY_SECTOR + lo*STUDY_RECORD;
+        }
+
+        ready = true;
+        StudyRecord last;
+        boot = newestSession(last) ? last.boot + 1 : 1;
+        return true;
+    }
+
+    bool startSector(int s, uint32_t n){
+        if(!flash.erase(s*STUDY_SECTOR))
+            return false;
+        StudyRecord h;
+        memset(&h, 0xFF, sizeof(h));
+        h.tag = STUDY_TAG_SECTOR;
+        h.flags = 0;
+        h.pauses = 0;
+        h.start = n;
+        h.check = study_check(h);
+        if(!flash.write(s*STUDY_SECTOR, &h, STUDY_RECORD))
+            return false;
+        newest = s;
+        seq = n;
+        head = s*STUDY_SECTOR + STUDY_RECORD;
+        return true;
+    }
+
+    bool append(StudyRecord r){
+        if(!ready)
+            return false;
+        if(head >= uint32_t(newest + 1)*STUDY_SECTOR && !startSector((newest + 1) % sectors, seq + 1))
+            return false;
+        r.tag = STUDY_TAG_SESSION;
+        r.check = study_check(r);
+        if(!flash.write(head, &r, STUDY_RECORD))
+            return false;
+        head += STUDY_RECORD;
+        return true;
+    }
+
+    //Valid sessions, newest first, until f returns false
+    template<class F>
+    void each(F f){
+        if(!ready)
+            return;
+        for(int k=0; k<sectors; k++){
+            int s = (newest - k + sectors) % sectors;
+            uint32_t base = s*STUDY_SECTOR;
+            if(k > 0 && (!study_valid(at(base), STUDY_TAG_SECTOR) || at(base).start != seq - k))
+                return; //Never written or from an older lap
+            uint32_t end = k == 0 ? head : base + STUDY_SECTOR;
+            for(uint32_t off = end - STUDY_RECORD; off > base; off -= STUDY_RECORD)
+                if(study_valid(at(off), STUDY_TAG_SESSION) && !f(at(off)))
+                    return;
+        }
+    }
+
+    bool newestSession(StudyRecord &out){
+        bool found = false;
+        each([&](const StudyRecord &r){
+            out = r;
+            found = true;
+            return false;
+        });
+        return found;
+    }
+
+    uint32_t count(){
+        uint32_t n = 0;
+        each([&](const StudyRecord &){
+            n++;
+            return true;
+        });
+        return n;
+    }
+
+    //Local time now, or 0 without a clock
+    uint32_t now(unsigned long now_ms){
+        return clock_set ? clock_base + now_ms/1000 : 0;
+    }
+
+    void setClock(uint32_t local, unsigned long now_ms){
+        clock_base = local - now_ms/1000;
+        clock_set = true;
+    }
+
+    //Local start time of a session, 0 if unknown
+    uint32_t startOf(const StudyRecord &r){
+        if(r.flags & STUDY_CLOCK)
+            return r.start;
+        if(clock_set && r.boot == boot)
+            return clock_base + r.start; //This boot, the clock came later
+        return 0;
+    }
+
+    //With a clock: today and this week (from Monday). Without one "today" is this boot
+    void summary(unsigned long now_ms, StudySummary &today, StudySummary &week, StudySummary &total){
+        memset(&today, 0, sizeof(today));
+        memset(&week, 0, sizeof(week));
+        memset(&total, 0, sizeof(total));
+        uint32_t t = now(now_ms);
+        long day = t/STUDY_DAY;
+        uint32_t day_start = day*STUDY_DAY;
+        uint32_t week_start = (day - (day + 3) % 7)*STUDY_DAY; //1970-01-01 was a Thursday
+
+        each([&](const StudyRecord &r){
+            total.add(r);
+            uint32_t start = startOf(r);
+            if(clock_set){
+                if(start >= week_start)
+                    week.add(r);
+                if(start >= day_start)
+                    today.add(r);
+            }
+            else if(r.boot == boot)
+                today.add(r);
+            return true;
+        });
+    }
+
+    //Timer hooks
+    void start(unsigned long now_ms, uint32_t planned_s){
+        memset(&cur, 0, sizeof(cur));
+        cur.boot = boot;
+        cur.planned = planned_s;
+        cur.flags = clock_set ? STUDY_CLOCK : 0;
+        cur.start = clock_set ? now(now_ms) : now_ms/1000;
+        started_ms = now_ms;
+        paused_ms = 0;
+        paused_at = 0;
+        open = true;
+    }
+
+    void pause(unsigned long now_ms){
+        if(!open || paused_at != 0)
+            return;
+        paused_at = now_ms | 1; //0 = not paused
+        if(cur.pauses < 255)
+            cur.pauses++;
+    }
+
+    void resume(unsigned long now_ms){
+        if(!open || paused_at == 0)
+            return;
+        paused_ms += now_ms - paused_at;
+        paused_at = 0;
+    }
+
+    //Finished (done) or abandoned, sessions shorter than a minute are not kept
+    bool finish(unsigned long now_ms, bool done){
+        if(!open)
+            return false;
+        resume(now_ms);
+        open = false;
+        uint32_t studied = (now_ms - started_ms - paused_ms)/1000;
+        if(!done && studied < 60)
+            return false;
+        cur.studied = studied < 0xFFFF ? studied : 0xFFFF;
+        cur.paused = paused_ms/1000 < 0xFFFF ? paused_ms/1000 : 0xFFFF;
+        if(done)
+            cur.flags |= STUDY_DONE;
+        return append(cur);
+    }
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+//Text from the pre-rendered glyphs of font.h, blitted straight into the page buffer.
+//Strings are UTF-8, anything outside ASCII + FONT_LATIN1 shows as '?'.
+#include <blit.h>
+#include <font.h>
+
+struct Text{
+    Blitter* blit = NULL;
+
+    Text(){}
+
+    void init(Blitter &blit){
+        this->blit = &blit;
+    }
+
+    //Next character as Latin-1, moves s forward (0 = end of string)
+    static uint8_t next(const char* &s){
+        uint8_t c = *s;
+        if(c == 0)
+            return 0;
+        s++;
+        if(c < 0x80)
+            return c;
+
+        //U+0080 - U+00FF come as C2 xx / C3 xx
+        if((c == 0xC2 || c == 0xC3) && (uint8_t(*s) & 0xC0) == 0x80)
+            return ((c & 0x03) << 6) | (uint8_t(*s++) & 0x3F);
+
+        //Something we can't show, skip the rest of the sequence
+        while((uint8_t(*s) & 0xC0) == 0x80)
+            s++;
+        return '?';
+    }
+
+    static int glyph(uint8_t c){
+        if(c >= FONT_FIRST && c <= FONT_LAST)
+            return c - FONT_FIRST;
+        for(int i=0; i<FONT_N_LATIN1; i++)
+            if(FONT_LATIN1[i] == c)
+                return FONT_LAST - FONT_FIRST + 1 + i;
+        return '?' - FONT_FIRST;
+    }
+
+    //Only sizes 1 and 2 are pre-rendered
+    static int size(int sz){
+        return sz >= 2 ? 2 : 1;
+    }
+
+    //Ink width in px of the widest line (no trailing blank column)
+    static int width(const char* s, int sz=1){
+        sz = size(sz);
+        int best = 0, n = 0;
+        for(uint8_t c = next(s); ; c = next(s)){
+            if(c == 0 || c == '\n'){
+                best = n > best ? n : best;
+                n = 0;
+                if(c == 0)
+                    break;
+            }
+            else if(c != '\r')
+                n++;
+        }
+        return best ? best*FONT_ADVANCE*sz - sz : 0;
+    }
+
+    //Glyphs are 5-10 columns wide, plain byte ops beat the word path for them.
+    //Anything clipped or with another op goes through the blitter.
+    void glyphBlit(const uint8_t* data, int w, int pages, int x, int y, int op){
+        if(op != ROP_SET || x < 0 || y < 0 || x + w > blit->width || y + pages*8 > blit->pages*8){
+            Sprite s = {uint8_t(w), uint8_t(pages*8), data, NULL};
+            blit->sprite(s, x, y, op);
+            return;
+        }
+
+        int shift = y & 7;
+        uint8_t* d = blit->buf + (y >> 3)*blit->width + x;
+        for(int p=0; p<pages; p++, data += w, d += blit->width){
+            if(shift == 0){
+                for(int i=0; i<w; i++)
+                    d[i] |= data[i];
+            }
+            else{
+                uint8_t* below = d + blit->width; //Exists, the glyph fits on screen
+                for(int i=0; i<w; i++){
+                    d[i] |= data[i] << shift;
+                    below[i] |= data[i] >> (8 - shift);
+                }
+            }
+        }
+    }
+
+    //Draws like GFX print(): wraps at the right edge and on '\n', x/y end up at the cursor
+    void draw(const char* s, int &x, int &y, int sz=1, int op=ROP_SET){
+        sz = size(sz);
+        int advance = FONT_ADVANCE*sz;
+        for(uint8_t c = next(s); c != 0; c = next(s)){
+            if(c == '\n'){
+                x = 0;
+                y += 8*sz;
+                continue;
+            }
+            if(c == '\r')
+                continue;
+            if(x + advance > blit->width){
+                x = 0;
+                y += 8*sz;
+            }
+
+            int g = glyph(c);
+            if(sz == 1)
+                glyphBlit(FONT_SMALL + g*FONT_W, FONT_W, 1, x, y, op);
+            else
+                glyphBlit(FONT_LARGE + g*FONT_W*4, FONT_W*2, 2, x, y, op);
+            x += advance;
+        }
+    }
+};
+
+#endif
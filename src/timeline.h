@@ -0,0 +1,90 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <Arduino.h>
+#include <objects.h>
+#include <birthday.h>
+#include <shows.h> //Keyframes, tracks and the scripts
+
+//Plays keyframe scripts without blocking, several at once
+struct Timeline{
+    Track tracks[MAX_TRACKS];
+
+    Screen* screen;
+    Arm* arm;
+    Speaker* spk;
+    HappyBday* song;
+
+    Timeline(){}
+
+    void init(Screen &screen, Arm &arm, Speaker &spk, HappyBday &song){
+        this->screen = &screen;
+        this->arm = &arm;
+        this->spk = &spk;
+        this->song = &song;
+    }
+
+    //Starts a script on a free track, false if all are busy
+    bool play(const Keyframe* script){
+        rep(i, MAX_TRACKS){
+            if(tracks[i].script != NULL)
+                continue;
+            tracks[i].script = script;
+            tracks[i].next = 0;
+            tracks[i].start = get_time();
+            run(tracks[i]); //Keyframes at 0 happen right away
+            return true;
+        }
+        return false;
+    }
+
+    //Something still playing? (including the song)
+    bool busy(){
+        if(song->playing())
+            return true;
+        rep(i, MAX_TRACKS)
+            if(tracks[i].script != NULL)
+                return true;
+        return false;
+    }
+
+    void stop(){
+        rep(i, MAX_TRACKS)
+            tracks[i].script = NULL;
+        song->thisNote = -1;
+    }
+
+    void exec(const Keyframe &k){
+        if(k.op == KF_FACE)
+            screen->showFace(k.a);
+        else if(k.op == KF_ARM)
+            arm->move(k.a);
+        else if(k.op == KF_TONE)
+            spk->play(k.a, k.b);
+        else if(k.op == KF_TEXT){
+            display.clearDisplay();
+            screen->printCentered((const char*)k.ptr);
+            screen->show();
+        }
+        else if(k.op == KF_PLAY)
+            play((const Keyframe*)k.ptr);
+        else if(k.op == KF_SONG)
+            song->start();
+    }
+
+    //Runs every keyframe that is due on this track
+    void run(Track &t){
+        run_track(t, get_time(), *this);
+    }
+
+    //Call every loop, timing is good to one loop tick
+    void update(){
+        rep(i, MAX_TRACKS)
+            if(tracks[i].script != NULL)
+                run(tracks[i]);
+        song->update();
+        spk->update();
+    }
+};
+
+#endif
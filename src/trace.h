@@ -0,0 +1,166 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#endif
+
+//Binary event tracer: begin/end spans and instant events stamped with the CPU cycle
+//counter, streamed over the serial port. tools/trace2json.py turns the capture into a
+//Chrome / Perfetto trace. Build with -DTRACE_MODE=1, otherwise every TRACE_ macro is empty.
+//
+//Two single-producer rings, one for the encoder ISR and one for the main loop, so
+//recording needs no locks or atomics (the C3 has none): ~20 cycles per event.
+//Ids and the event layout are plain C++ for tools/energy_replay.cpp, the rings are
+//on the bot only.
+#ifndef TRACE_MODE
+#define TRACE_MODE 0
+#endif
+
+//Event types
+#define TRACE_T_BEGIN 0
+#define TRACE_T_END 1
+#define TRACE_T_INSTANT 2
+
+//Event ids, tools/trace2json.py reads the names from here
+#define TRACE_SYNC 1     //arg = CPU MHz, sent every second and on frequency changes
+#define TRACE_DROPPED 2  //arg = events lost to a full ring
+#define TRACE_ENCODER 3  //Encoder ISR, arg = direction
+#define TRACE_CLICK 4    //Button edge
+#define TRACE_MODE_SET 5 //arg = mode (PERF_MODE_* numbering)
+#define TRACE_FLUSH 6    //Span, begin arg = lit pixels, end arg = bytes sent
+#define TRACE_BEEP 7     //Span, arg = frequency
+#define TRACE_TONE 8     //Non blocking tone, arg = duration ms
+#define TRACE_SERVO 9    //arg = degrees
+#define TRACE_LOOP 10    //Span, one loop() iteration
+#define TRACE_ARM 11     //New arm target, arg = degrees
+#define TRACE_POWER 12   //Profile or battery change, arg = profile | servo << 3 | mute << 4 | contrast << 8
+#define TRACE_PACE 13    //End of the loop work, arg = ms it sleeps
+
+#define TRACE_FRAME_START 0xA5
+#define TRACE_FRAME_SIZE 10 //Start, 8 event bytes, xor of the event bytes
+#define TRACE_SYNC_MS 1000
+
+struct TraceEvent{
+    uint32_t cycles;
+    uint8_t type;
+    uint8_t id;
+    uint16_t arg;
+};
+
+#ifdef ARDUINO
+//Written by one context, read by the main loop
+template<int N>
+struct TraceRing{
+    TraceEvent events[N];
+    volatile uint16_t head = 0;
+    volatile uint16_t tail = 0;
+    volatile uint16_t dropped = 0;
+
+    inline void push(uint8_t type, uint8_t id, uint16_t arg){
+        uint16_t h = head;
+        if(uint16_t(h - tail) >= N){
+            dropped++;
+            return;
+        }
+        TraceEvent &e = events[h & (N-1)];
+        e.cycles = ESP.getCycleCount();
+        e.type = type;
+        e.id = id;
+        e.arg = arg;
+        asm volatile("" ::: "memory"); //Event before head
+        head = h + 1;
+    }
+
+    bool empty(){
+        return head == tail;
+    }
+};
+
+struct Tracer{
+    TraceRing<256> main;
+    TraceRing<64> isr;
+    unsigned long last_sync = 0;
+    bool sync_pending = true;
+
+    Tracer(){}
+
+    void send(Print &out, const TraceEvent &e){
+        uint8_t f[TRACE_FRAME_SIZE];
+        f[0] = TRACE_FRAME_START;
+        memcpy(f + 1, &e, 8);
+        f[9] = 0;
+        for(int i=1; i<9; i++)
+            f[9] ^= f[i];
+        out.write(f, TRACE_FRAME_SIZE);
+    }
+
+    //Call when the CPU clock changes, the host needs it to turn cycles into time
+    void sync(){
+        sync_pending = true;
+    }
+
+    template<int N>
+    void drain(HardwareSerial &out, TraceRing<N> &ring){
+        if(ring.dropped != 0){
+            TraceEvent e = {ESP.getCycleCount(), TRACE_T_INSTANT, TRACE_DROPPED, ring.dropped};
+            ring.dropped = 0;
+            send(out, e);
+        }
+        while(!ring.empty() && out.availableForWrite() >= TRACE_FRAME_SIZE){
+            send(out, ring.events[ring.tail & (N-1)]);
+            ring.tail = ring.tail + 1;
+        }
+    }
+
+    //Sends what fits in the UART buffer without waiting, call every loop
+    void pump(HardwareSerial &out){
+        if(sync_pending || millis() - last_sync >= TRACE_SYNC_MS){
+            TraceEvent e = {ESP.getCycleCount(), TRACE_T_INSTANT, TRACE_SYNC, uint16_t(getCpuFrequencyMhz())};
+            send(out, e);
+            last_sync = millis();
+            sync_pending = false;
+        }
+        drain(out, isr);
+        drain(out, main);
+    }
+};
+#endif
+
+#if TRACE_MODE && defined(ARDUINO)
+Tracer trace;
+
+struct TraceScope{
+    uint8_t id;
+
+    TraceScope(uint8_t id, uint16_t arg): id(id){
+        trace.main.push(TRACE_T_BEGIN, id, arg);
+    }
+
+    ~TraceScope(){
+        trace.main.push(TRACE_T_END, id, 0);
+    }
+};
+
+#define TRACE_CAT2(a, b) a##b
+#define TRACE_CAT(a, b) TRACE_CAT2(a, b)
+#define TRACE_BEGIN(id, arg) trace.main.push(TRACE_T_BEGIN, id, arg)
+#define TRACE_END(id, arg) trace.main.push(TRACE_T_END, id, arg)
+#define TRACE_INSTANT(id, arg) trace.main.push(TRACE_T_INSTANT, id, arg)
+#define TRACE_SCOPE(id, arg) TraceScope TRACE_CAT(trace_scope_, __LINE__)(id, arg)
+#define TRACE_ISR(id, arg) trace.isr.push(TRACE_T_INSTANT, id, arg)
+#define TRACE_SYNC_NOW() trace.sync()
+#define TRACE_PUMP() trace.pump(Serial)
+#else
+#define TRACE_BEGIN(id, arg)
+#define TRACE_END(id, arg)
+#define TRACE_INSTANT(id, arg)
+#define TRACE_SCOPE(id, arg)
+#define TRACE_ISR(id, arg)
+#define TRACE_SYNC_NOW()
+#define TRACE_PUMP()
+#endif
+
+#endif
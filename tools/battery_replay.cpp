@@ -0,0 +1,162 @@
+//Battery estimator replay, logged samples through src/battery.h
+//
+//Feeds battery samples to BatteryEstimator (src/battery.h) and to the old logic
+//(linear 3.6-4.2 V, +-0.5 V spike clamp, low battery at 3.6 V without hysteresis)
+//and prints both side by side plus a summary: low battery toggles, how far the
+//shown charge jumps back up while discharging, and when low battery starts.
+//
+//Input: what "bat log" prints on the serial console ("bat,ms,mv,load_ma" lines,
+//anything else is skipped). Without a file it makes a synthetic discharge from the
+//same curve with servo/buzzer load steps, ADC noise and glitches, which only checks
+//that the estimator behaves, it is not a measurement.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/battery_replay.cpp -o battery_replay
+//Usage: ./battery_replay [captura.txt] [--every seconds]
+
+#include <battery.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct Sample{
+    uint32_t ms;
+    int mv;
+    int load;
+};
+
+std::vector<Sample> readLog(const char* path){
+    std::vector<Sample> out;
+    FILE* f = fopen(path, "r");
+    if(f == NULL){
+        perror(path);
+        exit(1);
+    }
+    char line[128];
+    while(fgets(line, sizeof(line), f)){
+        unsigned long ms;
+        int mv, load;
+        if(sscanf(line, "bat,%lu,%d,%d", &ms, &mv, &load) == 3)
+            out.push_back({uint32_t(ms), mv, load});
+    }
+    fclose(f);
+    return out;
+}
+
+uint32_t rng = 12345;
+double rnd(){
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng & 0xFFFFFF)/double(0x1000000);
+}
+
+//Inverse of the curve: charge -> open circuit mV
+double ocvFor(double pct){
+    for(unsigned i=1; i<BAT_CURVE_N; i++)
+        if(pct <= BAT_CURVE[i].pct){
+            const BatPoint &a = BAT_CURVE[i-1], &b = BAT_CURVE[i];
+            return a.mv + (pct - a.pct)*(b.mv - a.mv)/double(b.pct - a.pct);
+        }
+    return BAT_CURVE[BAT_CURVE_N-1].mv;
+}
+
+//500 mAh cell, ~35 mA base, servo moves and beeps now and then. The real internal
+//resistance is a bit off from BAT_R_MOHM on purpose
+std::vector<Sample> synthetic(){
+    std::vector<Sample> out;
+    double mah = 500, used = 0, r_ohm = 0.3;
+    int servo_left = 0, tone_left = 0;
+    for(uint32_t s=0; used < mah*0.995; s++){
+        int load = 35;
+        if(servo_left == 0 && rnd() < 0.05) servo_left = 1 + int(rnd()*2);
+        if(tone_left == 0 && rnd() < 0.03) tone_left = 1;
+        int true_load = load;
+        if(servo_left > 0){ servo_left--; load += 250; true_load += 200 + int(rnd()*250); }
+        if(tone_left > 0){ tone_left--; load += 25; true_load += 25; }
+        used += true_load/3600.0;
+
+        double pct = 100*(1 - used/mah);
+        double mv = ocvFor(pct) - true_load*r_ohm + (rnd() - 0.5)*30;
+        if(rnd() < 0.002)
+            mv += rnd() < 0.5 ? -450 : 450; //ADC glitch
+        out.push_back({s*1000, int(mv), load});
+    }
+    return out;
+}
+
+//Old loop(): linear percent, clamp spikes over 0.5 V, low below 3.6 V
+struct OldLogic{
+    float volts = 4.2;
+    bool low = false;
+
+    void sample(int mv){
+        float v = mv/1000.0;
+        if(fabs(volts - v) <= 0.5)
+            volts = v;
+        low = volts <= 3.6;
+    }
+
+    int percent(){
+        int p = int((volts - 3.6)*100/(4.2 - 3.6));
+        return p < 0 ? 0 : (p > 100 ? 100 : p);
+    }
+};
+
+int main(int argc, char** argv){
+    const char* path = NULL;
+    int every = 1800;
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--every") == 0 && i+1 < argc)
+            every = atoi(argv[++i]);
+        else
+            path = argv[i];
+    }
+
+    std::vector<Sample> samples = path ? readLog(path) : synthetic();
+    if(samples.empty()){
+        printf("no bat,ms,mv,load lines\n");
+        return 1;
+    }
+    printf("%s, %zu samples\n", path ? path : "synthetic discharge", samples.size());
+    printf("%8s %6s %5s | %5s %4s | %5s %5s %4s\n", "min", "mv", "load", "old%", "low", "new%", "ocv", "low");
+
+    BatteryEstimator est;
+    OldLogic old;
+    int old_toggles = 0, new_toggles = 0;
+    int old_rise = 0, new_rise = 0; //Biggest jump back up of the shown charge
+    int old_min = 100, new_min = 100;
+    long old_low_at = -1, new_low_at = -1;
+    uint32_t next_print = 0;
+
+    for(const Sample &s : samples){
+        bool was_old = old.low, was_new = est.low;
+        old.sample(s.mv);
+        est.sample(s.ms, s.mv, s.load);
+
+        old_toggles += old.low != was_old;
+        new_toggles += est.low != was_new;
+        if(old.low && old_low_at < 0) old_low_at = s.ms/1000;
+        if(est.low && new_low_at < 0) new_low_at = s.ms/1000;
+
+        int op = old.percent(), np = est.percent();
+        if(op - old_min > old_rise) old_rise = op - old_min;
+        if(np - new_min > new_rise) new_rise = np - new_min;
+        if(op < old_min) old_min = op;
+        if(np < new_min) new_min = np;
+
+        if(s.ms >= next_print){
+            printf("%8.1f %6d %5d | %4d%% %4s | %4d%% %5d %4s\n", s.ms/60000.0, s.mv, s.load,
+                op, old.low ? "LOW" : "", np, int(est.est_mv), est.low ? "LOW" : "");
+            next_print = s.ms + every*1000u;
+        }
+    }
+
+    printf("\n%-28s %8s %8s\n", "", "old", "new");
+    printf("%-28s %8d %8d\n", "low battery toggles", old_toggles, new_toggles);
+    printf("%-28s %7d%% %7d%%\n", "biggest rise while draining", old_rise, new_rise);
+    printf("%-28s %8.1f %8.1f\n", "low battery from (min)", old_low_at/60.0, new_low_at/60.0);
+    return 0;
+}
@@ -0,0 +1,223 @@
+//Blitter benchmark, against the drawPixel path of Adafruit GFX
+//
+//Runs what the firmware draws through src/blit.h (Pong paddles and erases, the
+//ball sprite, the blink marker, the faces, the menu scroll) and through the Adafruit
+//GFX path it replaced (virtual drawPixel per pixel: fillRect as vertical lines,
+//fillCircle, drawBitmap, and a getPixel/drawPixel copy for the scroll). Checks both
+//give the same pixels, first for those calls and then for every ball position,
+//random rectangles with every op and every scroll distance, and prints the time per
+//call. Exits 1 on any difference.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/blit_bench.cpp -o blit_bench
+//Usage: ./blit_bench [iterations]
+
+#include <blit.h>
+#include <faces.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define W 128
+#define H 64
+
+#define GFX_BLACK 0
+#define GFX_WHITE 1
+#define GFX_INVERSE 2
+
+//Same call pattern as Adafruit GFX + the SH1106G driver
+struct GfxModel{
+    uint8_t* buf;
+
+    virtual ~GfxModel(){}
+
+    virtual void drawPixel(int x, int y, int color){
+        if(x < 0 || y < 0 || x >= W || y >= H)
+            return;
+        uint8_t &b = buf[x + (y/8)*W];
+        if(color == GFX_WHITE) b |= 1 << (y & 7);
+        else if(color == GFX_BLACK) b &= ~(1 << (y & 7));
+        else b ^= 1 << (y & 7);
+    }
+
+    bool getPixel(int x, int y){
+        if(x < 0 || y < 0 || x >= W || y >= H)
+            return false;
+        return buf[x + (y/8)*W] & (1 << (y & 7));
+    }
+
+    void drawFastVLine(int x, int y, int h, int color){
+        for(int j=0; j<h; j++)
+            drawPixel(x, y + j, color);
+    }
+
+    void fillRect(int x, int y, int w, int h, int color){
+        for(int i=x; i<x+w; i++)
+            drawFastVLine(i, y, h, color);
+    }
+
+    void fillCircleHelper(int x0, int y0, int r, int corners, int delta, int color){
+        int f = 1 - r, ddF_x = 1, ddF_y = -2*r, x = 0, y = r, px = x, py = y;
+        delta++;
+        while(x < y){
+            if(f >= 0){
+                y--;
+                ddF_y += 2;
+                f += ddF_y;
+            }
+            x++;
+            ddF_x += 2;
+            f += ddF_x;
+            if(x < y + 1){
+                if(corners & 1) drawFastVLine(x0 + x, y0 - y, 2*y + delta, color);
+                if(corners & 2) drawFastVLine(x0 - x, y0 - y, 2*y + delta, color);
+            }
+            if(y != py){
+                if(corners & 1) drawFastVLine(x0 + py, y0 - px, 2*px + delta, color);
+                if(corners & 2) drawFastVLine(x0 - py, y0 - px, 2*px + delta, color);
+                py = y;
+            }
+            px = x;
+        }
+    }
+
+    void fillCircle(int x0, int y0, int r, int color){
+        drawFastVLine(x0, y0 - r, 2*r + 1, color);
+        fillCircleHelper(x0, y0, r, 3, 0, color);
+    }
+
+    void drawBitmap(int x, int y, const uint8_t* bitmap, int w, int h, int color){
+        int byte_w = (w + 7)/8;
+        uint8_t b = 0;
+        for(int j=0; j<h; j++, y++)
+            for(int i=0; i<w; i++){
+                if(i & 7)
+                    b <<= 1;
+                else
+                    b = bitmap[j*byte_w + i/8];
+                if(b & 0x80)
+                    drawPixel(x + i, y, color);
+            }
+    }
+
+    //What a scroll costs without the blitter: read every pixel back, write it d rows up
+    void scroll(int d){
+        static uint8_t copy[W*H/8];
+        memcpy(copy, buf, sizeof(copy));
+        GfxModel src;
+        src.buf = copy;
+        for(int y=0; y<H; y++)
+            for(int x=0; x<W; x++)
+                drawPixel(x, y, src.getPixel(x, y + d) ? GFX_WHITE : GFX_BLACK);
+    }
+};
+
+int gfx_color(int op){
+    return op == ROP_CLEAR ? GFX_BLACK : (op == ROP_XOR ? GFX_INVERSE : GFX_WHITE);
+}
+
+uint32_t rng = 1;
+int rand_range(int lo, int hi){
+    rng = rng*1664525u + 1013904223u;
+    return lo + int((rng >> 8) % uint32_t(hi - lo + 1));
+}
+
+void noise(uint8_t* a, uint8_t* b){
+    for(int i=0; i<W*H/8; i++)
+        a[i] = b[i] = uint8_t(rand_range(0, 255));
+}
+
+template<class F>
+double time_ns(long iters, F f){
+    auto t0 = std::chrono::steady_clock::now();
+    for(long i=0; i<iters; i++)
+        f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count()/iters;
+}
+
+int main(int argc, char** argv){
+    long iters = argc > 1 ? atol(argv[1]) : 100000;
+
+    static uint8_t a[W*H/8], b[W*H/8];
+    Blitter blit;
+    blit.init(a, W, H);
+    GfxModel *gfx = new GfxModel();
+    gfx->buf = b;
+
+    //What the bot actually draws
+    struct Case{
+        const char* name;
+        void (*blit)(Blitter&);
+        void (*gfx)(GfxModel*);
+        long iters;
+    };
+    const Case cases[] = {
+        {"pong paddle", [](Blitter &t){ t.fill(4, 23, 2, 18, ROP_SET); },
+            [](GfxModel* g){ g->fillRect(4, 23, 2, 18, GFX_WHITE); }, iters},
+        {"pong erase", [](Blitter &t){ t.fill(122, 21, 2, 18, ROP_CLEAR); },
+            [](GfxModel* g){ g->fillRect(122, 21, 2, 18, GFX_BLACK); }, iters},
+        {"ball", [](Blitter &t){ t.sprite(BALL_SPRITE, 61, 29, ROP_SET); },
+            [](GfxModel* g){ g->fillCircle(64, 32, 3, GFX_WHITE); }, iters},
+        {"blink marker", [](Blitter &t){ t.fill(W-8, 0, 8, 8, ROP_XOR); },
+            [](GfxModel* g){ g->fillRect(W-8, 0, 8, 8, GFX_INVERSE); }, iters},
+        {"menu erase", [](Blitter &t){ t.fill(0, 21, 18, 8, ROP_CLEAR); },
+            [](GfxModel* g){ g->fillRect(0, 21, 18, 8, GFX_BLACK); }, iters},
+        {"face", [](Blitter &t){ t.rowBitmap(0, 0, Faces[FACE_HAPPY], W, H, ROP_SET); },
+            [](GfxModel* g){ g->drawBitmap(0, 0, Faces[FACE_HAPPY], W, H, GFX_WHITE); }, iters/10},
+        {"scroll 3 rows", [](Blitter &t){ t.shiftRows(3); },
+            [](GfxModel* g){ g->scroll(3); }, iters/10},
+    };
+
+    int bad = 0;
+    printf("%-14s %10s %10s %8s\n", "case", "gfx_ns", "blit_ns", "speedup");
+    for(const Case &c : cases){
+        noise(a, b);
+        c.blit(blit);
+        c.gfx(gfx);
+        if(memcmp(a, b, sizeof(a)) != 0){
+            printf("%s: pixels differ\n", c.name);
+            bad++;
+        }
+        double g = time_ns(c.iters, [&](){ c.gfx(gfx); });
+        double t = time_ns(c.iters, [&](){ c.blit(blit); });
+        printf("%-14s %10.1f %10.1f %7.1fx\n", c.name, g, t, g/t);
+    }
+
+    //The ball everywhere, clipped at every edge
+    for(int y=-8; y<=H; y++)
+        for(int x=-8; x<=W; x++){
+            noise(a, b);
+            blit.sprite(BALL_SPRITE, x, y, ROP_SET);
+            gfx->fillCircle(x + 3, y + 3, 3, GFX_WHITE);
+            bad += memcmp(a, b, sizeof(a)) != 0;
+        }
+
+    //Random rectangles, every op
+    for(int i=0; i<20000; i++){
+        int x = rand_range(-10, W), y = rand_range(-10, H), w = rand_range(0, W), h = rand_range(0, H);
+        int op = rand_range(ROP_SET, ROP_XOR);
+        noise(a, b);
+        blit.fill(x, y, w, h, op);
+        gfx->fillRect(x, y, w, h, gfx_color(op));
+        bad += memcmp(a, b, sizeof(a)) != 0;
+    }
+
+    //Every face, every scroll distance
+    for(int i=0; i<N_FACES; i++){
+        noise(a, b);
+        blit.rowBitmap(0, 0, Faces[i], W, H, ROP_SET);
+        gfx->drawBitmap(0, 0, Faces[i], W, H, GFX_WHITE);
+        bad += memcmp(a, b, sizeof(a)) != 0;
+    }
+    for(int d=-H-1; d<=H+1; d++){
+        noise(a, b);
+        blit.shiftRows(d);
+        gfx->scroll(d);
+        bad += memcmp(a, b, sizeof(a)) != 0;
+    }
+
+    printf("%s\n", bad ? "MISMATCH" : "pixels identical");
+    delete gfx;
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,276 @@
+//Energy replay of a TRACE_MODE capture
+//
+//Reads the binary trace of the ttgo-t-oi-plus-trace build (src/trace.h) and feeds it
+//to the same EnergyMeter the bot runs (src/energy.h), so it prints the same report as
+//"energy" on the serial console: mAh per mode and subsystem, average mA and runtime.
+//
+//What it takes from the trace: MODE_SET (mode), SYNC (CPU MHz), POWER (contrast,
+//servo on, mute), PACE (loop work and sleep), FLUSH (bytes and lit pixels), BEEP and
+//TONE (buzzer time), ARM (moves) and SERVO (the servo is moving until ARM_SETTLE_MS
+//after the last write). Without a file it replays a synthetic session, which only
+//checks the decoding and the arithmetic, it is not a measurement.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/energy_replay.cpp -o energy_replay
+//Usage: ./energy_replay [captura.bin] [--cost nombre=valor]...   (nombres: "energy cost")
+
+#include <energy.h>
+#include <trace.h>
+#include <perf.h>
+#include <arm_motion.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+std::vector<uint8_t> readFile(const char* path){
+    FILE* f = fopen(path, "rb");
+    if(f == NULL){
+        perror(path);
+        exit(1);
+    }
+    std::vector<uint8_t> data;
+    uint8_t buf[4096];
+    size_t n;
+    while((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        data.insert(data.end(), buf, buf + n);
+    fclose(f);
+    return data;
+}
+
+//Valid frames only, console text and broken bytes in between are skipped
+std::vector<TraceEvent> frames(const std::vector<uint8_t> &data){
+    std::vector<TraceEvent> out;
+    size_t i = 0, bad = 0;
+    while(i + TRACE_FRAME_SIZE <= data.size()){
+        if(data[i] == TRACE_FRAME_START){
+            uint8_t x = 0;
+            for(int k=1; k<9; k++)
+                x ^= data[i+k];
+            if(x == data[i+9]){
+                TraceEvent e;
+                memcpy(&e.cycles, &data[i+1], 4);
+                e.type = data[i+5];
+                e.id = data[i+6];
+                memcpy(&e.arg, &data[i+7], 2);
+                out.push_back(e);
+                i += TRACE_FRAME_SIZE;
+                continue;
+            }
+        }
+        bad++;
+        i++;
+    }
+    if(bad)
+        fprintf(stderr, "skipped %zu bytes\n", bad);
+    return out;
+}
+
+struct Replay{
+    EnergyMeter meter;
+    int mhz = 0;
+    int contrast = 0;
+    bool servo_on = false;
+    bool mute = false;
+    double beep_at = -1;
+    double last_write = -1e12;
+    double pace_end = -1; //us, end of the last frame's sleep
+
+    void event(double us, const TraceEvent &e){
+        switch(e.id){
+        case TRACE_SYNC: mhz = e.arg; break;
+        case TRACE_MODE_SET: meter.setMode(e.arg); break;
+        case TRACE_POWER:
+            servo_on = e.arg >> 3 & 1;
+            mute = e.arg >> 4 & 1;
+            contrast = e.arg >> 8;
+            break;
+        case TRACE_FLUSH:
+            if(e.type == TRACE_T_BEGIN)
+                meter.lit = e.arg;
+            else if(e.type == TRACE_T_END)
+                meter.flush(e.arg, meter.lit);
+            break;
+        case TRACE_BEEP:
+            if(e.type == TRACE_T_BEGIN)
+                beep_at = mute ? -1 : us;
+            else if(e.type == TRACE_T_END && beep_at >= 0){
+                meter.buzzer(uint32_t((us - beep_at)/1000 + 0.5));
+                beep_at = -1;
+            }
+            break;
+        case TRACE_TONE:
+            if(!mute)
+                meter.buzzer(e.arg);
+            break;
+        case TRACE_ARM: meter.servoMove(); break;
+        case TRACE_SERVO: last_write = us; break;
+        case TRACE_PACE:
+            if(pace_end >= 0){
+                bool moving = servo_on && us - last_write < ARM_SETTLE_MS*1000.0;
+                meter.frame(uint32_t((us - pace_end)/1000 + 0.5), e.arg, mhz, contrast, servo_on, moving);
+            }
+            pace_end = us + e.arg*1000.0;
+            break;
+        }
+    }
+
+    //Cycles -> us with the last SYNC, nothing counts before the first one
+    void run(const std::vector<TraceEvent> &events){
+        uint32_t last = 0;
+        bool synced = false;
+        double us = 0;
+        for(const TraceEvent &e : events){
+            if(!synced){
+                if(e.id != TRACE_SYNC)
+                    continue;
+                synced = true;
+                last = e.cycles;
+            }
+            //The ISR ring goes out first, small negative deltas are fine
+            us += int32_t(e.cycles - last)/double(mhz > 0 ? mhz : e.arg);
+            last = e.cycles;
+            event(us, e);
+        }
+    }
+};
+
+//Builds a trace the way the bot would send it
+struct Synth{
+    std::vector<uint8_t> data;
+    uint32_t cycles = 0;
+    int mhz = 80;
+    double since_sync = 0;
+
+    void emit(uint8_t type, uint8_t id, uint16_t arg){
+        uint8_t f[TRACE_FRAME_SIZE];
+        f[0] = TRACE_FRAME_START;
+        memcpy(f + 1, &cycles, 4);
+        f[5] = type;
+        f[6] = id;
+        memcpy(f + 7, &arg, 2);
+        f[9] = 0;
+        for(int i=1; i<9; i++)
+            f[9] ^= f[i];
+        data.insert(data.end(), f, f + TRACE_FRAME_SIZE);
+    }
+
+    void wait(double us){
+        cycles += uint32_t(us*mhz);
+        since_sync += us;
+        if(since_sync >= 1000000){
+            emit(TRACE_T_INSTANT, TRACE_SYNC, mhz);
+            since_sync = 0;
+        }
+    }
+
+    void power(int profile, int clock, bool servo, bool muted, int contrast){
+        if(clock != mhz){
+            mhz = clock;
+            emit(TRACE_T_INSTANT, TRACE_SYNC, mhz);
+        }
+        emit(TRACE_T_INSTANT, TRACE_POWER, profile | servo << 3 | muted << 4 | contrast << 8);
+    }
+
+    void flush(int bytes, int lit){
+        emit(TRACE_T_BEGIN, TRACE_FLUSH, lit);
+        wait(bytes*9*2.5 + 200); //400 kHz
+        emit(TRACE_T_END, TRACE_FLUSH, bytes);
+    }
+
+    void frame(int work_ms, int frame_ms){
+        wait(work_ms*1000.0);
+        int sleep = frame_ms > work_ms ? frame_ms - work_ms : 0;
+        emit(TRACE_T_INSTANT, TRACE_PACE, sleep);
+        wait(sleep*1000.0);
+    }
+
+    //Arm to a new target: writes every 20 ms while it travels
+    void arm(int deg){
+        emit(TRACE_T_INSTANT, TRACE_ARM, deg);
+        for(int i=0; i<10; i++){
+            emit(TRACE_T_INSTANT, TRACE_SERVO, deg);
+            frame(2, 20);
+        }
+    }
+};
+
+std::vector<uint8_t> synthetic(){
+    Synth s;
+    s.emit(TRACE_T_INSTANT, TRACE_SYNC, s.mhz);
+
+    //Idle face: 2 min in "ui", 8 min in "idle" (dim, 50 ms frames), a blink every 4 s
+    s.power(1, 80, true, false, 0xCF);
+    s.emit(TRACE_T_INSTANT, TRACE_MODE_SET, PERF_MODE_IDLE);
+    for(int f=0; f<2*60*50; f++){
+        if(f % 200 == 0)
+            s.flush(260, 1400);
+        s.frame(2, 20);
+    }
+    s.power(2, 80, true, false, 0x60);
+    for(int f=0; f<8*60*20; f++){
+        if(f % 80 == 0)
+            s.flush(260, 1400);
+        s.frame(2, 50);
+    }
+
+    //Pong: 5 min at 160 MHz, every frame sent, a bounce tone every 2 s
+    s.power(0, 160, true, false, 0xCF);
+    s.emit(TRACE_T_INSTANT, TRACE_MODE_SET, PERF_MODE_PONG);
+    for(int f=0; f<5*60*50; f++){
+        s.flush(70, 600);
+        if(f % 100 == 0)
+            s.emit(TRACE_T_INSTANT, TRACE_TONE, 30);
+        s.frame(6, 20);
+    }
+
+    //Timer: 5 min, digits every second, the arm points every minute with a beep
+    s.power(1, 80, true, false, 0xCF);
+    s.emit(TRACE_T_INSTANT, TRACE_MODE_SET, PERF_MODE_TIMER);
+    for(int f=0; f<5*60*50; f++){
+        if(f % 50 == 0)
+            s.flush(180, 900);
+        if(f % 3000 == 0){
+            s.emit(TRACE_T_BEGIN, TRACE_BEEP, 2000);
+            s.wait(100000);
+            s.emit(TRACE_T_END, TRACE_BEEP, 0);
+            s.arm(f % 6000 == 0 ? 6 : 103);
+        }
+        s.frame(2, 20);
+    }
+    return s.data;
+}
+
+struct StdOut{
+    void print(const char* s){
+        fputs(s, stdout);
+    }
+};
+
+int main(int argc, char** argv){
+    const char* path = NULL;
+    Replay replay;
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--cost") == 0 && i+1 < argc){
+            char name[32];
+            float value;
+            float* cost = NULL;
+            if(sscanf(argv[++i], "%31[^=]=%f", name, &value) == 2)
+                cost = replay.meter.cost.find(name);
+            if(cost == NULL){
+                fprintf(stderr, "bad cost: %s\n", argv[i]);
+                return 1;
+            }
+            *cost = value;
+        }
+        else
+            path = argv[i];
+    }
+
+    std::vector<TraceEvent> events = frames(path ? readFile(path) : synthetic());
+    printf("%s, %zu events\n", path ? path : "synthetic session", events.size());
+    replay.run(events);
+    StdOut out;
+    replay.meter.report(out);
+    return 0;
+}
@@ -0,0 +1,71 @@
+//Face preset check, drawn faces against the stored bitmaps
+//
+//Draws every FACE_PRESETS entry of src/face_draw.h with the span renderer the
+//firmware uses and compares it pixel by pixel with the bitmap of the same face in
+//src/faces.h. Prints the differing pixels as a share of the lit ones in the bitmap
+//and exits 1 if a face is off by more than MAX_DIFF_PCT, or if the renderer lights
+//a pixel outside box() (FaceAnimator only flushes that box). With -v it prints both
+//faces side by side ('#' both, 'b' bitmap only, 'p' preset only).
+//
+//Build: g++ -O2 -std=c++17 -I src tools/face_check.cpp -o face_check
+//Usage: ./face_check [-v]
+
+#include <face_draw.h>
+#include <faces.h>
+
+#include <cstdio>
+#include <cstring>
+
+#define MAX_DIFF_PCT 10.0
+
+static_assert(Layout::FACE_Y == 0, "the check runs on the 128x64 layout");
+
+bool bitmap_px(const unsigned char* bmp, int x, int y){
+    return bmp[y*(Layout::FACE_W/8) + x/8] & (0x80 >> (x & 7)); //drawBitmap order, MSB first
+}
+
+bool buffer_px(const uint8_t* buf, int x, int y){
+    return buf[(y/8)*Layout::W + x] & (1 << (y & 7));
+}
+
+int main(int argc, char** argv){
+    bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+    const char* names[BUILTIN_FACES] = {"IDLE", "LOOK_LEFT", "LOOK_RIGHT", "HAPPY", "ANGRY", "SAD"};
+    bool ok = N_FACES == BUILTIN_FACES && int(sizeof(FACE_PRESETS)/sizeof(FACE_PRESETS[0])) == N_FACES;
+    if(!ok)
+        printf("%d bitmaps, %d presets, %d face ids\n", N_FACES, int(sizeof(FACE_PRESETS)/sizeof(FACE_PRESETS[0])),
+            BUILTIN_FACES);
+
+    FaceRenderer renderer;
+    static uint8_t buf[Layout::W*Layout::H/8];
+    for(int i=0; ok && i<N_FACES; i++){
+        memset(buf, 0, sizeof(buf));
+        renderer.draw(FACE_PRESETS[i], buf);
+        int box[4];
+        renderer.box(FACE_PRESETS[i], box);
+
+        int lit = 0, diff = 0, outside = 0;
+        for(int y=0; y<Layout::FACE_H; y++){
+            for(int x=0; x<Layout::FACE_W; x++){
+                bool b = bitmap_px(Faces[i], x, y), p = buffer_px(buf, x, y);
+                lit += b;
+                diff += b != p;
+                outside += p && (x < box[0] || y < box[1] || x >= box[0] + box[2] || y >= box[1] + box[3]);
+                if(verbose)
+                    putchar(b && p ? '#' : (b ? 'b' : (p ? 'p' : '.')));
+            }
+            if(verbose)
+                putchar('\n');
+        }
+
+        double pct = lit ? 100.0*diff/lit : 100;
+        bool face_ok = pct <= MAX_DIFF_PCT && outside == 0;
+        printf("%-10s %4d lit, %4d differ (%.1f%%)%s%s\n", names[i], lit, diff, pct,
+            outside ? ", pixels outside box()" : "", face_ok ? "" : "  FAIL");
+        ok = ok && face_ok;
+    }
+    if(!ok)
+        return 1;
+    printf("all presets within %.0f%% of the bitmaps\n", MAX_DIFF_PCT);
+    return 0;
+}
@@ -0,0 +1,146 @@
+//Text rendering benchmark, pre-rasterized font against GFX
+//
+//Draws the same strings with the pre-rendered font (src/text.h) and with the
+//Adafruit GFX classic font path (drawChar: one drawPixel per pixel at size 1,
+//one fillRect per pixel at size 2), checks both give the same pixels and
+//prints the time per string.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/font_bench.cpp -o font_bench
+//Usage: ./font_bench [iterations]
+
+#include <text.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define W 128
+#define H 64
+
+//Same call pattern as Adafruit GFX: virtual drawPixel, fillRect as vertical lines
+struct GfxModel{
+    uint8_t* buf;
+
+    virtual ~GfxModel(){}
+
+    virtual void drawPixel(int x, int y){
+        if(x < 0 || y < 0 || x >= W || y >= H)
+            return;
+        buf[x + (y/8)*W] |= 1 << (y & 7);
+    }
+
+    void drawFastVLine(int x, int y, int h){
+        for(int j=0; j<h; j++)
+            drawPixel(x, y + j);
+    }
+
+    void fillRect(int x, int y, int w, int h){
+        for(int i=x; i<x+w; i++)
+            drawFastVLine(i, y, h);
+    }
+
+    void drawChar(int x, int y, uint8_t c, int sz){
+        const uint8_t* g = FONT_SMALL + Text::glyph(c)*FONT_W;
+        for(int i=0; i<FONT_W; i++){
+            uint8_t line = g[i];
+            for(int j=0; j<8; j++, line >>= 1){
+                if(!(line & 1))
+                    continue;
+                if(sz == 1)
+                    drawPixel(x + i, y + j);
+                else
+                    fillRect(x + i*sz, y + j*sz, sz, sz);
+            }
+        }
+    }
+
+    void print(const char* s, int x, int y, int sz){
+        for(uint8_t c = Text::next(s); c != 0; c = Text::next(s)){
+            if(x + 6*sz > W){
+                x = 0;
+                y += 8*sz;
+            }
+            drawChar(x, y, c, sz);
+            x += 6*sz;
+        }
+    }
+};
+
+struct Case{
+    const char* name;
+    const char* text;
+    int x, y, sz;
+};
+
+//What the bot actually draws
+const Case CASES[] = {
+    {"printClock", "12:34", 35, 26, 2},
+    {"loading_screen", "100%", 41, 26, 2},
+    {"header", "Ajustar tiempo", 22, 0, 1},
+    {"printCentered", "Con cariño", 34, 26, 1},
+    {"menu line", "-> Feliz cumple", 0, 16, 1},
+};
+
+template<class F>
+double time_ns(long iters, F f){
+    auto t0 = std::chrono::steady_clock::now();
+    for(long i=0; i<iters; i++)
+        f();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count()/iters;
+}
+
+int main(int argc, char** argv){
+    long iters = argc > 1 ? atol(argv[1]) : 200000;
+
+    static uint8_t a[W*H/8], b[W*H/8];
+    Blitter blit;
+    blit.init(a, W, H);
+    Text text;
+    text.init(blit);
+    GfxModel *gfx = new GfxModel();
+    gfx->buf = b;
+
+    int bad = 0;
+    printf("%-16s %-18s %4s %10s %10s %8s\n", "case", "text", "size", "gfx_ns", "cache_ns", "speedup");
+    for(const Case &c : CASES){
+        memset(a, 0, sizeof(a));
+        memset(b, 0, sizeof(b));
+        int x = c.x, y = c.y;
+        text.draw(c.text, x, y, c.sz);
+        gfx->print(c.text, c.x, c.y, c.sz);
+        if(memcmp(a, b, sizeof(a)) != 0){
+            printf("%s: pixels differ\n", c.name);
+            bad++;
+        }
+
+        double g = time_ns(iters, [&](){ gfx->print(c.text, c.x, c.y, c.sz); });
+        double t = time_ns(iters, [&](){ int x = c.x, y = c.y; text.draw(c.text, x, y, c.sz); });
+        printf("%-16s %-18s %4d %10.1f %10.1f %7.1fx\n", c.name, c.text, c.sz, g, t, g/t);
+    }
+
+    //Every glyph at every vertical offset
+    for(int g=0; g<FONT_N_GLYPHS; g++)
+        for(int sz=1; sz<=2; sz++)
+            for(int y=-16; y<H; y++){
+                uint8_t code = g <= FONT_LAST - FONT_FIRST ? FONT_FIRST + g : FONT_LATIN1[g - (FONT_LAST - FONT_FIRST + 1)];
+                char s[3] = {0};
+                if(code < 0x80)
+                    s[0] = code;
+                else{
+                    s[0] = 0xC0 | (code >> 6);
+                    s[1] = 0x80 | (code & 0x3F);
+                }
+                memset(a, 0, sizeof(a));
+                memset(b, 0, sizeof(b));
+                int x = 61, yy = y;
+                text.draw(s, x, yy, sz);
+                gfx->print(s, 61, y, sz);
+                if(memcmp(a, b, sizeof(a)) != 0)
+                    bad++;
+            }
+
+    printf("%s\n", bad ? "MISMATCH" : "pixels identical");
+    delete gfx;
+    return bad ? 1 : 0;
+}
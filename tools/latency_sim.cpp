@@ -0,0 +1,314 @@
+//Input to photon latency simulator
+//
+//Runs the loop() timing of the bot on a virtual clock: inputs arrive at random
+//times, are picked up at the start of the next loop, the frame is drawn with the
+//real blitter/text/PageSync code (Pong with PongRenderer) and sent over a modeled
+//I2C bus, then delay(20).
+//The same LatencyProbe the firmware uses (src/latency.h) measures every input,
+//so the numbers can be compared with "lat" on the serial console.
+//
+//Scenarios: menu navigation (turns and clicks), Pong paddle, timer adjust. Each
+//one runs with the old full-frame display() at 100 kHz and with dirty flushes at
+//100 and 400 kHz.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/latency_sim.cpp -o latency_sim
+//Usage: ./latency_sim [seconds_per_scenario] [seed]
+
+#include <latency.h>
+#include <page_sync.h>
+#include <blit.h>
+#include <text.h>
+#include <pong.h>
+#include <pong_render.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define W 128
+#define H 64
+#define PAGES (H/8)
+
+//Firmware timing (main.cpp / objects.h)
+#define LOOP_DELAY_US 20000  //delay(20) at the end of loop()
+#define LOOP_WORK_US 1500    //ADC, drawing, logic
+#define DEBOUNCE_US 50000    //Encoder::isPressed
+#define ACTION_BEEP_US 100000
+#define MENU_LINE_H 16
+#define MENU_SCROLL_STEP 4
+#define I2C_CHUNK 64
+
+//Bus model: 9 clocks per byte (8 + ack), plus address, start/stop and driver time per transaction
+#define I2C_TXN_US 60
+
+struct Config{
+    const char* name;
+    long clock;
+    bool full_frames; //Everything goes out every frame, like display.display()
+};
+
+const Config CONFIGS[] = {
+    {"display() 100kHz", 100000, true},
+    {"dirty 100kHz", 100000, false},
+    {"dirty 400kHz", 400000, false},
+};
+
+uint8_t buf[W*PAGES];
+Blitter blit;
+Text text;
+PageSync sync;
+LatencyProbe probe;
+const Config* cfg;
+double now; //us
+
+//Counts what WireBus would send and advances the clock by the modeled time
+struct ModelBus{
+    long bytes = 0;
+    long txns = 0;
+
+    void command(const uint8_t*, int n){
+        bytes += n + 1;
+        txns++;
+    }
+
+    void data(const uint8_t*, int n){
+        for(int x=0; x<n; x+=I2C_CHUNK){
+            int len = n - x < I2C_CHUNK ? n - x : I2C_CHUNK;
+            bytes += len + 1;
+            txns++;
+        }
+    }
+};
+
+void flush(){
+    if(cfg->full_frames)
+        sync.markAll();
+    ModelBus bus;
+    sync.flush(bus);
+    now += bus.txns*I2C_TXN_US + (bus.bytes + bus.txns)*9*1e6/cfg->clock;
+    probe.flushed(uint32_t(now), bus.bytes);
+}
+
+uint32_t rng = 12345;
+int rnd(int n){
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % n;
+}
+
+//Next random instant between a and b ms from now
+double after(int a, int b){
+    return now + (a + rnd(b - a + 1))*1000.0;
+}
+
+void endLoop(){
+    now += LOOP_DELAY_US;
+}
+
+//Menu: encoder turns every 150-600 ms, sometimes a click (beep, then the next screen)
+const char* OPTIONS[] = {"Volver", "Feliz cumple", "Timer", "Pong", "Gambling", "APAGAR"};
+#define N_OPTIONS 6
+
+void drawMenu(int offset){
+    for(int i=0; i<N_OPTIONS; i++){
+        int y = i*MENU_LINE_H - offset;
+        if(y <= -8 || y >= H)
+            continue;
+        int x = 18;
+        text.draw(OPTIONS[i], x, y);
+    }
+    int x = 0, y = 0;
+    text.draw("->", x, y);
+    sync.markDirty(0, 0, 18, 8);
+}
+
+void menuScenario(double seconds){
+    memset(buf, 0, sizeof(buf));
+    drawMenu(0);
+    sync.markAll();
+    flush();
+
+    int current = 0, offset = 0;
+    double next_turn = after(150, 600), next_click = after(2000, 5000);
+    double turned_at = -1, last_check = 0;
+    bool button_down = false, last_state = false;
+    double release = 0;
+    double end = now + seconds*1e6;
+
+    while(now < end){
+        //ISR side: turns that happened since the last loop, the probe gets the last ISR time
+        int p = 0;
+        while(next_turn <= now){
+            p = rnd(4) ? (current < N_OPTIONS-1 ? 1 : -1) : (current > 0 ? -1 : 1);
+            turned_at = next_turn;
+            next_turn = after(150, 600);
+        }
+        if(next_click <= now && !button_down){
+            button_down = true;
+            release = next_click + 150000;
+            next_click = after(2000, 5000);
+        }
+        if(button_down && now > release)
+            button_down = false;
+
+        now += LOOP_WORK_US;
+        if(p != 0){
+            current = current + p < 0 ? 0 : (current + p >= N_OPTIONS ? N_OPTIONS-1 : current + p);
+            probe.input(LAT_MENU, uint32_t(turned_at));
+        }
+
+        //isPressed(): samples the pin at most every 50 ms, beeps before returning
+        bool clicked = false;
+        if(now - last_check > DEBOUNCE_US){
+            last_check = now;
+            clicked = button_down && !last_state;
+            last_state = button_down;
+        }
+        if(clicked){
+            probe.input(LAT_MENU, uint32_t(now));
+            now += ACTION_BEEP_US;
+            //Next screen, then straight back to the menu
+            memset(buf, 0, sizeof(buf));
+            int x = 40, y = 28;
+            text.draw("PONG", x, y);
+            sync.markAll();
+            flush();
+            memset(buf, 0, sizeof(buf));
+            drawMenu(offset);
+            sync.markAll();
+            flush();
+            endLoop();
+            continue;
+        }
+
+        //Menu::show(): hardware scroll a few rows per frame towards the current option
+        int target = current*MENU_LINE_H;
+        if(offset != target){
+            int d = target - offset;
+            d = d > MENU_SCROLL_STEP ? MENU_SCROLL_STEP : (d < -MENU_SCROLL_STEP ? -MENU_SCROLL_STEP : d);
+            if(cfg->full_frames){
+                offset = target; //The old menu redrew the whole list at once
+                memset(buf, 0, sizeof(buf));
+                drawMenu(offset);
+            }
+            else{
+                blit.shiftRows(d);
+                sync.scrolled(d);
+                offset += d;
+                blit.fill(0, -d, 18, 8, ROP_CLEAR);
+                sync.markDirty(0, -d, 18, 8);
+                drawMenu(offset);
+            }
+            flush();
+        }
+        endLoop();
+    }
+}
+
+//Pong: the hand moves the potentiometer in strokes, the paddle follows every loop.
+//The match is PongPhysics on PongClock, drawn by PongRenderer like playing_loop()
+void pongScenario(double seconds){
+    PongPhysics pong;
+    pong.init(W, H, rng);
+    pong.set_difficulty(3);
+    pong.start();
+    PongClock clock;
+    clock.reset((unsigned long)(now/1000));
+    PongRenderer renderer;
+    renderer.init(blit, text, sync);
+    int l_score = 0, r_score = 0;
+
+    int paddle = FROM_FP(pong.l_pos), target = paddle;
+    double next_stroke = after(100, 800);
+    double end = now + seconds*1e6;
+
+    while(now < end){
+        if(next_stroke <= now){
+            target = rnd(H - pong.paddle_high);
+            next_stroke = after(100, 800);
+        }
+        //The hand moves up to 6 rows per loop
+        int last_paddle = paddle;
+        paddle += target > paddle ? (target - paddle > 6 ? 6 : target - paddle) : -(paddle - target > 6 ? 6 : paddle - target);
+
+        now += LOOP_WORK_US;
+        if(paddle != last_paddle)
+            probe.input(LAT_PONG, uint32_t(now));
+
+        pong.set_left(paddle);
+        int steps = clock.advance((unsigned long)(now/1000));
+        for(int i=0; i<steps; i++){
+            uint8_t ev = pong.step();
+            l_score = (l_score + ((ev & PONG_LEFT_SCORES) != 0)) % 10;
+            r_score = (r_score + ((ev & PONG_RIGHT_SCORES) != 0)) % 10;
+        }
+
+        fixed t = clock.alpha();
+        renderer.draw(pong.render_x(t), pong.render_y(t), FROM_FP(pong.l_pos), FROM_FP(pong.r_pos),
+                      pong.paddle_width, pong.paddle_high, l_score, r_score);
+        flush();
+        endLoop();
+    }
+}
+
+//Timer: each turn adds a step, printClock() redraws and sends the whole screen
+void timerScenario(double seconds){
+    int t = 0;
+    double next_turn = after(80, 400), turned_at = 0;
+    double end = now + seconds*1e6;
+
+    while(now < end){
+        int p = 0;
+        while(next_turn <= now){
+            p = 1;
+            turned_at = next_turn;
+            next_turn = after(80, 400);
+        }
+        now += LOOP_WORK_US;
+        if(p != 0){
+            t += 30;
+            probe.input(LAT_TIMER, uint32_t(turned_at));
+        }
+
+        memset(buf, 0, sizeof(buf));
+        int x = 30, y = 0;
+        text.draw("Ajustar tiempo", x, y);
+        blit.fill(0, 10, W, 1, ROP_SET);
+        char clock[8];
+        snprintf(clock, sizeof(clock), "%02d:%02d", t/60 % 100, t % 60);
+        x = 34, y = 26;
+        text.draw(clock, x, y, 2);
+        sync.markAll();
+        flush();
+        endLoop();
+    }
+}
+
+int main(int argc, char** argv){
+    double seconds = argc > 1 ? atof(argv[1]) : 120;
+    uint32_t seed = argc > 2 ? (uint32_t)atol(argv[2]) : 12345;
+
+    blit.init(buf, W, H);
+    text.init(blit);
+
+    printf("class count avg p50 p90 max (ms) | histogram (%d ms buckets)\n", LAT_BUCKET_US/1000);
+    for(const Config &c : CONFIGS){
+        cfg = &c;
+        rng = seed ? seed : 1;
+        now = 0;
+        sync.init(buf, W, H);
+        probe.reset();
+        menuScenario(seconds);
+        pongScenario(seconds);
+        timerScenario(seconds);
+
+        printf("== %s\n", c.name);
+        for(int i=0; i<LAT_N; i++){
+            const char* line = probe.line(i);
+            if(line != NULL)
+                printf("%s\n", line);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,542 @@
+//Screen mirror without the bot, also a stand-in for it in front of oled_viewer.py
+//
+//Plays Pong with src/pong.h, draws every frame into a page buffer like the bot does
+//(50 frames/s) and codes it with the MirrorEncoder of src/mirror.h behind a modeled
+//115200 baud UART: 2 KB TX buffer drained at 11.52 bytes/ms, a frame only goes out
+//when it fits, like Mirror::frame(). Prints bytes per frame, link use and deferred
+//frames. It can also stand in for the bot in front of tools/oled_viewer.py:
+//  ./mirror_sim                    stats only
+//  ./mirror_sim --out pong.bin     the stream to a file (python3 tools/oled_viewer.py pong.bin)
+//  ./mirror_sim --pty              a pseudo terminal in real time, starts on "mirror on"
+//  --height 32                     SSD1306 128x32 geometry
+//  --seconds N                     length of the run (default 60)
+//  --script file                   console commands, "-" = stdin
+//
+//Commands use the language of the serial console (src/script.h), from --script and
+//from the pseudo terminal: mirror, rotate, click, pot, mode, bench and wait. The modes
+//are stand-ins: idle, its menu (click), pong (pot moves the left paddle, otherwise it
+//follows the ball) and the others as their name. bench times menu, flush and the face
+//bitmap in ns of the PC; face, melody and the face model are on the bot only.
+//  echo "mode idle; click; rotate 4; wait 500; click; pot 10; wait 3000; bench all" > demo.txt
+//  ./mirror_sim --script demo.txt --seconds 10 --out demo.bin
+//
+//Build: g++ -O2 -std=c++17 -I src tools/mirror_sim.cpp -o mirror_sim
+
+#include <mirror.h>
+#include <pong.h>
+#include <pong_render.h>
+#include <blit.h>
+#include <text.h>
+#include <script.h>
+#include <bench.h>
+#include <page_sync.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#define W 128
+#define FRAME_MS PONG_STEP_MS
+
+//Serial port of the bot (main.cpp / mirror.h)
+#define BAUD 115200
+#define TX_BUFFER 2048 //MIRROR_TX_BUFFER
+#define BYTES_PER_MS (BAUD/10/1000.0)
+
+//Modes of main.cpp, by the names "mode" takes
+#define N_MODES 9
+const char* const MODE_NAMES[N_MODES] = {"idle", "bday", "timer", "stats", "pong", "gambling", "battery", "lowbat", "off"};
+#define MODE_IDLE 0
+#define MODE_PONG 4
+#define MODE_LOW_BATTERY 7
+#define MODE_OFF 8
+
+//Idle menu of main.cpp
+#define N_OPTIONS 7
+const char* const OPTIONS[N_OPTIONS] = {"Volver", "Feliz cumple", "Timer", "Estudio", "Pong", "Gambling", "APAGAR"};
+const int OPTION_MODES[N_OPTIONS] = {MODE_IDLE, 1, 2, 3, MODE_PONG, 5, MODE_OFF};
+
+//Potentiometer of objects.h
+#define MIN_POT_POS 0
+#define MAX_POT_POS 26
+
+struct Uart{
+    double queued = 0;
+
+    void wait(int ms){
+        queued -= ms*BYTES_PER_MS;
+        if(queued < 0)
+            queued = 0;
+    }
+
+    int availableForWrite(){
+        return TX_BUFFER - int(queued + 0.999);
+    }
+};
+
+//A pseudo terminal that plays the bot: the viewer opens the other end
+struct Pty{
+    int fd = -1;
+
+    bool open(){
+        fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if(fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+            return false;
+        //Raw, so frames are not touched by the line discipline
+        int slave = ::open(ptsname(fd), O_RDWR | O_NOCTTY);
+        termios t;
+        tcgetattr(slave, &t);
+        cfmakeraw(&t);
+        tcsetattr(slave, TCSANOW, &t);
+        close(slave);
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        printf("bot on %s, waiting for \"mirror on\"\n", ptsname(fd));
+        fflush(stdout);
+        return true;
+    }
+
+    //What the viewer sent, as much as the console takes
+    void poll(ScriptReader &reader){
+        char c;
+        while(reader.room() > 0 && read(fd, &c, 1) == 1)
+            reader.push(c);
+    }
+
+    void write(const uint8_t* buf, int n){
+        while(n > 0){
+            ssize_t k = ::write(fd, buf, n);
+            if(k > 0){
+                buf += k;
+                n -= k;
+            }
+            else
+                usleep(1000); //Nobody reading yet
+        }
+    }
+};
+
+struct Game{
+    int height;
+    uint8_t buf[W*MIRROR_MAX_PAGES];
+    Blitter blit;
+    Text text;
+    PageSync sync;
+    PongPhysics pong;
+    PongRenderer renderer;
+    int l_score = 0, r_score = 0;
+
+    int mode = MODE_PONG;
+    bool on_menu = false;
+    int current = 0;
+
+    //Console input, taken one step per frame like Encoder does
+    int steps = 0;
+    bool click = false;
+    int pot = -1; //0 - 100, -1 = the player follows the ball
+
+    Game(int height) : height(height){
+        blit.init(buf, W, height);
+        text.init(blit);
+        sync.init(buf, W, height);
+        renderer.init(blit, text, sync);
+        enter(MODE_PONG);
+    }
+
+    void enter(int m){
+        mode = m;
+        on_menu = false;
+        current = 0;
+        if(m == MODE_PONG){
+            pong.init(W, height, 7);
+            pong.set_difficulty(3);
+            pong.start();
+            l_score = r_score = 0;
+        }
+    }
+
+    void step(){
+        int r = steps > 0 ? 1 : (steps < 0 ? -1 : 0);
+        steps -= r;
+        bool pressed = click;
+        click = false;
+
+        if(on_menu){
+            current += r;
+            current = current < 0 ? 0 : (current >= N_OPTIONS ? N_OPTIONS-1 : current);
+            if(pressed)
+                enter(OPTION_MODES[current]);
+            return;
+        }
+        if(pressed){
+            if(mode == MODE_IDLE)
+                on_menu = true;
+            else
+                enter(MODE_IDLE);
+            return;
+        }
+        if(mode == MODE_PONG)
+            stepPong();
+    }
+
+    //The pot like gameMode maps it, the player follows the ball a bit late
+    void stepPong(){
+        int pos;
+        if(pot >= 0)
+            pos = (MAX_POT_POS - pot)*(height - pong.paddle_high)/(MAX_POT_POS - MIN_POT_POS);
+        else{
+            int target = FROM_FP(pong.ball.y) - pong.paddle_high/2;
+            pos = FROM_FP(pong.l_pos);
+            pos += target > pos + 2 ? 2 : (target < pos - 2 ? -2 : 0);
+        }
+        pos = pos < 0 ? 0 : (pos > height - pong.paddle_high ? height - pong.paddle_high : pos);
+        pong.set_left(pos);
+        uint8_t events = pong.step();
+        l_score += (events & PONG_LEFT_SCORES) != 0;
+        r_score += (events & PONG_RIGHT_SCORES) != 0;
+    }
+
+    void draw(){
+        memset(buf, 0, sizeof(buf));
+        if(on_menu){
+            drawList(current*menuLine());
+            drawMarkers();
+        }
+        else if(mode == MODE_PONG)
+            drawPong();
+        else if(mode != MODE_OFF)
+            drawCentered(mode == MODE_IDLE ? "Hola :D" : MODE_NAMES[mode]);
+    }
+
+    //Layout::MENU_LINE_H
+    int menuLine(){
+        return height/4;
+    }
+
+    void drawList(int offset){
+        for(int i=0; i<N_OPTIONS; i++){
+            int x = 3*FONT_ADVANCE, y = i*menuLine() - offset;
+            if(y > -8 && y < height)
+                text.draw(OPTIONS[i], x, y);
+        }
+    }
+
+    void drawMarkers(){
+        int x = 0, y = 0;
+        text.draw("->", x, y);
+    }
+
+    void drawCentered(const char* s){
+        int x = (W - int(strlen(s))*FONT_ADVANCE)/2, y = height*13/32;
+        text.draw(s, x, y);
+    }
+
+    //PongRenderer redrawn from scratch, the mirror sends whole frames anyway
+    void drawPong(){
+        renderer.reset();
+        renderer.draw(pong.render_x(FP_ONE), pong.render_y(FP_ONE), FROM_FP(pong.l_pos), FROM_FP(pong.r_pos),
+                      pong.paddle_width, pong.paddle_high, l_score % 100, r_score % 100);
+        sync.clean();
+    }
+};
+
+//What the commands act on
+static Game* game;
+static MirrorEncoder enc;
+static bool on = false;
+
+struct StdOut{
+    void print(const char* s){
+        fputs(s, stdout);
+    }
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static uint32_t nsSince(Clock::time_point start){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+void cmdMirror(const char* args){
+    if(strcmp(args, "on") == 0){
+        on = true;
+        enc.key();
+        printf("ok\n");
+    }
+    else if(strcmp(args, "off") == 0){
+        on = false;
+        printf("ok\n");
+    }
+    else if(strcmp(args, "key") == 0){
+        enc.key();
+        printf("ok\n");
+    }
+    else
+        printf("%s, %u frames (%u key, %u deferred), %u bytes for %u raw\n", on ? "on" : "off", (unsigned)enc.frames,
+            (unsigned)enc.keys, (unsigned)enc.deferred, (unsigned)enc.bytes, (unsigned)enc.raw);
+}
+
+void cmdRotate(const char* args){
+    int steps = atoi(args);
+    game->steps += steps != 0 ? steps : 1;
+}
+
+void cmdClick(const char*){
+    game->click = true;
+}
+
+void cmdPot(const char* args){
+    if(strcmp(args, "off") == 0)
+        game->pot = -1;
+    else if(*args != 0)
+        game->pot = std::min(std::max(atoi(args), 0), 100);
+    if(game->pot >= 0)
+        printf("%d (forced)\n", game->pot);
+    else
+        printf("auto\n");
+}
+
+void cmdMode(const char* args){
+    for(int i=0; i<N_MODES; i++)
+        if(i != MODE_LOW_BATTERY && strcmp(args, MODE_NAMES[i]) == 0){
+            game->enter(i);
+            printf("ok\n");
+            return;
+        }
+    printf("%s\n", MODE_NAMES[game->mode]);
+}
+
+void cmdDeviceOnly(const char*){
+    printf("on the bot only\n");
+}
+
+//Counts what PageSync::flush() would put on the I2C bus
+struct CountBus{
+    long bytes = 0;
+
+    void command(const uint8_t*, int n){
+        bytes += n + 1;
+    }
+
+    void data(const uint8_t*, int n){
+        bytes += n + 1;
+    }
+};
+
+void benchMenu(StdOut &out, int n){
+    BenchStat list, markers;
+    for(int k=0; k<n; k++){
+        memset(game->buf, 0, sizeof(game->buf));
+        Clock::time_point start = Clock::now();
+        game->drawList((k % N_OPTIONS)*game->menuLine());
+        list.add(nsSince(start));
+        start = Clock::now();
+        game->drawMarkers();
+        markers.add(nsSince(start));
+    }
+    list.print(out, "menu list", "ns", 0);
+    markers.print(out, "menu markers", "ns", 0);
+}
+
+void benchFlush(StdOut &out, int n){
+    PageSync sync;
+    sync.init(game->buf, W, game->height, 64, game->height == 32 ? 0 : SH1106_COL_OFFSET);
+    MirrorEncoder mirror;
+    mirror.init(W, game->height);
+    CountBus bus;
+    BenchStat full, small, coded;
+    long full_bytes = 0, small_bytes = 0;
+    for(int k=0; k<n; k++){
+        Clock::time_point start = Clock::now();
+        sync.markAll();
+        sync.flush(bus);
+        full.add(nsSince(start));
+        full_bytes = bus.bytes;
+        bus.bytes = 0;
+
+        //A blinking 8x8 corner, like a cursor or a clock digit
+        game->blit.fill(W-8, 0, 8, 8, ROP_XOR);
+        start = Clock::now();
+        sync.markDirty(W-8, 0, 8, 8);
+        sync.flush(bus);
+        small.add(nsSince(start));
+        small_bytes = bus.bytes;
+        bus.bytes = 0;
+
+        start = Clock::now();
+        int len = mirror.encode(game->buf, k);
+        mirror.sent(game->buf, len);
+        coded.add(nsSince(start));
+    }
+    full.print(out, "flush full", "ns", 0);
+    small.print(out, "flush 8x8", "ns", 0);
+    coded.print(out, "mirror frame", "ns", 0);
+    printf("i2c bytes: full %ld, 8x8 %ld\n", full_bytes, small_bytes);
+}
+
+//The art is not on the PC, same size and path as Screen::showFace()
+void benchFace(StdOut &out, int n){
+    static uint8_t art[128*64/8];
+    uint32_t x = 12345;
+    for(uint8_t &b : art){
+        x = x*1103515245 + 12345;
+        b = x >> 24;
+    }
+    BenchStat bitmap;
+    int y = (game->height - 64)/2;
+    for(int k=0; k<n; k++){
+        Clock::time_point start = Clock::now();
+        game->blit.rowBitmap(0, y < 0 ? 0 : y, art, 128, game->height < 64 ? game->height : 64, ROP_SET);
+        bitmap.add(nsSince(start));
+    }
+    bitmap.print(out, "face bitmap", "ns", 0);
+    printf("face model is on the bot only\n");
+}
+
+void cmdBench(const char* args){
+    char what[8] = "";
+    int n = 20;
+    sscanf(args, "%7s %d", what, &n);
+    n = std::min(std::max(n, 1), 100000);
+    bool all = strcmp(what, "all") == 0;
+    StdOut out;
+    bool ran = false;
+    if(all || strcmp(what, "face") == 0){
+        benchFace(out, n);
+        ran = true;
+    }
+    if(all || strcmp(what, "menu") == 0){
+        benchMenu(out, n);
+        ran = true;
+    }
+    if(all || strcmp(what, "flush") == 0){
+        benchFlush(out, n);
+        ran = true;
+    }
+    if(all || strcmp(what, "melody") == 0){
+        cmdDeviceOnly(args);
+        ran = true;
+    }
+    if(!ran)
+        printf("? bench face|menu|flush|melody|all [n]\n");
+    fflush(stdout);
+}
+
+int main(int argc, char** argv){
+    const char* out_path = NULL;
+    const char* script_path = NULL;
+    bool pty_mode = false;
+    int height = 64, seconds = 60;
+    for(int i=1; i<argc; i++){
+        if(strcmp(argv[i], "--out") == 0 && i+1 < argc)
+            out_path = argv[++i];
+        else if(strcmp(argv[i], "--pty") == 0)
+            pty_mode = true;
+        else if(strcmp(argv[i], "--height") == 0 && i+1 < argc)
+            height = atoi(argv[++i]) == 32 ? 32 : 64;
+        else if(strcmp(argv[i], "--seconds") == 0 && i+1 < argc)
+            seconds = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--script") == 0 && i+1 < argc)
+            script_path = argv[++i];
+        else{
+            fprintf(stderr, "usage: %s [--out file] [--pty] [--height 64|32] [--seconds N] [--script file|-]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    FILE* out = NULL;
+    if(out_path != NULL && (out = fopen(out_path, "wb")) == NULL){
+        perror(out_path);
+        return 1;
+    }
+    Pty pty;
+    if(pty_mode && !pty.open()){
+        perror("pty");
+        return 1;
+    }
+    int script = -1;
+    if(script_path != NULL){
+        script = strcmp(script_path, "-") == 0 ? 0 : open(script_path, O_RDONLY);
+        if(script < 0){
+            perror(script_path);
+            return 1;
+        }
+        fcntl(script, F_SETFL, fcntl(script, F_GETFL) | O_NONBLOCK);
+    }
+
+    static ScriptReader reader;
+    reader.add("mirror", "", cmdMirror);
+    reader.add("rotate", "", cmdRotate);
+    reader.add("click", "", cmdClick);
+    reader.add("pot", "", cmdPot);
+    reader.add("mode", "", cmdMode);
+    reader.add("face", "", cmdDeviceOnly);
+    reader.add("melody", "", cmdDeviceOnly);
+    reader.add("bench", "", cmdBench);
+
+    static Game sim(height);
+    game = &sim;
+    enc.init(W, height);
+    Uart uart;
+    on = !pty_mode;
+    uint32_t peak = 0, rendered = 0;
+    unsigned long last_key = 0;
+
+    for(unsigned long ms=0; ms<(unsigned long)seconds*1000; ms+=FRAME_MS){
+        //Like Console::update(): what arrived, as much as fits, then one command
+        if(pty_mode)
+            pty.poll(reader);
+        char c;
+        while(script >= 0 && reader.room() > 0 && read(script, &c, 1) == 1)
+            reader.push(c);
+        int status = reader.poll(ms);
+        if(status == SCRIPT_HELP)
+            printf("mirror rotate click pot mode face melody bench wait\n");
+        else if(status == SCRIPT_UNKNOWN)
+            printf("? %s\n", reader.line);
+        else if(status == SCRIPT_TOO_LONG)
+            printf("? line too long\n");
+        fflush(stdout);
+
+        sim.step();
+        sim.draw();
+        rendered++;
+
+        if(on){
+            if(ms - last_key >= MIRROR_KEY_MS){
+                enc.key();
+                last_key = ms;
+            }
+            int n = enc.encode(sim.buf, ms);
+            if(n > 0 && uart.availableForWrite() < n)
+                enc.deferred++;
+            else if(n > 0){
+                uart.queued += n;
+                enc.sent(sim.buf, n);
+                peak = uint32_t(n) > peak ? n : peak;
+                if(out)
+                    fwrite(enc.out, 1, n, out);
+                if(pty_mode)
+                    pty.write(enc.out, n);
+            }
+        }
+        uart.wait(FRAME_MS);
+        if(pty_mode)
+            usleep(FRAME_MS*1000);
+    }
+    if(out)
+        fclose(out);
+
+    double link = seconds*1000*BYTES_PER_MS;
+    printf("128x%d, %d s: %u frames drawn, %u sent (%u key, %u deferred), %u commands\n", height, seconds,
+        (unsigned)rendered, (unsigned)enc.frames, (unsigned)enc.keys, (unsigned)enc.deferred, (unsigned)reader.ran);
+    printf("%.1f bytes/frame (peak %u), %.1fx smaller than the pages, %.0f%% of %d baud\n",
+        enc.frames ? double(enc.bytes)/enc.frames : 0, (unsigned)peak,
+        enc.bytes ? double(enc.raw)/enc.bytes : 0, 100*enc.bytes/link, BAUD);
+    printf("raw pages would be %.0f%% of the link\n", 100*double(rendered)*W*(height/8)/link);
+    return 0;
+}
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+#Rebuilds the screen from the mirror stream of the bot (see src/mirror.h, "mirror on" on
+#the serial console) and reports frames per second and link use. Live it can draw the
+#screen in the terminal; --png saves every frame for bug reports.
+#
+#Frame: 0xD7, flags (bit 0 key, bits 1-3 pages-1), seq, width, page mask, u16 ms,
+#u16 payload length, payload (XOR-RLE per page), xor of everything after 0xD7.
+#
+#Usage: python3 tools/oled_viewer.py --port /dev/ttyACM0 --show          (live, sends "mirror on")
+#       python3 tools/oled_viewer.py --port /dev/ttyACM0 --seconds 10 --png capturas/
+#       python3 tools/oled_viewer.py captura.bin --png capturas/
+#Without the bot: ./mirror_sim --pty prints a pseudo terminal to use as --port.
+
+import argparse
+import os
+import select
+import struct
+import sys
+import termios
+import time
+import tty
+import zlib
+
+FRAME_START = 0xD7
+HEADER = struct.Struct("<BBBBBHH") #Start to payload length
+KEY = 1
+
+
+def decode_page(payload, i, ref, width):
+    #XOR-RLE tokens until the page is covered, returns the new page and the next index
+    out = bytearray(ref)
+    x = 0
+    while x < width:
+        c = payload[i]
+        i += 1
+        if c < 0x80:
+            x += c + 1
+        elif c < 0xC0:
+            for k in range(c - 0x80 + 1):
+                out[x] ^= payload[i + k]
+                x += 1
+            i += c - 0x80 + 1
+        else:
+            v = payload[i]
+            i += 1
+            for k in range(c - 0xC0 + 3):
+                out[x] ^= v
+                x += 1
+    if x != width:
+        raise ValueError("page overrun")
+    return out, i
+
+
+class Decoder:
+    def __init__(self):
+        self.pages = None #Page buffers, None until a key frame
+        self.width = 0
+        self.seq = None
+        self.frames = self.keys = self.lost = self.bad = self.skipped = 0
+        self.bytes = 0
+        self.first_ms = self.last_ms = None
+        self.elapsed_ms = 0
+        self.buf = bytearray()
+
+    def feed(self, data):
+        #Complete frames in data (plus what was left), yields after each new frame
+        self.buf += data
+        b = self.buf
+        i = 0
+        while i + HEADER.size + 1 <= len(b):
+            if b[i] != FRAME_START:
+                i += 1
+                self.skipped += 1
+                continue
+            _, flags, seq, width, mask, ms, length = HEADER.unpack_from(b, i)
+            end = i + HEADER.size + length
+            if end + 1 > len(b):
+                if length > 8*(width + 3) + 16:
+                    i += 1 #Not a frame
+                    self.bad += 1
+                    continue
+                break
+            x = 0
+            for v in b[i+1:end]:
+                x ^= v
+            if x != b[end]:
+                i += 1
+                self.bad += 1
+                continue
+            if self.frame(flags, seq, width, mask, ms, bytes(b[i+HEADER.size:end])):
+                self.bytes += end + 1 - i
+                yield self
+            i = end + 1
+        del b[:i]
+
+    def frame(self, flags, seq, width, mask, ms, payload):
+        key = flags & KEY
+        n_pages = (flags >> 1 & 7) + 1
+        if self.seq is not None and seq != (self.seq + 1) & 0xFF:
+            self.lost += (seq - self.seq - 1) & 0xFF
+            if not key:
+                self.pages = None #A delta is missing, wait for the next key frame
+        self.seq = seq
+        if key:
+            self.pages = [bytearray(width) for _ in range(n_pages)]
+            self.width = width
+            self.keys += 1
+        elif self.pages is None or width != self.width or n_pages != len(self.pages):
+            return False
+
+        try:
+            i = 0
+            for p in range(n_pages):
+                if mask >> p & 1:
+                    self.pages[p], i = decode_page(payload, i, self.pages[p], width)
+        except (IndexError, ValueError):
+            self.pages = None
+            self.bad += 1
+            return False
+
+        if self.last_ms is not None:
+            self.elapsed_ms += (ms - self.last_ms) & 0xFFFF
+        else:
+            self.first_ms = ms
+        self.last_ms = ms
+        self.frames += 1
+        return True
+
+    def pixel(self, x, y):
+        return self.pages[y >> 3][x] >> (y & 7) & 1
+
+    def height(self):
+        return 8*len(self.pages)
+
+    def fps(self):
+        return (self.frames - 1)*1000.0/self.elapsed_ms if self.elapsed_ms else 0
+
+
+def png(path, dec, scale):
+    w, h = dec.width*scale, dec.height()*scale
+    rows = bytearray()
+    for y in range(h):
+        rows.append(0) #Filter: none
+        rows += bytes(255 if dec.pixel(x//scale, y//scale) else 0 for x in range(w))
+
+    def chunk(kind, data):
+        c = kind + data
+        return struct.pack(">I", len(data)) + c + struct.pack(">I", zlib.crc32(c) & 0xFFFFFFFF)
+
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", w, h, 8, 0, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(bytes(rows), 9)))
+        f.write(chunk(b"IEND", b""))
+
+
+def ascii_frame(dec):
+    #Two rows per character with half blocks
+    lines = []
+    for y in range(0, dec.height(), 2):
+        lines.append("".join(" ▀▄█"[dec.pixel(x, y) | dec.pixel(x, y+1) << 1] for x in range(dec.width)))
+    return "\n".join(lines)
+
+
+def open_port(path, baud):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    speed = getattr(termios, "B%d" % baud, None)
+    if speed is not None:
+        attr = termios.tcgetattr(fd)
+        attr[4] = attr[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attr)
+    return fd
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("input", nargs="?", help="recorded stream (default stdin)")
+    ap.add_argument("--port", help="serial port of the bot, or the pty of mirror_sim --pty")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--seconds", type=float, default=0, help="stop after this long (live)")
+    ap.add_argument("--show", action="store_true", help="draw the screen in the terminal")
+    ap.add_argument("--png", metavar="DIR", help="save every frame as DIR/frame_00001.png")
+    ap.add_argument("--scale", type=int, default=4, help="PNG pixels per screen pixel")
+    ap.add_argument("--record", metavar="FILE", help="also save the raw stream (live)")
+    args = ap.parse_args()
+
+    if args.png:
+        os.makedirs(args.png, exist_ok=True)
+    dec = Decoder()
+    saved = 0
+
+    def frame_done():
+        nonlocal saved
+        if args.png:
+            saved += 1
+            png(os.path.join(args.png, "frame_%05d.png" % saved), dec, args.scale)
+        if args.show:
+            sys.stdout.write("\x1b[H" + ascii_frame(dec) + "\n")
+
+    if not args.port:
+        data = open(args.input, "rb").read() if args.input else sys.stdin.buffer.read()
+        for _ in dec.feed(data):
+            frame_done()
+        print("%d frames (%d key, %d lost, %d bad), %.1f s on the bot, %.1f fps, %.1f bytes/frame" % (
+            dec.frames, dec.keys, dec.lost, dec.bad, dec.elapsed_ms/1000.0, dec.fps(),
+            dec.bytes/max(dec.frames, 1)))
+        return
+
+    fd = open_port(args.port, args.baud)
+    record = open(args.record, "wb") if args.record else None
+    os.write(fd, b"mirror on\n")
+    if args.show:
+        sys.stdout.write("\x1b[2J")
+    start = last = time.time()
+    last_frames, last_bytes = 0, 0
+    try:
+        while not args.seconds or time.time() - start < args.seconds:
+            if select.select([fd], [], [], 0.1)[0]:
+                data = os.read(fd, 4096)
+                if record:
+                    record.write(data)
+                for _ in dec.feed(data):
+                    frame_done()
+            now = time.time()
+            if now - last >= 1:
+                status = "%.1f fps here, %.1f on the bot, %.2f kB/s (%.0f%% of %d baud), %d lost %d bad" % (
+                    (dec.frames - last_frames)/(now - last), dec.fps(), (dec.bytes - last_bytes)/(now - last)/1000,
+                    100*(dec.bytes - last_bytes)/(now - last)/(args.baud/10), args.baud, dec.lost, dec.bad)
+                sys.stdout.write(("\x1b[K" + status + "\n") if args.show else status + "\n")
+                sys.stdout.flush()
+                last, last_frames, last_bytes = now, dec.frames, dec.bytes
+    except KeyboardInterrupt:
+        pass
+    finally:
+        os.write(fd, b"mirror off\n")
+        os.close(fd)
+        if record:
+            record.close()
+    print("%d frames (%d key, %d lost), %.1f fps on the bot%s" % (dec.frames, dec.keys, dec.lost, dec.fps(),
+        ", %d PNG in %s" % (saved, args.png) if args.png else ""))
+
+
+if __name__ == "__main__":
+    main()
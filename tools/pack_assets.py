@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+#Packs assets/ into the bundle the bot reads from its "assets" flash partition
+#(see src/assets.h for the format).
+#
+#  assets/faces/<id>_<name>.pbm       128x64 PBM (P4 or P1), stored RLE in page format
+#  assets/messages.txt                idle messages, one per line (UTF-8)
+#  assets/melodies/<id>_<name>.txt    "tempo N" then NOTE DURATION pairs (e.g. C4 4, AS4 -8)
+#
+#Usage: python3 tools/pack_assets.py [assets_dir] [-o assets.bin] [--revision N]
+#Flash: esptool.py --chip esp32c3 write_flash 0x3E0000 assets.bin
+
+import argparse
+import os
+import re
+import struct
+import sys
+import time
+import zlib
+
+MAGIC = 0x41454D41 #"AMEA"
+FORMAT = 1
+HEADER = struct.Struct("<IHHIII") #magic, format, count, revision, size, crc
+ENTRY = struct.Struct("<BBBBIII") #type, id, codec, flags, offset, packed, raw
+PARTITION_SIZE = 0x10000 #partitions.csv
+
+ASSET_FACE = 1
+ASSET_TEXT = 2
+ASSET_MELODY = 3
+CODEC_RAW = 0
+CODEC_RLE = 1
+TEXT_MESSAGES = 0
+
+W, H = 128, 64
+NOTES = ["C", "CS", "D", "DS", "E", "F", "FS", "G", "GS", "A", "AS", "B"]
+
+
+def fail(msg):
+    sys.exit("pack_assets: " + msg)
+
+
+def read_pbm(path):
+    data = open(path, "rb").read()
+    #Header: magic, width, height (comments allowed)
+    tokens, pos = [], 0
+    while len(tokens) < 3:
+        m = re.compile(rb"\s*(#[^\n]*\n\s*)*(\S+)").match(data, pos)
+        if not m:
+            fail("%s: bad PBM header" % path)
+        tokens.append(m.group(2))
+        pos = m.end()
+    kind, w, h = tokens[0], int(tokens[1]), int(tokens[2])
+    if (w, h) != (W, H):
+        fail("%s: faces must be %dx%d" % (path, W, H))
+
+    pixels = []
+    if kind == b"P4":
+        rows = data[pos+1:pos+1 + H*W//8]
+        for b in rows:
+            pixels += [(b >> (7 - k)) & 1 for k in range(8)]
+    elif kind == b"P1":
+        pixels = [int(c) for c in re.sub(rb"#[^\n]*", b"", data[pos:]).decode() if c in "01"]
+    else:
+        fail("%s: only P1/P4 PBM" % path)
+    if len(pixels) != W*H:
+        fail("%s: short image" % path)
+    return pixels
+
+
+#Rows -> SH1106 pages: byte = 8 vertical pixels, bit 0 on top
+def to_pages(pixels):
+    out = bytearray(W*H//8)
+    for y in range(H):
+        for x in range(W):
+            if pixels[y*W + x]:
+                out[(y//8)*W + x] |= 1 << (y & 7)
+    return bytes(out)
+
+
+#0x00-0x7F: n+1 literal bytes follow. 0x80-0xFF: next byte repeated (n & 0x7F) + 3 times
+def rle(data):
+    out, lit, i = bytearray(), bytearray(), 0
+
+    def flush():
+        while lit:
+            chunk = lit[:128]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+            del lit[:128]
+
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 130:
+            run += 1
+        if run >= 3:
+            flush()
+            out += bytes([0x80 | (run - 3), data[i]])
+            i += run
+        else:
+            lit.append(data[i])
+            i += 1
+    flush()
+    return bytes(out)
+
+
+def unrle(data, size):
+    out, i = bytearray(), 0
+    while i < len(data):
+        c = data[i]
+        if c < 0x80:
+            out += data[i+1:i+2+c]
+            i += 2 + c
+        else:
+            out += bytes([data[i+1]])*((c & 0x7F) + 3)
+            i += 2
+    assert len(out) == size
+    return bytes(out)
+
+
+#u16 count, u16 offsets[count] (from the payload start), NUL terminated UTF-8 strings
+def text_list(lines):
+    head = 2 + 2*len(lines)
+    offsets, body = [], bytearray()
+    for s in lines:
+        offsets.append(head + len(body))
+        body += s.encode("utf-8") + b"\0"
+    if head + len(body) > 0xFFFF:
+        fail("text list too long")
+    return struct.pack("<H%dH" % len(lines), len(lines), *offsets) + bytes(body)
+
+
+def note_freq(name):
+    m = re.fullmatch(r"([A-G]S?)(\d)", name)
+    if name == "REST":
+        return 0
+    if not m or m.group(1) not in NOTES:
+        fail("unknown note %s" % name)
+    midi = 12*(int(m.group(2)) + 1) + NOTES.index(m.group(1))
+    return round(440*2**((midi - 69)/12))
+
+
+#u16 tempo, u16 notes, then int16 (frequency, divider) pairs like birthday.h
+def melody(path):
+    tempo, pairs = 120, []
+    words = re.sub(r"#[^\n]*", "", open(path, encoding="utf-8").read()).split()
+    i = 0
+    while i < len(words):
+        if words[i] == "tempo":
+            tempo = int(words[i+1])
+        else:
+            pairs += [note_freq(words[i]), int(words[i+1])]
+        i += 2
+    return struct.pack("<HH%dh" % len(pairs), tempo, len(pairs)//2, *pairs)
+
+
+def numbered(folder, ext):
+    items = []
+    if not os.path.isdir(folder):
+        return items
+    for f in sorted(os.listdir(folder)):
+        m = re.match(r"(\d+)_.*\." + ext + "$", f)
+        if m:
+            items.append((int(m.group(1)), os.path.join(folder, f)))
+    ids = [i for i, _ in items]
+    if len(ids) != len(set(ids)) or any(i > 255 for i in ids):
+        fail("%s: ids must be unique and < 256" % folder)
+    return items
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("src", nargs="?", default="assets")
+    ap.add_argument("-o", "--output", default="assets.bin")
+    ap.add_argument("--revision", type=int, default=int(time.time()))
+    args = ap.parse_args()
+
+    entries = [] #(type, id, codec, payload, raw_size)
+    for i, path in numbered(os.path.join(args.src, "faces"), "pbm"):
+        pages = to_pages(read_pbm(path))
+        packed = rle(pages)
+        assert unrle(packed, len(pages)) == pages
+        entries.append((ASSET_FACE, i, CODEC_RLE, packed, len(pages)))
+
+    msg_path = os.path.join(args.src, "messages.txt")
+    if os.path.exists(msg_path):
+        lines = [l.strip() for l in open(msg_path, encoding="utf-8") if l.strip()]
+        data = text_list(lines)
+        entries.append((ASSET_TEXT, TEXT_MESSAGES, CODEC_RAW, data, len(data)))
+
+    for i, path in numbered(os.path.join(args.src, "melodies"), "txt"):
+        data = melody(path)
+        entries.append((ASSET_MELODY, i, CODEC_RAW, data, len(data)))
+
+    #Header, index, then payloads on 4 byte boundaries (read in place)
+    offset = HEADER.size + ENTRY.size*len(entries)
+    index, blob = bytearray(), bytearray()
+    for kind, i, codec, payload, raw in entries:
+        offset = (offset + 3) & ~3
+        pad = offset - (HEADER.size + ENTRY.size*len(entries) + len(blob))
+        blob += b"\0"*pad
+        index += ENTRY.pack(kind, i, codec, 0, offset, len(payload), raw)
+        blob += payload
+        offset += len(payload)
+
+    body = bytes(index + blob)
+    size = HEADER.size + len(body)
+    if size > PARTITION_SIZE:
+        fail("bundle is %d bytes, the partition has %d" % (size, PARTITION_SIZE))
+    header = HEADER.pack(MAGIC, FORMAT, len(entries), args.revision & 0xFFFFFFFF, size, zlib.crc32(body))
+    open(args.output, "wb").write(header + body)
+
+    raw_total = sum(e[4] for e in entries)
+    print("%s: %d assets, %d bytes (%d unpacked), revision %d" % (args.output, len(entries), size, raw_total, args.revision & 0xFFFFFFFF))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,258 @@
+//Panel emulator, SH1106 and SSD1306 controller RAM
+//
+//Feeds the command/data stream of PageSync::flush() (src/page_sync.h) into a
+//model of the controller: RAM, page and column address with auto increment, the
+//display start line and the column offset of the glass. After every flush the
+//picture the panel shows must equal the page buffer. Runs menu scrolls (with the
+//positions of src/panel.h), slide transitions and random draws mixed with random
+//scrolls, and prints bytes sent per step. Everything runs once per panel the
+//firmware builds for: SH1106 128x64 and SSD1306 128x32.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/panel_emu.cpp -o panel_emu
+//Usage: ./panel_emu [random_steps] [seed]
+
+#include <page_sync.h>
+#include <panel.h>
+#include <blit.h>
+#include <text.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+template<class P>
+struct Controller{
+    uint8_t ram[P::RAM_HEIGHT/8][P::RAM_WIDTH];
+    int page = 0;
+    int col = 0;
+    int start_line = 0;
+    bool page_mode = false; //SSD1306 after 0x20 0x02 (the SH1106 has nothing else)
+    int arg = 0;            //Command waiting for its argument
+    long bytes = 0;
+
+    Controller(){
+        memset(ram, 0, sizeof(ram));
+        page_mode = P::RAM_WIDTH != P::WIDTH; //SH1106
+    }
+
+    //Same framing WireBus uses: one control byte per transaction
+    void command(const uint8_t* cmd, int n){
+        bytes += n + 1;
+        for(int i=0; i<n; i++){
+            uint8_t c = cmd[i];
+            if(arg == OLED_PAGE_ADDRESSING){
+                page_mode = c == OLED_PAGE_MODE;
+                arg = 0;
+            }
+            else if(c == OLED_PAGE_ADDRESSING && P::RAM_WIDTH == P::WIDTH)
+                arg = c;
+            else if(c <= 0x0F)
+                col = (col & 0xF0) | c;
+            else if(c <= 0x1F)
+                col = (col & 0x0F) | ((c & 0x0F) << 4);
+            else if(c >= 0x40 && c <= 0x7F)
+                start_line = c & 0x3F;
+            else if(c >= 0xB0 && c <= 0xB7)
+                page = c & 0x07;
+            else{
+                printf("unexpected command 0x%02X\n", c);
+                exit(1);
+            }
+        }
+    }
+
+    void data(const uint8_t* buf, int n){
+        if(!page_mode){
+            printf("data before page addressing\n");
+            exit(1);
+        }
+        bytes += n + (n + 63)/64; //I2C_CHUNK
+        for(int i=0; i<n; i++){
+            if(col < P::RAM_WIDTH)
+                ram[page][col] = buf[i];
+            col++;
+        }
+    }
+
+    //What the glass shows at (x, y)
+    bool pixel(int x, int y){
+        int r = (start_line + y) % P::RAM_HEIGHT;
+        return ram[r/8][x + P::COL_OFFSET] >> (r & 7) & 1;
+    }
+};
+
+uint32_t rng = 12345;
+int rnd(int n){
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % n;
+}
+
+//Same options as the idle menu in main.cpp
+const char* OPTIONS[] = {"Volver", "Feliz cumple", "Timer", "Estudio", "Pong", "Gambling", "APAGAR"};
+#define N_OPTIONS 7
+
+template<class P>
+struct Emu{
+    static const int W = P::WIDTH;
+    static const int H = P::HEIGHT;
+    typedef PanelLayout<P, Font5x7> L;
+
+    const char* name;
+    uint8_t buf[W*P::PAGES];
+    Blitter blit;
+    Text text;
+    PageSync sync;
+    Controller<P> panel;
+    int failures = 0;
+
+    Emu(const char* name) : name(name){
+        memset(buf, 0, sizeof(buf));
+        blit.init(buf, W, H);
+        text.init(blit);
+        sync.init(buf, W, H, P::RAM_HEIGHT, P::COL_OFFSET);
+        P::setup(panel);
+    }
+
+    long flush(const char* what){
+        long before = panel.bytes;
+        sync.flush(panel);
+        for(int y=0; y<H; y++)
+            for(int x=0; x<W; x++)
+                if(panel.pixel(x, y) != bool(buf[(y/8)*W + x] >> (y & 7) & 1)){
+                    if(failures++ < 10)
+                        printf("%s %s: mismatch at (%d, %d), start line %d\n", name, what, x, y, panel.start_line);
+                    return panel.bytes - before;
+                }
+        return panel.bytes - before;
+    }
+
+    void scroll(int d){
+        blit.shiftRows(d);
+        sync.scrolled(d);
+    }
+
+    //Same steps as Menu::show() in main.cpp
+    void menuList(int offset){
+        for(int i=0; i<N_OPTIONS; i++){
+            int y = i*L::MENU_LINE_H - offset;
+            if(y <= -8 || y >= H)
+                continue;
+            int x = L::MENU_TEXT_X;
+            text.draw(OPTIONS[i], x, y);
+        }
+        int x = 0, y = 0;
+        text.draw("->", x, y);
+        sync.markDirty(0, 0, 12, 8);
+        if(offset + 4*L::MENU_LINE_H < N_OPTIONS*L::MENU_LINE_H){
+            blit.fill(L::ARROW_STEM_X, L::ARROW_STEM_Y, L::ARROW_STEM_W, L::ARROW_STEM_H, ROP_SET);
+            blit.fill(L::ARROW_X, L::ARROW_HEAD_Y, L::ARROW_W, L::ARROW_HEAD_H, ROP_SET);
+            sync.markDirty(L::ARROW_X, L::ARROW_STEM_Y, L::ARROW_W, L::ARROW_STEM_H + L::ARROW_HEAD_H);
+        }
+    }
+
+    void menuScenario(){
+        long full = 0;
+        memset(buf, 0, sizeof(buf));
+        menuList(0);
+        sync.markAll();
+        full = flush("menu first frame");
+
+        int offset = 0;
+        long steps = 0, bytes = 0;
+        int targets[] = {1, 2, 3, 5, 4, 0, 1, 6, 0};
+        for(int target : targets){
+            target *= L::MENU_LINE_H;
+            while(offset != target){
+                int d = target - offset;
+                d = d > 4 ? 4 : (d < -4 ? -4 : d);
+                scroll(d);
+                offset += d;
+                blit.fill(0, -d, L::MENU_TEXT_X, 8, ROP_CLEAR);
+                sync.markDirty(0, -d, L::MENU_TEXT_X, 8);
+                blit.fill(L::ARROW_X, L::ARROW_STEM_Y - d, L::ARROW_W, L::ARROW_STEM_H + L::ARROW_HEAD_H, ROP_CLEAR);
+                sync.markDirty(L::ARROW_X, L::ARROW_STEM_Y - d, L::ARROW_W, L::ARROW_STEM_H + L::ARROW_HEAD_H);
+                menuList(offset);
+                bytes += flush("menu scroll");
+                steps++;
+            }
+        }
+        printf("%s menu scroll: %ld steps, %.0f bytes/step (full frame %ld)\n", name, steps, double(bytes)/steps, full);
+    }
+
+    void slideScenario(int dir){
+        static uint8_t next[W*P::PAGES];
+        memset(next, 0, sizeof(next));
+        for(int i=0; i<20; i++)
+            blit.fill(rnd(W), rnd(H), rnd(30)+1, rnd(20)+1, ROP_XOR);
+        memcpy(next, buf, sizeof(buf));
+
+        //Something else on screen before
+        memset(buf, 0, sizeof(buf));
+        int x = 30, y = L::CENTER_Y;
+        text.draw("Con cariño", x, y);
+        sync.markAll();
+        flush("slide before");
+
+        Sprite s = {W, H, next, NULL};
+        long bytes = 0, steps = 0;
+        for(int done=8; done<=H; done+=8){
+            scroll(dir*8);
+            blit.sprite(s, 0, dir > 0 ? H-done : done-H, ROP_SET);
+            bytes += flush("slide");
+            steps++;
+        }
+        if(memcmp(buf, next, sizeof(buf)) != 0){
+            printf("%s slide %d: final frame differs\n", name, dir);
+            failures++;
+        }
+        printf("%s slide %+d: %ld steps, %.0f bytes/step\n", name, dir, steps, double(bytes)/steps);
+    }
+
+    void randomScenario(long steps){
+        for(long i=0; i<steps; i++){
+            int what = rnd(4);
+            if(what == 0){
+                int d = rnd(2*H + 1) - H;
+                scroll(d);
+            }
+            else if(what == 1){
+                int x = rnd(W+20)-10, y = rnd(H+20)-10, w = rnd(40), h = rnd(30);
+                blit.fill(x, y, w, h, rnd(3));
+                sync.markDirty(x, y, w, h);
+            }
+            else if(what == 2){
+                int x = rnd(W), y = rnd(H+8)-8, y0 = y;
+                text.draw("Hola :D", x, y, 1 + rnd(2));
+                sync.markDirty(0, y0, W, y - y0 + 16); //Text may wrap
+            }
+            if(rnd(3) == 0)
+                flush("random");
+        }
+        flush("random end");
+        printf("%s random: %ld steps\n", name, steps);
+    }
+
+    int run(long steps){
+        menuScenario();
+        slideScenario(1);
+        slideScenario(-1);
+        randomScenario(steps);
+        return failures;
+    }
+};
+
+int main(int argc, char** argv){
+    long steps = argc > 1 ? atol(argv[1]) : 20000;
+    rng = argc > 2 ? (uint32_t)atol(argv[2]) : 12345;
+    if(rng == 0)
+        rng = 1;
+
+    static Emu<PanelSH1106> sh1106("sh1106 128x64");
+    static Emu<PanelSSD1306_128x32> ssd1306("ssd1306 128x32");
+    int failures = sh1106.run(steps) + ssd1306.run(steps);
+
+    printf("%s\n", failures ? "FAIL" : "both panels match the buffer");
+    return failures ? 1 : 0;
+}
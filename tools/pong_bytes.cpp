@@ -0,0 +1,171 @@
+//Pong bytes per frame, measured on the PC with the bot's own renderer
+//
+//Plays Pong with PongPhysics at every CPU level, one PongClock step pattern like
+//playing_loop(), and draws each frame twice with PongRenderer (src/pong_render.h):
+//once the way the firmware does (dirty rectangles) and once redrawn from scratch.
+//Both go through PageSync::flush() into a bus that counts what WireBus would send.
+//The two buffers must be the same after every frame, a difference means the dirty
+//path left something behind or missed something (exits 1).
+//
+//Runs on the SH1106 128x64 and the SSD1306 128x32 (src/panel.h).
+//
+//Build: g++ -O2 -std=c++17 -I src tools/pong_bytes.cpp -o pong_bytes
+//Usage: ./pong_bytes [seconds_per_level] [frame_ms] [seed]
+
+#include <pong.h>
+#include <pong_render.h>
+#include <panel.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define I2C_CHUNK 64 //src/objects.h
+#define ROUNDS 3 //Default pong_rounds (src/settings.h)
+
+//Counts what WireBus would put on the I2C bus
+struct CountBus{
+    long bytes = 0;
+
+    void command(const uint8_t*, int n){
+        bytes += n + 1;
+    }
+
+    void data(const uint8_t*, int n){
+        for(int x=0; x<n; x+=I2C_CHUNK){
+            int len = n - x < I2C_CHUNK ? n - x : I2C_CHUNK;
+            bytes += len + 1;
+        }
+    }
+};
+
+//One screen: page buffer, blitter, text, sync and the renderer on top
+struct Surface{
+    uint8_t buf[128*8];
+    Blitter blit;
+    Text text;
+    PageSync sync;
+    PongRenderer renderer;
+    CountBus bus;
+
+    template<class P>
+    void init(){
+        memset(buf, 0, sizeof(buf));
+        blit.init(buf, P::WIDTH, P::HEIGHT);
+        text.init(blit);
+        sync.init(buf, P::WIDTH, P::HEIGHT, P::RAM_HEIGHT, P::COL_OFFSET);
+        renderer.init(blit, text, sync);
+    }
+
+    long frame(PongPhysics &pong, fixed t, int l_score, int r_score){
+        long before = bus.bytes;
+        renderer.draw(pong.render_x(t), pong.render_y(t), FROM_FP(pong.l_pos), FROM_FP(pong.r_pos),
+                      pong.paddle_width, pong.paddle_high, l_score, r_score);
+        sync.flush(bus);
+        return bus.bytes - before;
+    }
+};
+
+struct Stat{
+    std::vector<long> v;
+
+    void add(long x){
+        v.push_back(x);
+    }
+
+    double mean() const{
+        double s = 0;
+        for(long x : v)
+            s += x;
+        return v.empty() ? 0 : s/v.size();
+    }
+
+    long pct(int p){
+        if(v.empty())
+            return 0;
+        std::sort(v.begin(), v.end());
+        return v[(v.size()-1)*p/100];
+    }
+};
+
+//Player like mirror_sim: follows the ball a bit late
+int follow(PongPhysics &pong, int height){
+    int target = FROM_FP(pong.ball.y) - pong.paddle_high/2;
+    int pos = FROM_FP(pong.l_pos);
+    pos += target > pos + 2 ? 2 : (target < pos - 2 ? -2 : 0);
+    return pos < 0 ? 0 : (pos > height - pong.paddle_high ? height - pong.paddle_high : pos);
+}
+
+template<class P>
+bool runPanel(const char* name, double seconds, int frame_ms, uint32_t seed){
+    static Surface dirty, full;
+    printf("%s, %d ms frames\n", name, frame_ms);
+    printf("  level  frames   dirty mean  p50  p99   max   full mean   saved\n");
+
+    for(int level=0; level<PONG_N_LEVELS; level++){
+        dirty.template init<P>();
+        full.template init<P>();
+
+        PongPhysics pong;
+        pong.init(P::WIDTH, P::HEIGHT, seed + level);
+        pong.set_difficulty(level);
+        pong.start();
+
+        PongClock clock;
+        unsigned long now = 0;
+        clock.reset(now);
+        int l_score = 0, r_score = 0;
+        Stat d, f;
+
+        long frames = long(seconds*1000/frame_ms);
+        for(long k=0; k<frames; k++){
+            now += frame_ms;
+            pong.set_left(follow(pong, P::HEIGHT));
+            int steps = clock.advance(now);
+            for(int i=0; i<steps; i++){
+                uint8_t ev = pong.step();
+                l_score += (ev & PONG_LEFT_SCORES) != 0;
+                r_score += (ev & PONG_RIGHT_SCORES) != 0;
+            }
+
+            //Match over: the firmware starts the next one from a clean screen
+            if(l_score > ROUNDS || r_score > ROUNDS){
+                l_score = r_score = 0;
+                dirty.renderer.reset();
+            }
+
+            fixed t = clock.alpha();
+            full.renderer.reset();
+            d.add(dirty.frame(pong, t, l_score, r_score));
+            f.add(full.frame(pong, t, l_score, r_score));
+
+            if(memcmp(dirty.buf, full.buf, sizeof(dirty.buf)) != 0){
+                printf("  level %d: frame %ld differs from the full redraw\n", level, k);
+                return false;
+            }
+        }
+
+        double dm = d.mean(), fm = f.mean();
+        printf("  %5d  %6zu  %11.1f %4ld %4ld %5ld  %10.1f  %5.1f%%\n", level, d.v.size(), dm, d.pct(50),
+               d.pct(99), d.pct(100), fm, fm > 0 ? 100.0*(1 - dm/fm) : 0.0);
+    }
+    printf("\n");
+    return true;
+}
+
+int main(int argc, char** argv){
+    double seconds = argc > 1 ? atof(argv[1]) : 60;
+    int frame_ms = argc > 2 ? atoi(argv[2]) : 22;
+    uint32_t seed = argc > 3 ? strtoul(argv[3], NULL, 10) : 1;
+    if(seconds <= 0 || frame_ms <= 0){
+        fprintf(stderr, "usage: %s [seconds_per_level] [frame_ms] [seed]\n", argv[0]);
+        return 2;
+    }
+
+    bool ok = runPanel<PanelSH1106>("SH1106 128x64", seconds, frame_ms, seed);
+    ok = runPanel<PanelSSD1306_128x32>("SSD1306 128x32", seconds, frame_ms, seed) && ok;
+    printf(ok ? "dirty frames match the full redraw\n" : "MISMATCH\n");
+    return ok ? 0 : 1;
+}
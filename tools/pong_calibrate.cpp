@@ -0,0 +1,269 @@
+//Pong difficulty calibration
+//
+//Plays headless matches of the real Pong core (src/pong.h) against a simulated
+//player on every core, and prints win rate / rally length as CSV. The "game" rows
+//are the levels as the game plays them (set_difficulty picks paddle and ball speed),
+//the "sweep" rows cross every level with other paddle sizes. Same seed = same numbers.
+//
+//At game speeds neither side misses much, so a rally that reaches --rally hits is
+//decided on the closest call: the side whose paddle caught the ball nearest to its
+//edge loses it (counted in capped_rallies). 0 lets rallies run, long matches are draws.
+//
+//Build: g++ -O2 -std=c++17 -pthread -I src tools/pong_calibrate.cpp -o pong_calibrate
+//Usage: ./pong_calibrate [--matches N] [--seed S] [--threads T] [--score W] [--rally HITS]
+//                        [--reaction STEPS] [--error PX] [--speed PX_S]
+
+#include <pong.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#define MAX_MATCH_STEPS 30000 //10 minutes of play, longer counts as a draw
+
+//Simulated human on the left paddle, same kind of parameters as the CPU table
+struct Player{
+    int reaction_steps = 10;
+    int error_px = 6;
+    int speed = 90; //px per second
+
+    fixed pos = 0;
+    fixed target = 0;
+    int wait = 0;
+
+    void plan(PongPhysics &p, uint32_t &rng){
+        wait = reaction_steps;
+        if(p.ball.vx >= 0){
+            target = TO_FP(p.height - p.paddle_high)/2;
+            return;
+        }
+        int error = (int)(pong_rand(rng) % (2*error_px + 1)) - error_px;
+        target = fp_clamp(p.intercept_y(p.left_face()) - TO_FP(p.paddle_high)/2 + TO_FP(error), 0, p.max_paddle());
+    }
+
+    void move(){
+        if(wait > 0){
+            wait--;
+            return;
+        }
+        fixed step = PX_PER_STEP(speed);
+        if(pos < target)
+            pos = pos + step < target ? pos + step : target;
+        else if(pos > target)
+            pos = pos - step > target ? pos - step : target;
+    }
+};
+
+struct Cell{
+    int cpu_speed;
+    int paddle_high; //-1 = the one set_difficulty picks
+
+    //Results
+    long cpu_wins = 0;
+    long player_wins = 0;
+    long draws = 0;
+    long rallies = 0;
+    long rally_hits = 0;
+    long longest_rally = 0;
+    long capped_rallies = 0;
+    long steps = 0;
+};
+
+struct Options{
+    long matches = 2000;
+    uint32_t seed = 1;
+    int threads = 0;
+    int winning_score = 3;
+    int rally_cap = 20;
+    Player player;
+};
+
+//Same seed for the same (seed, cell, match), no matter which thread runs it
+uint32_t match_seed(uint32_t seed, int cell, long match){
+    uint32_t h = seed*2654435761u ^ (uint32_t)cell*40503u ^ (uint32_t)match*2246822519u;
+    pong_rand(h);
+    return h ? h : 1;
+}
+
+//Px between the contact point and the nearest end of the paddle that caught it
+fixed hit_margin(PongPhysics &p, const PongBall &before, bool left){
+    PongBall after = p.ball;
+    p.ball = before;
+    fixed y = p.intercept_y(left ? p.left_face() : p.right_face());
+    p.ball = after;
+    fixed pos = left ? p.l_pos : p.r_pos;
+    fixed top = y - (pos - TO_FP(p.ball_radius));
+    fixed bottom = pos + TO_FP(p.paddle_high + p.ball_radius) - y;
+    return top < bottom ? top : bottom;
+}
+
+void play_match(const Options &opt, Cell &c, uint32_t seed){
+    PongPhysics p;
+    p.init(128, 64, seed);
+    p.set_difficulty(c.cpu_speed);
+    if(c.paddle_high > 0)
+        p.paddle_high = c.paddle_high;
+    p.start();
+
+    uint32_t rng = seed ^ 0x9e3779b9u;
+    Player pl = opt.player;
+    pl.pos = p.l_pos;
+    pl.plan(p, rng);
+
+    int l_score = 0, r_score = 0;
+    long hits = 0;
+    fixed l_closest = 0, r_closest = 0; //Tightest catch of each side this rally
+
+    for(long s=0; s<MAX_MATCH_STEPS; s++){
+        pl.move();
+        p.l_pos = pl.pos;
+
+        PongBall before = p.ball;
+        uint8_t ev = p.step();
+        c.steps++;
+
+        if(ev & PONG_HIT_PADDLE){
+            bool left = p.ball.vx > 0;
+            fixed m = hit_margin(p, before, left);
+            fixed &closest = left ? l_closest : r_closest;
+            if(hits < 2 || m < closest)
+                closest = m;
+            hits++;
+        }
+
+        //Rally too long: the closest call loses it, served like a normal point
+        if(opt.rally_cap > 0 && hits >= opt.rally_cap && !(ev & (PONG_LEFT_SCORES | PONG_RIGHT_SCORES))){
+            bool left_loses = l_closest < r_closest || (l_closest == r_closest && (pong_rand(rng) & 1));
+            p.ball_reset(left_loses);
+            p.plan_cpu();
+            ev |= left_loses ? PONG_RIGHT_SCORES : PONG_LEFT_SCORES;
+            c.capped_rallies++;
+        }
+
+        if(ev & (PONG_LEFT_SCORES | PONG_RIGHT_SCORES)){
+            if(ev & PONG_LEFT_SCORES)
+                l_score++;
+            else
+                r_score++;
+
+            c.rallies++;
+            c.rally_hits += hits;
+            if(hits > c.longest_rally)
+                c.longest_rally = hits;
+            hits = 0;
+        }
+        if(ev & (PONG_HIT_PADDLE | PONG_LEFT_SCORES | PONG_RIGHT_SCORES))
+            pl.plan(p, rng);
+
+        if(l_score >= opt.winning_score){
+            c.player_wins++;
+            return;
+        }
+        if(r_score >= opt.winning_score){
+            c.cpu_wins++;
+            return;
+        }
+    }
+    c.draws++;
+}
+
+int main(int argc, char** argv){
+    Options opt;
+    for(int i=1; i<argc; i+=2){
+        const char* k = argv[i];
+        if(i+1 >= argc){
+            fprintf(stderr, "missing value for %s\n", k);
+            return 1;
+        }
+        long v = atol(argv[i+1]);
+        if(!strcmp(k, "--matches")) opt.matches = v;
+        else if(!strcmp(k, "--seed")) opt.seed = (uint32_t)v;
+        else if(!strcmp(k, "--threads")) opt.threads = (int)v;
+        else if(!strcmp(k, "--score")) opt.winning_score = (int)v;
+        else if(!strcmp(k, "--rally")) opt.rally_cap = (int)v;
+        else if(!strcmp(k, "--reaction")) opt.player.reaction_steps = (int)v;
+        else if(!strcmp(k, "--error")) opt.player.error_px = (int)v;
+        else if(!strcmp(k, "--speed")) opt.player.speed = (int)v;
+        else{
+            fprintf(stderr, "unknown option %s\n", k);
+            return 1;
+        }
+    }
+    if(opt.threads <= 0)
+        opt.threads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    //Grid: the levels as played, then every cpu level against a range of paddle sizes
+    std::vector<Cell> cells;
+    for(int cpu=0; cpu<PONG_N_LEVELS; cpu++)
+        cells.push_back({cpu, -1});
+    for(int cpu=0; cpu<PONG_N_LEVELS; cpu++)
+        for(int ph=4; ph<=24; ph+=2)
+            cells.push_back({cpu, ph});
+
+    //Work = (cell, match) pairs handed out in chunks; every job writes its own slot
+    const long CHUNK = 64;
+    long chunks_per_cell = (opt.matches + CHUNK - 1)/CHUNK;
+    long total_chunks = chunks_per_cell*(long)cells.size();
+    std::vector<Cell> partial(total_chunks);
+    std::atomic<long> next(0);
+
+    auto worker = [&](){
+        for(long j = next++; j < total_chunks; j = next++){
+            int cell = (int)(j / chunks_per_cell);
+            long first = (j % chunks_per_cell)*CHUNK;
+            long last = std::min(first + CHUNK, opt.matches);
+
+            Cell &c = partial[j];
+            c.cpu_speed = cells[cell].cpu_speed;
+            c.paddle_high = cells[cell].paddle_high;
+            for(long m=first; m<last; m++)
+                play_match(opt, c, match_seed(opt.seed, cell, m));
+        }
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for(int i=0; i<opt.threads; i++)
+        pool.emplace_back(worker);
+    for(auto &t : pool)
+        t.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    //Reduce in a fixed order so the output does not depend on scheduling
+    long total_steps = 0;
+    for(long j=0; j<total_chunks; j++){
+        Cell &c = cells[j / chunks_per_cell];
+        Cell &p = partial[j];
+        c.cpu_wins += p.cpu_wins;
+        c.player_wins += p.player_wins;
+        c.draws += p.draws;
+        c.rallies += p.rallies;
+        c.rally_hits += p.rally_hits;
+        c.longest_rally = std::max(c.longest_rally, p.longest_rally);
+        c.capped_rallies += p.capped_rallies;
+        c.steps += p.steps;
+        total_steps += p.steps;
+    }
+
+    printf("grid,cpu_speed,paddle_high,matches,cpu_win_rate,draws,mean_rally_hits,longest_rally,capped_rallies,mean_match_s\n");
+    for(auto &c : cells){
+        long played = c.cpu_wins + c.player_wins + c.draws;
+        PongPhysics game;
+        game.set_difficulty(c.cpu_speed);
+        printf("%s,%d,%d,%ld,%.4f,%ld,%.2f,%ld,%.4f,%.1f\n", c.paddle_high > 0 ? "sweep" : "game",
+            c.cpu_speed, c.paddle_high > 0 ? c.paddle_high : game.paddle_high, played,
+            played ? (double)c.cpu_wins/played : 0.0, c.draws,
+            c.rallies ? (double)c.rally_hits/c.rallies : 0.0, c.longest_rally,
+            c.rallies ? (double)c.capped_rallies/c.rallies : 0.0,
+            played ? (double)c.steps*PONG_STEP_MS/1000.0/played : 0.0);
+    }
+
+    fprintf(stderr, "%ld matches, %ld frames in %.2f s on %d threads (%.1f M frames/s)\n",
+        opt.matches*(long)cells.size(), total_steps, secs, opt.threads, total_steps/secs/1e6);
+    return 0;
+}
@@ -0,0 +1,99 @@
+//Pong tunneling fuzz
+//
+//Fires millions of random shots through PongPhysics::sweep(): anywhere on the
+//field, any direction, from game speeds up to half the screen per step, with the
+//paddles anywhere. For each shot the crossing of the paddle face is worked out
+//separately in floating point (walls unfolded). If that crossing is inside the
+//paddle (by a pixel, fixed point rounding aside) the step must report a paddle hit
+//and leave the ball on the field side, or at worst stop on the face and bounce at
+//the start of the next step: anything else is a tunnel and the tool exits 1. Also
+//checks the ball never leaves the walls.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/pong_fuzz.cpp -o pong_fuzz
+//Usage: ./pong_fuzz [shots] [seed]
+
+#include <pong.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#define MAX_SPEED_PX 64 //Per step, 3200 px/s (the fastest level is ~380)
+#define MARGIN_PX 1.0
+
+uint32_t rng;
+
+int rand_range(int lo, int hi){
+    return lo + int(pong_rand(rng) % uint32_t(hi - lo + 1));
+}
+
+//Fold a y that ignored the walls back between them
+double fold(double y, double top, double bottom){
+    double span = bottom - top;
+    double u = fmod(y - top, 2*span);
+    if(u < 0)
+        u += 2*span;
+    return top + (u <= span ? u : 2*span - u);
+}
+
+int main(int argc, char** argv){
+    long shots = argc > 1 ? atol(argv[1]) : 5000000;
+    rng = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+
+    PongPhysics p;
+    p.init(128, 64, 1);
+    long hits = 0, late = 0, misses = 0, tunnels = 0, escapes = 0, fast = 0;
+
+    for(long i=0; i<shots; i++){
+        p.set_difficulty(rand_range(0, 17));
+        p.l_pos = rand_range(0, p.max_paddle());
+        p.r_pos = rand_range(0, p.max_paddle());
+
+        PongBall &b = p.ball;
+        b.x = rand_range(p.left_face(), p.right_face());
+        b.y = rand_range(p.top(), p.bottom());
+        int speed = rand_range(FP_ONE/2, MAX_SPEED_PX*FP_ONE);
+        b.vx = rand_range(speed/4, speed)*(pong_rand(rng) & 1 ? 1 : -1);
+        b.vy = rand_range(-speed*PONG_MAX_SLOPE/4, speed*PONG_MAX_SLOPE/4);
+        fast += speed > p.ball_speed;
+
+        //Where the reference says the ball meets the face it is heading to
+        double x = b.x/256.0, y = b.y/256.0, vx = b.vx/256.0, vy = b.vy/256.0;
+        double face = (vx < 0 ? p.left_face() : p.right_face())/256.0;
+        double pos = (vx < 0 ? p.l_pos : p.r_pos)/256.0;
+        double t = (face - x)/vx;
+        bool reaches = t >= 0 && t <= 1;
+        double cy = fold(y + vy*t, p.top()/256.0, p.bottom()/256.0);
+        bool inside = cy >= pos - p.ball_radius + MARGIN_PX && cy <= pos + p.paddle_high + p.ball_radius - MARGIN_PX;
+
+        uint8_t events = p.sweep();
+        bool field_side = b.x >= p.left_face() && b.x <= p.right_face();
+
+        //Rounding can leave the ball right on the face with the step used up: the
+        //contact is at time 0 of the next step, it has to bounce there
+        if(reaches && inside && !(events & PONG_HIT_PADDLE) && field_side){
+            events = p.sweep();
+            field_side = b.x >= p.left_face() && b.x <= p.right_face();
+            late++;
+        }
+        if(reaches && inside){
+            if(!(events & PONG_HIT_PADDLE) || !field_side){
+                if(tunnels < 10)
+                    printf("tunnel: shot %ld from %.2f,%.2f v %.2f,%.2f, face at y %.2f, paddle %.2f-%.2f, ended %.2f,%.2f\n",
+                        i, x, y, vx, vy, cy, pos, pos + p.paddle_high, b.x/256.0, b.y/256.0);
+                tunnels++;
+            }
+            else
+                hits++;
+        }
+        else if(reaches)
+            misses++;
+
+        if(b.y < p.top() || b.y > p.bottom())
+            escapes++;
+    }
+
+    printf("%ld shots (%ld faster than their level): %ld paddle hits (%ld on the next step), %ld misses, %ld tunnels, "
+        "%ld out of the walls\n", shots, fast, hits, late, misses, tunnels, escapes);
+    return tunnels == 0 && escapes == 0 ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+//Pong fixed timestep check
+//
+//Runs the same match (same seed, same simulated player) through PongClock with
+//different frame time patterns: steady 50, 60 and 30 fps, random jitter, stalls
+//under the catch-up limit and stalls over it. The physics only ever sees whole
+//PONG_STEP_MS steps, so ball, paddles and events after every step must be bit for
+//bit the same as the steady run. Also checks that no time is lost while the stalls
+//stay under PONG_MAX_STEPS. Exits 1 on the first difference.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/pong_timestep.cpp -o pong_timestep
+//Usage: ./pong_timestep [steps] [seed]
+
+#include <pong.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+struct Snapshot{
+    fixed x, y, vx, vy;
+    fixed l_pos, r_pos;
+    uint8_t events;
+
+    bool operator==(const Snapshot &o) const{
+        return x == o.x && y == o.y && vx == o.vx && vy == o.vy && l_pos == o.l_pos && r_pos == o.r_pos &&
+            events == o.events;
+    }
+};
+
+//Frame times of the loop, in ms
+struct Pattern{
+    const char* name;
+    int kind;
+    uint32_t rng = 7;
+
+    int next(){
+        uint32_t r = pong_rand(rng);
+        switch(kind){
+            case 0: return PONG_STEP_MS;
+            case 1: return 16 + (r % 3 == 0);   //60 fps, 16.67 ms
+            case 2: return 33 + (r % 3 == 0);   //30 fps
+            case 3: return 1 + r % 45;          //Anything
+            case 4: return r % 50 == 0 ? 100 + r % (PONG_MAX_STEPS*PONG_STEP_MS - 100) : 5 + r % 20; //Short stalls
+            default: return r % 40 == 0 ? 300 + r % 700 : 5 + r % 30; //Long stalls, steps get dropped
+        }
+    }
+
+    //Stalls over the catch-up limit drop time on purpose
+    bool drops(){
+        return kind == 5;
+    }
+};
+
+//Simulated player on the left: aims with an error picked once per volley, so it
+//misses now and then. It is called once per step and only looks at the physics
+struct Player{
+    uint32_t rng = 3;
+    int error = 0;
+    bool coming = false;
+
+    void move(PongPhysics &p){
+        if(p.ball.vx < 0 && !coming)
+            error = int(pong_rand(rng) % 31) - 15;
+        coming = p.ball.vx < 0;
+        int target = FROM_FP(p.ball.y) - p.paddle_high/2 + error;
+        int pos = FROM_FP(p.l_pos);
+        pos += target > pos + 1 ? 2 : (target < pos - 1 ? -2 : 0);
+        p.set_left(pos);
+    }
+};
+
+//Steps of one match under a frame pattern, returns the ms it took
+unsigned long run(Pattern &pattern, uint32_t seed, int n_steps, std::vector<Snapshot> &out){
+    PongPhysics p;
+    p.init(128, 64, seed);
+    p.set_difficulty(5);
+    p.start();
+
+    Player player;
+    PongClock clock;
+    unsigned long now = 1000;
+    clock.reset(now);
+    out.clear();
+    while(int(out.size()) < n_steps){
+        now += pattern.next();
+        int steps = clock.advance(now);
+        fixed a = clock.alpha();
+        if(a < 0 || a >= FP_ONE){
+            printf("%s: alpha %ld out of [0, 1)\n", pattern.name, (long)a);
+            exit(1);
+        }
+        for(int i=0; i<steps && int(out.size()) < n_steps; i++){
+            player.move(p);
+            uint8_t events = p.step();
+            out.push_back({p.ball.x, p.ball.y, p.ball.vx, p.ball.vy, p.l_pos, p.r_pos, events});
+        }
+    }
+    return now - 1000;
+}
+
+int main(int argc, char** argv){
+    int n_steps = argc > 1 ? atoi(argv[1]) : 200000;
+    uint32_t seed = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+
+    Pattern patterns[] = {{"steady 50 fps", 0}, {"steady 60 fps", 1}, {"steady 30 fps", 2}, {"jitter 1-45 ms", 3},
+        {"stalls < catch-up", 4}, {"stalls > catch-up", 5}};
+    std::vector<Snapshot> ref, got;
+    run(patterns[0], seed, n_steps, ref);
+
+    int points = 0;
+    for(const Snapshot &s : ref)
+        points += (s.events & (PONG_LEFT_SCORES | PONG_RIGHT_SCORES)) != 0;
+    printf("%d steps, seed %u, %d points\n", n_steps, (unsigned)seed, points);
+
+    bool ok = true;
+    for(Pattern &pattern : patterns){
+        unsigned long ms = run(pattern, seed, n_steps, got);
+        for(int i=0; i<n_steps; i++)
+            if(!(got[i] == ref[i])){
+                printf("%-18s differs at step %d: ball %ld,%ld vs %ld,%ld\n", pattern.name, i, (long)got[i].x,
+                    (long)got[i].y, (long)ref[i].x, (long)ref[i].y);
+                ok = false;
+                break;
+            }
+
+        //All the time became steps (what is left is the last frame, not yet stepped)
+        long lost = long(ms) - long(n_steps)*PONG_STEP_MS;
+        bool time_ok = pattern.drops() ? lost >= 0 : lost >= 0 && lost < (PONG_MAX_STEPS + 1)*PONG_STEP_MS;
+        if(!time_ok){
+            printf("%-18s %ld ms of play for %d steps\n", pattern.name, (long)ms, n_steps);
+            ok = false;
+        }
+        printf("%-18s %8lu ms, %s\n", pattern.name, ms, ok ? "same trajectory" : "FAIL");
+    }
+    if(!ok)
+        return 1;
+    printf("all patterns match\n");
+    return 0;
+}
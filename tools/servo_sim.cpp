@@ -0,0 +1,223 @@
+//Arm servo write counter
+//
+//Drives the ArmMotion of src/arm_motion.h the way the firmware does (move() from
+//the modes, update() once per 20 ms loop) against a fake servo that counts writes,
+//and compares with the old Arm. Scenarios: Pong (the arm follows the CPU paddle of
+//a real src/pong.h match), the timer alarm (0/100 every 3 s), a blocking sequence
+//that never pumps update(), a move right after an update followed by the power off /
+//low battery loop, and the servo being cut halfway through a move (it has to park at
+//rest). Checks that every scenario ends with the last target written and that
+//profile writes are at least one servo frame apart.
+//
+//The old Arm::move() did one pwm.write() per call and the servo slewed the whole way
+//at its own top speed. That is the "before" column, and it only means something
+//for streams of close targets: Pong has to take fewer writes than before, blocking
+//stays at one per move. A far target (alarm, branch, park) is meant to cost more,
+//the profile eases it out with one write per servo frame (some 20 writes for
+//a full swing instead of one jump), so those print writes per move and are checked
+//against the length of a full swing instead. Exits 1 otherwise.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/servo_sim.cpp -o servo_sim
+//Usage: ./servo_sim [seconds]
+
+#include <arm_motion.h>
+#include <pong.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#define LOOP_MS 20
+
+//How a scenario is judged, see the top
+#define FEWER 0    //Close targets, fewer writes than the old Arm
+#define SAME 1     //No update(), one write per move like the old Arm
+#define PROFILE 2  //Far targets, at most a full swing of writes per move
+
+//Writes of a rest to rest swing over the whole range: accelerate half way, brake the rest
+const double SWING_WRITES = 2*sqrt((RELAXED - POINTING)/ARM_ACCEL)*1000/ARM_MIN_WRITE_MS + 2;
+
+//Arm of src/objects.h with the PWM replaced by a counter
+struct FakeArm{
+    ArmMotion motion;
+    bool active = true;
+    long moves = 0;     //Writes of the old Arm: one pwm.write() per move()
+    long close = 0;     //Profile writes closer than a servo frame
+    bool stale_write = false;
+
+    int degrees(int pos){
+        return RELAXED + pos*(POINTING - RELAXED)/100; //map(pos, 0, 100, RELAXED, POINTING)
+    }
+
+    void write(int deg, unsigned long now){
+        if(deg == motion.commanded)
+            return;
+        if(!stale_write && motion.writes > 0 && now - motion.last_write < ARM_MIN_WRITE_MS)
+            close++;
+        motion.wrote(deg, now);
+    }
+
+    void move(int pos, unsigned long now, int speed=500){
+        if(!active)
+            return;
+        moves++;
+        if(!motion.aim(degrees(pos), speed))
+            return;
+        if(motion.stale(now)){
+            motion.jump();
+            stale_write = true;
+            write(motion.target, now);
+            stale_write = false;
+        }
+    }
+
+    void update(unsigned long now){
+        int deg = motion.update(now, active);
+        if(deg >= 0)
+            write(deg, now);
+    }
+
+    //Arm::park() + Power::servo(false)
+    void off(unsigned long now){
+        if(active){
+            motion.target = RELAXED;
+            motion.jump();
+            stale_write = true;
+            write(RELAXED, now);
+            stale_write = false;
+        }
+        active = false;
+    }
+};
+
+bool report(const char* name, FakeArm &arm, int seconds, int kind){
+    //A second of loops with no new target: the last one has to be on the servo
+    unsigned long now = arm.motion.last_update;
+    for(int i=0; i<1000/LOOP_MS; i++)
+        arm.update(now += LOOP_MS);
+
+    long writes = arm.motion.writes;
+    double per_move = arm.moves ? double(writes)/arm.moves : 0;
+    bool ok = arm.motion.commanded == arm.motion.target && arm.close == 0;
+    char judged[64];
+    if(kind == PROFILE){
+        ok = ok && per_move <= SWING_WRITES;
+        snprintf(judged, sizeof(judged), "%.1f per move, a full swing is %.0f", per_move, SWING_WRITES);
+    }
+    else{
+        ok = ok && (kind == FEWER ? writes < arm.moves : writes == arm.moves);
+        snprintf(judged, sizeof(judged), "%.0f%% of the old Arm", 100*per_move);
+    }
+    printf("%-10s %6ld moves, %6ld writes (%.1f/s, %s), last %d target %d%s\n", name, arm.moves, writes,
+        double(writes)/seconds, judged, arm.motion.commanded, arm.motion.target, ok ? "" : "  FAIL");
+    if(arm.close)
+        printf("%-10s %ld writes closer than %d ms\n", name, arm.close, ARM_MIN_WRITE_MS);
+    return ok;
+}
+
+//gameMode: the arm points where the CPU paddle is, every frame
+bool pong(int seconds){
+    PongPhysics p;
+    p.init(128, 64, 1);
+    p.set_difficulty(3);
+    p.start();
+    FakeArm arm;
+    unsigned long now = 1000;
+    for(int f=0; f<seconds*1000/LOOP_MS; f++){
+        now += LOOP_MS;
+        int target = FROM_FP(p.ball.y) - p.paddle_high/2;
+        int pos = FROM_FP(p.l_pos);
+        p.set_left(pos + (target > pos + 2 ? 2 : (target < pos - 2 ? -2 : 0)));
+        p.step();
+        arm.move(100 - FROM_FP(p.r_pos)*100/(p.height - p.paddle_high), now);
+        arm.update(now);
+    }
+    return report("pong", arm, seconds, FEWER);
+}
+
+//timerMode alarm: up and down every 3 s
+bool alarm(int seconds){
+    FakeArm arm;
+    unsigned long now = 1000;
+    for(int f=0; f<seconds*1000/LOOP_MS; f++){
+        now += LOOP_MS;
+        if(f % (3000/LOOP_MS) == 0)
+            arm.move((f/(3000/LOOP_MS)) % 2 ? 0 : 100, now);
+        arm.update(now);
+    }
+    return report("alarm", arm, seconds, PROFILE);
+}
+
+//Beeps and holds in between, nobody calls update(): every move goes out right away
+bool blocking(int seconds){
+    FakeArm arm;
+    unsigned long now = 1000;
+    bool ok = true;
+    for(int i=0; i<seconds*2; i++){
+        now += 500;
+        arm.move(i % 2 ? 0 : 100, now);
+        ok = ok && arm.motion.commanded == arm.motion.target;
+    }
+    if(!ok)
+        printf("blocking   a move was not written right away\n");
+    return report("blocking", arm, seconds, SAME) && ok;
+}
+
+//powerOffMode / lowBatteryMenu: move(0) right after an update(), the next loops
+//only run the mode and pump the arm
+bool branch(int seconds){
+    FakeArm arm;
+    unsigned long now = 1000;
+    bool ok = true;
+    for(int i=0; i<seconds; i++){
+        now += LOOP_MS;
+        arm.update(now);
+        arm.move(i % 2 ? 100 : 0, now); //Not stale, left to update()
+        unsigned long asked = now;
+        while(arm.motion.commanded != arm.motion.target && now - asked < 2000)
+            arm.update(now += LOOP_MS);
+        ok = ok && arm.motion.commanded == arm.motion.target;
+        for(int k=0; k<20; k++)
+            arm.update(now += LOOP_MS);
+    }
+    if(!ok)
+        printf("branch     a target was not written within 2 s\n");
+    return report("branch", arm, seconds, PROFILE) && ok;
+}
+
+//Low battery / power off: the servo is cut halfway through a move, it has to be
+//left at rest and not take targets afterwards
+bool park(int seconds){
+    FakeArm arm;
+    unsigned long now = 1000;
+    bool ok = true;
+    for(int i=0; i<seconds; i++){
+        arm.active = true;
+        arm.update(now += LOOP_MS);
+        arm.move(100, now);
+        arm.update(now += LOOP_MS);
+        arm.update(now += LOOP_MS);
+        arm.off(now);
+        arm.move(100, now += LOOP_MS);
+        for(int k=0; k<10; k++)
+            arm.update(now += LOOP_MS);
+        ok = ok && arm.motion.commanded == RELAXED;
+    }
+    if(!ok)
+        printf("park       the servo was cut away from rest\n");
+    arm.active = true;
+    return report("park", arm, seconds, PROFILE) && ok;
+}
+
+int main(int argc, char** argv){
+    int seconds = argc > 1 ? atoi(argv[1]) : 60;
+    bool ok = pong(seconds);
+    ok = alarm(seconds) && ok;
+    ok = blocking(seconds) && ok;
+    ok = branch(seconds) && ok;
+    ok = park(seconds) && ok;
+    if(!ok)
+        return 1;
+    printf("all targets written\n");
+    return 0;
+}
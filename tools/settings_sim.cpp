@@ -0,0 +1,176 @@
+//Settings store with a file in place of the NVS
+//
+//Runs SettingsStore (src/settings.h) with its file backend:
+//  ./settings_sim archivo.bin          shows what a stored blob loads as
+//  ./settings_sim                      simulated use: how many flash writes a session
+//                                      of menu edits costs with and without coalescing,
+//                                      plus loading a shorter (older) blob, a newer one,
+//                                      a corrupted one and one with values out of range,
+//                                      and a write that fails (exits 1 if it isn't retried)
+//
+//Build: g++ -O2 -std=c++17 -I src tools/settings_sim.cpp -o settings_sim
+
+#include <settings.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+void show(const char* what, SettingsStore &s){
+    SettingsData &d = s.data;
+    printf("%-22s %-8s v%d  level %d rounds %d choices %d timer %ds  writes %u\n", what,
+        SETTINGS_LOAD_NAMES[s.status], d.version, d.pong_level, d.pong_rounds, d.gamble_choices,
+        d.timer_preset, (unsigned)d.writes);
+}
+
+void writeRaw(const char* path, const std::vector<uint8_t> &blob){
+    FILE* f = fopen(path, "wb");
+    fwrite(blob.data(), 1, blob.size(), f);
+    fclose(f);
+}
+
+std::vector<uint8_t> readRaw(const char* path){
+    std::vector<uint8_t> blob(SETTINGS_MAX_BYTES);
+    FILE* f = fopen(path, "rb");
+    blob.resize(f ? fread(blob.data(), 1, blob.size(), f) : 0);
+    if(f) fclose(f);
+    return blob;
+}
+
+//Same blob with n bytes of values, as an older or newer build would have written it
+std::vector<uint8_t> resized(std::vector<uint8_t> blob, size_t n){
+    blob.resize(n, 0x5A);
+    SettingsData head;
+    memcpy(&head, blob.data(), SETTINGS_VALUES);
+    head.size = n;
+    memcpy(blob.data(), &head, SETTINGS_VALUES);
+    head.crc = settings_crc(blob.data(), n);
+    memcpy(blob.data(), &head, SETTINGS_VALUES);
+    return blob;
+}
+
+//Ten minutes of use: the user scrolls difficulty and rounds, sets the timer a few
+//times and changes the gambling choices. One change per encoder step
+uint32_t session(SettingsStore &s, bool coalesce){
+    uint32_t changes = 0;
+    unsigned long now = 0;
+    auto step = [&](int16_t &field, int value){
+        field = value;
+        changes++;
+        if(coalesce)
+            s.changed(now);
+        else
+            s.save(now);
+    };
+    for(int burst=0; burst<20; burst++){
+        for(int i=0; i<8; i++){
+            step(s.data.pong_level, (burst + i) % 8);
+            now += 120; //Encoder steps 120 ms apart
+            s.update(now);
+        }
+        step(s.data.pong_rounds, 1 + burst % 5);
+        step(s.data.gamble_choices, 2 + burst);
+        step(s.data.timer_preset, 300*(1 + burst % 6));
+        for(int i=0; i<300; i++){ //Half a minute of loops
+            now += 100;
+            s.update(now);
+        }
+    }
+    s.save(now); //Power off
+    return changes;
+}
+
+int main(int argc, char** argv){
+    if(argc > 1){
+        SettingsStore s;
+        s.backend.path = argv[1];
+        s.begin();
+        show(argv[1], s);
+        return 0;
+    }
+
+    const char* path = "settings_sim.bin";
+    remove(path);
+
+    SettingsStore fresh;
+    fresh.backend.path = path;
+    fresh.begin();
+    show("first boot", fresh);
+
+    uint32_t changes = session(fresh, false);
+    printf("%u changes, %u flash writes writing every change\n", (unsigned)changes, (unsigned)fresh.saves);
+
+    SettingsStore coalesced;
+    coalesced.backend.path = path;
+    coalesced.begin();
+    uint32_t before = coalesced.data.writes;
+    session(coalesced, true);
+    printf("%u changes, %u flash writes coalesced (%u joined a pending write)\n", (unsigned)changes,
+        (unsigned)coalesced.saves, (unsigned)coalesced.coalesced);
+    printf("wear counter %u -> %u\n", (unsigned)before, (unsigned)coalesced.data.writes);
+
+    SettingsStore again;
+    again.backend.path = path;
+    again.begin();
+    show("reboot", again);
+
+    //Other layouts of the same values
+    std::vector<uint8_t> blob = readRaw(path);
+    writeRaw(path, resized(blob, SETTINGS_VALUES + 4)); //Only level and rounds
+    SettingsStore older;
+    older.backend.path = path;
+    older.begin();
+    show("older, shorter blob", older);
+    older.save(0);
+    SettingsStore migrated;
+    migrated.backend.path = path;
+    migrated.begin();
+    show("after one save", migrated);
+
+    writeRaw(path, resized(blob, sizeof(SettingsData) + 8));
+    SettingsStore newer;
+    newer.backend.path = path;
+    newer.begin();
+    show("newer, longer blob", newer);
+
+    blob[SETTINGS_VALUES] ^= 0x40;
+    writeRaw(path, blob);
+    SettingsStore corrupt;
+    corrupt.backend.path = path;
+    corrupt.begin();
+    show("flipped bit", corrupt);
+
+    //Good CRC, values no menu allows
+    SettingsData wild;
+    settings_defaults(wild);
+    wild.pong_level = 999;
+    wild.pong_rounds = -4;
+    wild.gamble_choices = 0;
+    wild.timer_preset = 32000;
+    wild.crc = settings_crc((const uint8_t*)&wild, sizeof(wild));
+    writeRaw(path, std::vector<uint8_t>((const uint8_t*)&wild, (const uint8_t*)&wild + sizeof(wild)));
+    SettingsStore clamped;
+    clamped.backend.path = path;
+    clamped.begin();
+    show("out of range values", clamped);
+
+    //Flash write failing: no wear counted, still pending, written once it works again
+    bool ok = true;
+    SettingsStore failing;
+    failing.backend.path = "no_such_dir/settings.bin";
+    failing.begin();
+    failing.data.pong_level = 5;
+    failing.changed(0);
+    failing.update(SETTINGS_DELAY_MS);
+    ok = ok && failing.failed == 1 && failing.dirty && failing.data.writes == 0;
+    failing.update(SETTINGS_DELAY_MS + 1000); //Not before the interval
+    ok = ok && failing.failed == 1;
+    failing.backend.path = path;
+    failing.update(SETTINGS_DELAY_MS + SETTINGS_MIN_INTERVAL_MS);
+    ok = ok && failing.saves == 1 && !failing.dirty && failing.data.writes == 1;
+    printf("%-22s %u failed, %u saved, wear counter %u%s\n", "failing write", (unsigned)failing.failed,
+        (unsigned)failing.saves, (unsigned)failing.data.writes, ok ? "" : "  FAIL");
+
+    remove(path);
+    return ok ? 0 : 1;
+}
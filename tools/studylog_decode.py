@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+#Decodes the study log (see src/studylog.h): a dump of the "studylog" partition or the
+#file the PC build writes. Prints every session oldest first and the time per day.
+#
+#Record (16 bytes, little endian): u8 tag, u8 flags, u8 pauses, u8 check, u32 start,
+#u16 boot, u16 planned, u16 studied, u16 paused. Each 4 KB sector starts with a header
+#record whose start field is the sector sequence number.
+#
+#Usage: esptool.py --chip esp32c3 read_flash 0x3D0000 0x10000 studylog.bin
+#       python3 tools/studylog_decode.py studylog.bin
+
+import argparse
+import datetime
+import struct
+
+SECTOR = 4096
+RECORD = struct.Struct("<BBBBIHHHH")
+TAG_SECTOR = 0x5E
+TAG_SESSION = 0x5A
+DONE = 1
+CLOCK = 2
+
+
+def check(raw):
+    c = 0x5C
+    for i, b in enumerate(raw):
+        if i != 3:
+            c = ((c << 1 | c >> 7) & 0xFF) ^ b
+    return c
+
+
+def record(raw):
+    r = RECORD.unpack(raw)
+    return r if r[3] == check(raw) else None
+
+
+def sessions(data):
+    #Sectors in sequence order, the newest lap only
+    heads = []
+    for off in range(0, len(data) - SECTOR + 1, SECTOR):
+        h = record(data[off:off+16])
+        if h and h[0] == TAG_SECTOR:
+            heads.append((h[4], off))
+    heads.sort()
+    newest = heads[-1][0] if heads else 0
+    bad = 0
+    for seq, off in heads:
+        if seq <= newest - len(data)//SECTOR:
+            continue
+        for p in range(off + 16, off + SECTOR, 16):
+            raw = data[p:p+16]
+            if raw == b"\xff"*16:
+                break
+            r = record(raw)
+            if r is None or r[0] != TAG_SESSION:
+                bad += 1
+                continue
+            yield r
+    if bad:
+        print("%d damaged records skipped" % bad)
+
+
+def hm(seconds):
+    return "%dh%02d" % (seconds//3600, seconds//60 % 60)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("dump")
+    args = ap.parse_args()
+    data = open(args.dump, "rb").read()
+
+    days, count = {}, 0
+    print("%-19s %5s %7s %7s %7s %6s %s" % ("inicio", "boot", "plan", "real", "pausa", "pausas", ""))
+    for tag, flags, pauses, _, start, boot, planned, studied, paused in sessions(data):
+        count += 1
+        if flags & CLOCK:
+            when = datetime.datetime(1970, 1, 1) + datetime.timedelta(seconds=start) #Already local time
+            label = when.strftime("%Y-%m-%d %H:%M:%S")
+            day = when.date().isoformat()
+        else:
+            label = "+%ds" % start
+            day = "boot %d" % boot
+        print("%-19s %5d %7s %7s %7s %6d %s" % (label, boot, hm(planned), hm(studied), hm(paused), pauses,
+                                               "ok" if flags & DONE else "cortada"))
+        d = days.setdefault(day, [0, 0])
+        d[0] += 1
+        d[1] += studied
+
+    print("\n%d sesiones" % count)
+    for day, (n, studied) in days.items():
+        print("%-12s %3d sesiones %s" % (day, n, hm(studied)))
+
+
+if __name__ == "__main__":
+    main()
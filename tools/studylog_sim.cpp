@@ -0,0 +1,105 @@
+//Study log with a file in place of the flash partition
+//
+//Runs StudyLog (src/studylog.h) on its file backend: simulated days of timer sessions
+//with a reboot each day, enough to go around the partition a few times. Checks that
+//every boot finds the append point again, that nothing but the oldest sector is lost
+//when it wraps and that all sectors are erased about as often. The file it leaves
+//behind is what tools/studylog_decode.py reads.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/studylog_sim.cpp -o studylog_sim
+//Usage: ./studylog_sim [dias] [archivo.bin]
+
+#include <studylog.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+uint32_t rng = 777;
+uint32_t rnd(uint32_t n){
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng % n;
+}
+
+int main(int argc, char** argv){
+    int days = argc > 1 ? atoi(argv[1]) : 1500;
+    const char* path = argc > 2 ? argv[2] : "studylog.bin";
+    remove(path);
+
+    uint32_t day0 = 20000*STUDY_DAY; //Local time of the first day
+    uint32_t written = 0, errors = 0;
+    uint16_t last_boot = 0;
+
+    for(int d=0; d<days; d++){
+        //One boot a day, the clock set from the console on most of them
+        StudyLog log;
+        log.flash.path = path;
+        if(!log.begin()){
+            printf("begin failed\n");
+            return 1;
+        }
+        //Everything until the first lap, then at least all but the sector being reused
+        uint32_t kept = log.count(), floor = (log.sectors - 1)*(STUDY_PER_SECTOR - 1);
+        if(kept > written || (kept < written && kept < floor))
+            errors++;
+        if(written > 0 && log.boot != last_boot + 1)
+            errors++;
+        bool clock = rnd(10) < 8;
+        unsigned long ms = 0;
+        if(clock)
+            log.setClock(day0 + d*STUDY_DAY + 8*3600, ms);
+
+        uint32_t today_s = 0, today_n = 0;
+        int n = 1 + rnd(8);
+        for(int i=0; i<n; i++){
+            uint32_t planned = 300*(1 + rnd(12));
+            log.start(ms, planned);
+            uint32_t studied = 0;
+            int pauses = rnd(3);
+            for(int p=0; p<pauses; p++){
+                ms += planned*1000/(pauses + 1);
+                studied += planned/(pauses + 1);
+                log.pause(ms);
+                ms += 60000*(1 + rnd(5));
+                log.resume(ms);
+            }
+            bool done = rnd(5) != 0;
+            uint32_t rest = done ? planned - studied : (planned - studied)/2;
+            ms += rest*1000;
+            studied += rest;
+            if(log.finish(ms, done)){
+                written++;
+                today_n++;
+                today_s += log.cur.studied;
+                last_boot = log.boot;
+            }
+            ms += 600000;
+        }
+
+        //The summary has to agree with what was just written
+        StudySummary today, week, total;
+        log.summary(ms, today, week, total);
+        if(today.sessions != today_n || today.studied != today_s)
+            errors++;
+        if(d == days - 1)
+            printf("last day: %u sessions %u min (%s), week %u sessions, %u kept of %u\n", today.sessions,
+                (unsigned)today.studied/60, clock ? "clock" : "no clock", week.sessions, total.sessions, (unsigned)written);
+    }
+
+    //Sector sequence numbers tell how often each one was erased
+    StudyLog log;
+    log.flash.path = path;
+    log.begin();
+    uint32_t lo = 0xFFFFFFFF, hi = 0;
+    for(int s=0; s<log.sectors; s++){
+        const StudyRecord &h = log.at(s*STUDY_SECTOR);
+        uint32_t seq = study_valid(h, STUDY_TAG_SECTOR) ? h.start : 0;
+        if(seq < lo) lo = seq;
+        if(seq > hi) hi = seq;
+    }
+    printf("%d days, %u sessions, %d sectors: each erased %u to %u times\n", days, (unsigned)written,
+        log.sectors, (lo + log.sectors - 1)/log.sectors, (hi + log.sectors - 1)/log.sectors);
+    printf("next boot %u, head 0x%x, %u errors\n", log.boot, (unsigned)log.head, (unsigned)errors);
+    return errors != 0;
+}
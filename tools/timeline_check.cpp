@@ -0,0 +1,161 @@
+//Timeline script checker
+//
+//Plays every keyframe script of src/shows.h through the same track stepping the
+//Timeline uses (run_track), one ms at a time, with a fake screen, arm and buzzer.
+//Checks the tables first: keyframes sorted by time, KF_END last and not before
+//them, KF_PLAY pointing to a known script. Then while playing: faces and arm
+//positions in range, texts present, nested scripts always finding a free track (a
+//full Timeline drops them silently) and never two tones, or a tone and the song, at
+//once on the one buzzer. Prints the length and peak tracks of each show, exits 1 on
+//any problem.
+//
+//Build: g++ -O2 -std=c++17 -I src tools/timeline_check.cpp -o timeline_check
+//Usage: ./timeline_check
+
+#include <shows.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#define SCRIPT(s) {#s, s, int(sizeof(s)/sizeof(s[0]))}
+
+struct Script{
+    const char* name;
+    const Keyframe* keys;
+    int n;
+};
+
+Script scripts[] = {
+    SCRIPT(SND_SUCCESS), SCRIPT(SND_GAMBLING), SCRIPT(SND_SAD), SCRIPT(SND_CELEBRATION), SCRIPT(SND_ANGRY),
+    SCRIPT(BOT_WINS), SCRIPT(BOT_LOSES), SCRIPT(GAMBLING_ROLL), SCRIPT(BDAY_INTRO), SCRIPT(BDAY_OUTRO)
+};
+const int N_SCRIPTS = sizeof(scripts)/sizeof(scripts[0]);
+
+int errors = 0;
+
+const Script* find(const void* ptr){
+    for(const Script &s : scripts)
+        if(s.keys == ptr)
+            return &s;
+    return NULL;
+}
+
+void fail(const char* name, unsigned long at, const char* what){
+    printf("%-16s %5lu ms: %s\n", name, at, what);
+    errors++;
+}
+
+//The tables themselves
+void check_table(const Script &s){
+    for(int i=0; i<s.n; i++){
+        const Keyframe &k = s.keys[i];
+        if(i > 0 && k.at < s.keys[i-1].at)
+            fail(s.name, k.at, "keyframe earlier than the one before (runs right after it)");
+        if(k.op == KF_END && i != s.n-1)
+            fail(s.name, k.at, "KF_END before the last keyframe (the rest never runs)");
+        if(k.op == KF_PLAY && find(k.ptr) == NULL)
+            fail(s.name, k.at, "KF_PLAY of a script that is not in the list");
+        if(k.op > KF_SONG)
+            fail(s.name, k.at, "unknown op");
+    }
+    if(s.n == 0 || s.keys[s.n-1].op != KF_END)
+        fail(s.name, 0, "no KF_END at the end");
+    if(s.n > 255)
+        fail(s.name, 0, "more keyframes than Track::next can count");
+}
+
+struct Sound{
+    unsigned long from, to;
+    int freq;
+};
+
+//Timeline of src/timeline.h with the outputs recorded
+struct FakeTimeline{
+    Track tracks[MAX_TRACKS];
+    const char* name;
+    unsigned long now = 0;
+    int peak = 0;
+    long song_at = -1;
+    std::vector<Sound> sounds;
+
+    bool play(const Keyframe* script){
+        for(Track &t : tracks){
+            if(t.script != NULL)
+                continue;
+            t.script = script;
+            t.next = 0;
+            t.start = now;
+            run_track(t, now, *this);
+            return true;
+        }
+        return false;
+    }
+
+    int playing(){
+        int n = 0;
+        for(Track &t : tracks)
+            n += t.script != NULL;
+        return n;
+    }
+
+    void exec(const Keyframe &k){
+        if(k.op == KF_FACE && (k.a < 0 || k.a >= BUILTIN_FACES))
+            fail(name, now, "face out of range");
+        else if(k.op == KF_ARM && (k.a < 0 || k.a > 100))
+            fail(name, now, "arm position out of 0-100");
+        else if(k.op == KF_TONE){
+            if(k.a < 31 || k.b <= 0)
+                fail(name, now, "tone the buzzer can't play");
+            sounds.push_back({now, now + k.b, k.a});
+        }
+        else if(k.op == KF_TEXT && k.ptr == NULL)
+            fail(name, now, "KF_TEXT without text");
+        else if(k.op == KF_PLAY && !play((const Keyframe*)k.ptr))
+            fail(name, now, "all tracks busy, nested script dropped");
+        else if(k.op == KF_SONG)
+            song_at = now;
+        peak = std::max(peak, playing());
+    }
+};
+
+void check_show(const Script &s){
+    FakeTimeline tl;
+    tl.name = s.name;
+    tl.play(s.keys);
+    while(tl.playing() && tl.now < 60000){
+        tl.now++;
+        for(Track &t : tl.tracks)
+            if(t.script != NULL)
+                run_track(t, tl.now, tl);
+    }
+    if(tl.playing())
+        fail(s.name, tl.now, "still playing after a minute");
+
+    //One buzzer: a tone cuts the one before, the melody owns it while it plays
+    std::sort(tl.sounds.begin(), tl.sounds.end(), [](const Sound &a, const Sound &b){ return a.from < b.from; });
+    unsigned long end = tl.now;
+    for(size_t i=0; i<tl.sounds.size(); i++){
+        if(i > 0 && tl.sounds[i].from < tl.sounds[i-1].to)
+            fail(s.name, tl.sounds[i].from, "tone starts before the last one ended");
+        if(tl.song_at >= 0 && tl.sounds[i].to > (unsigned long)tl.song_at)
+            fail(s.name, tl.sounds[i].from, "tone while the song plays");
+        end = std::max(end, tl.sounds[i].to);
+    }
+    printf("%-16s %3d keyframes, %5lu ms, %zu tones, peak %d/%d tracks%s\n", s.name, s.n, end, tl.sounds.size(),
+        tl.peak, MAX_TRACKS, tl.song_at >= 0 ? ", song" : "");
+}
+
+int main(){
+    for(int i=0; i<N_SCRIPTS; i++)
+        check_table(scripts[i]);
+    if(errors == 0)
+        for(int i=0; i<N_SCRIPTS; i++)
+            check_show(scripts[i]);
+    if(errors){
+        printf("%d problems\n", errors);
+        return 1;
+    }
+    printf("all scripts ok\n");
+    return 0;
+}
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+#Turns the binary trace the bot streams with -DTRACE_MODE=1 (see src/trace.h) into a
+#Chrome trace (chrome://tracing or ui.perfetto.dev) and prints input -> screen latencies.
+#
+#Frame: 0xA5, u32 cycles, u8 type, u8 id, u16 arg, xor of the 8 event bytes.
+#
+#Usage: python3 tools/trace2json.py captura.bin -o trace.json
+#       python3 tools/trace2json.py --port /dev/ttyACM0 --seconds 10 -o trace.json  (pyserial)
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+FRAME_START = 0xA5
+FRAME_SIZE = 10
+EVENT = struct.Struct("<IBBH")
+TYPES = {0: "B", 1: "E", 2: "i"}
+ISR_EVENTS = ("ENCODER",)
+
+
+def event_names():
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "trace.h")
+    names = {}
+    for m in re.finditer(r"#define TRACE_(\w+) (\d+)", open(path).read()):
+        if m.group(1) != "MODE" and not m.group(1).startswith(("T_", "FRAME_", "SYNC_MS")):
+            names[int(m.group(2))] = m.group(1)
+    return names
+
+
+#Finds valid frames, skipping console text and broken bytes in between
+def frames(data):
+    i, bad = 0, 0
+    while i + FRAME_SIZE <= len(data):
+        if data[i] == FRAME_START:
+            body = data[i+1:i+9]
+            x = 0
+            for b in body:
+                x ^= b
+            if x == data[i+9]:
+                yield EVENT.unpack(body)
+                i += FRAME_SIZE
+                continue
+        bad += 1
+        i += 1
+    if bad:
+        print("skipped %d bytes" % bad, file=sys.stderr)
+
+
+def capture(port, seconds):
+    import serial
+    import time
+    s = serial.Serial(port, 115200, timeout=0.1)
+    data, end = bytearray(), time.time() + seconds
+    while time.time() < end:
+        data += s.read(4096)
+    return bytes(data)
+
+
+def convert(data, names):
+    out, mhz, last, us = [], None, None, 0.0
+    pending = [] #Events before the first SYNC
+    sync_id = next(k for k, v in names.items() if v == "SYNC")
+
+    for cycles, kind, ident, arg in frames(data):
+        if ident == sync_id:
+            mhz = arg
+        if mhz is None:
+            pending.append((cycles, kind, ident, arg))
+            continue
+        for c, k, i, a in pending + [(cycles, kind, ident, arg)]:
+            #32-bit cycle counter: the events are in order, the wrap shows up as a negative delta
+            if last is not None:
+                delta = (c - last) & 0xFFFFFFFF
+                if delta >= 1 << 31:
+                    delta -= 1 << 32
+                us += delta/mhz
+            last = c
+            name = names.get(i, "id%d" % i)
+            if name == "SYNC":
+                continue
+            e = {"name": name, "ph": TYPES.get(k, "i"), "ts": round(us, 3), "pid": 1,
+                 "tid": 2 if name in ISR_EVENTS else 1, "args": {"arg": a}}
+            if e["ph"] == "i":
+                e["s"] = "t"
+            out.append(e)
+        pending = []
+
+    #The ISR ring is sent before the main ring, so the timeline needs sorting
+    out.sort(key=lambda e: e["ts"])
+    return out
+
+
+def report(events):
+    #Input (encoder step or click) -> end of the next flush that follows it
+    lat, waiting = [], None
+    spans, open_spans = {}, {}
+    for e in events:
+        if e["name"] in ("ENCODER", "CLICK") and waiting is None:
+            waiting = e["ts"]
+        if e["ph"] == "B":
+            open_spans[(e["tid"], e["name"])] = e["ts"]
+        elif e["ph"] == "E" and (e["tid"], e["name"]) in open_spans:
+            d = e["ts"] - open_spans.pop((e["tid"], e["name"]))
+            spans.setdefault(e["name"], []).append(d)
+            if e["name"] == "FLUSH" and waiting is not None:
+                lat.append(e["ts"] - waiting)
+                waiting = None
+
+    if events:
+        print("%d events, %.2f s" % (len(events), (events[-1]["ts"] - events[0]["ts"])/1e6))
+    if lat:
+        lat.sort()
+        print("input -> flush end: n=%d  p50 %.1f ms  p90 %.1f ms  max %.1f ms" % (
+            len(lat), lat[len(lat)//2]/1000, lat[len(lat)*9//10]/1000, lat[-1]/1000))
+    for name, d in sorted(spans.items()):
+        d.sort()
+        print("%-8s n=%-6d avg %8.1f us  max %8.1f us" % (name, len(d), sum(d)/len(d), d[-1]))
+    dropped = sum(e["args"]["arg"] for e in events if e["name"] == "DROPPED")
+    if dropped:
+        print("dropped %d events (UART too slow, trace less or raise the baud rate)" % dropped)
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("input", nargs="?", help="binary capture (default stdin)")
+    ap.add_argument("-o", "--output", default="trace.json")
+    ap.add_argument("--port", help="read from a serial port instead (needs pyserial)")
+    ap.add_argument("--seconds", type=float, default=10)
+    args = ap.parse_args()
+
+    if args.port:
+        data = capture(args.port, args.seconds)
+    elif args.input:
+        data = open(args.input, "rb").read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    events = convert(data, event_names())
+    json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, open(args.output, "w"))
+    print("%s: %d events" % (args.output, len(events)))
+    report(events)
+
+
+if __name__ == "__main__":
+    main()